@@ -0,0 +1,373 @@
+#include <cstdlib>
+#include <cstdint>
+#include <cstring>
+#include <cstdio>
+#include <iostream>
+#include <fstream>
+#include <string>
+#include <vector>
+#include <algorithm>
+#include <cctype>
+#include <filesystem>
+
+// .pak file layout: ArchiveHeader, ArchiveEntry[entryCount] sorted by path, the path strings (not null terminated),
+// then the payloads. every payload starts at a multiple of ARCHIVE_ALIGNMENT, so that it can be used in place from a
+// mapping of the archive. files with identical contents share one payload
+const uint32_t ARCHIVE_MAGIC = 0x4B505353; // "SSPK"
+const uint32_t ARCHIVE_VERSION = 1;
+const uint64_t ARCHIVE_ALIGNMENT = 4096;
+
+struct ArchiveHeader
+{
+	uint32_t magic;
+	uint32_t version;
+	uint32_t entryCount;
+	uint32_t pathTableSize;
+	uint64_t fileSize;
+};
+
+struct ArchiveEntry
+{
+	uint32_t pathOffset; // relative to the start of the path table
+	uint32_t pathLength;
+	uint64_t offset; // relative to the start of the archive
+	uint64_t size;
+	uint64_t hash; // FNV-1a of the contents
+};
+
+uint64_t hashData(const char *data, size_t size)
+{
+	// FNV-1a
+	uint64_t hash = 14695981039346656037ull;
+	for (size_t i = 0; i < size; ++i)
+	{
+		hash = (hash ^ static_cast<uint8_t>(data[i])) * 1099511628211ull;
+	}
+	return hash;
+}
+
+uint64_t alignOffset(uint64_t offset)
+{
+	return (offset + ARCHIVE_ALIGNMENT - 1) / ARCHIVE_ALIGNMENT * ARCHIVE_ALIGNMENT;
+}
+
+bool readFile(const std::filesystem::path &path, std::vector<char> &data)
+{
+	std::ifstream file(path, std::ios::binary | std::ios::ate);
+	if (!file.is_open())
+	{
+		return false;
+	}
+
+	data.resize(static_cast<size_t>(file.tellg()));
+	file.seekg(0, std::ios::beg);
+	return static_cast<bool>(file.read(data.data(), data.size()));
+}
+
+struct InputFile
+{
+	std::filesystem::path srcPath;
+	std::string archivePath; // relative to the root directory, with forward slashes
+};
+
+bool writeArchive(const std::filesystem::path &dstPath, const std::vector<InputFile> &inputFiles)
+{
+	struct Payload
+	{
+		std::vector<char> data;
+		uint64_t hash;
+		uint64_t offset;
+	};
+
+	std::vector<Payload> payloads;
+	std::vector<ArchiveEntry> entries(inputFiles.size());
+	std::string pathTable;
+
+	// read the files and share the payloads of identical files
+	for (size_t i = 0; i < inputFiles.size(); ++i)
+	{
+		std::vector<char> data;
+		if (!readFile(inputFiles[i].srcPath, data))
+		{
+			std::cerr << "Failed to read file: " << inputFiles[i].srcPath.string() << std::endl;
+			return false;
+		}
+
+		const uint64_t hash = hashData(data.data(), data.size());
+
+		size_t payloadIndex = payloads.size();
+		for (size_t j = 0; j < payloads.size(); ++j)
+		{
+			if (payloads[j].hash == hash && payloads[j].data == data)
+			{
+				payloadIndex = j;
+				break;
+			}
+		}
+		if (payloadIndex == payloads.size())
+		{
+			payloads.push_back({ std::move(data), hash, 0 });
+		}
+
+		ArchiveEntry &entry = entries[i];
+		entry.pathOffset = static_cast<uint32_t>(pathTable.size());
+		entry.pathLength = static_cast<uint32_t>(inputFiles[i].archivePath.size());
+		entry.offset = payloadIndex; // replaced by the file offset below
+		entry.size = payloads[payloadIndex].data.size();
+		entry.hash = hash;
+		pathTable += inputFiles[i].archivePath;
+	}
+
+	// lay out the payloads
+	uint64_t offset = sizeof(ArchiveHeader) + entries.size() * sizeof(ArchiveEntry) + pathTable.size();
+	for (auto &payload : payloads)
+	{
+		offset = alignOffset(offset);
+		payload.offset = offset;
+		offset += payload.data.size();
+	}
+	for (auto &entry : entries)
+	{
+		entry.offset = payloads[entry.offset].offset;
+	}
+
+	ArchiveHeader header{};
+	header.magic = ARCHIVE_MAGIC;
+	header.version = ARCHIVE_VERSION;
+	header.entryCount = static_cast<uint32_t>(entries.size());
+	header.pathTableSize = static_cast<uint32_t>(pathTable.size());
+	header.fileSize = offset;
+
+	// write to a temporary file first, so that an interrupted write does not leave a truncated archive behind
+	std::filesystem::path tmpPath = dstPath;
+	tmpPath += ".tmp";
+	bool written;
+	{
+		std::ofstream file(tmpPath, std::ios::binary | std::ios::trunc);
+		written = file.write(reinterpret_cast<const char *>(&header), sizeof(header))
+			&& file.write(reinterpret_cast<const char *>(entries.data()), entries.size() * sizeof(ArchiveEntry))
+			&& file.write(pathTable.data(), pathTable.size());
+
+		uint64_t position = sizeof(ArchiveHeader) + entries.size() * sizeof(ArchiveEntry) + pathTable.size();
+		const std::vector<char> padding(ARCHIVE_ALIGNMENT);
+		for (const auto &payload : payloads)
+		{
+			written = written
+				&& file.write(padding.data(), payload.offset - position)
+				&& file.write(payload.data.data(), payload.data.size());
+			position = payload.offset + payload.data.size();
+		}
+	}
+
+	std::error_code errorCode;
+	if (written)
+	{
+		std::filesystem::rename(tmpPath, dstPath, errorCode);
+		written = !errorCode;
+	}
+
+	if (!written)
+	{
+		std::filesystem::remove(tmpPath, errorCode);
+		std::cerr << "Failed to write archive: " << dstPath.string() << std::endl;
+		return false;
+	}
+
+	printf("Packed %u files (%u unique) into %s, %.2f MiB\n", header.entryCount, static_cast<uint32_t>(payloads.size()), dstPath.string().c_str(), header.fileSize / (1024.0 * 1024.0));
+	return true;
+}
+
+// checks the table of contents and the hashes of all payloads
+bool verifyArchive(const std::filesystem::path &path)
+{
+	std::vector<char> data;
+	if (!readFile(path, data))
+	{
+		std::cerr << "Failed to read archive: " << path.string() << std::endl;
+		return false;
+	}
+
+	ArchiveHeader header;
+	if (data.size() < sizeof(header))
+	{
+		std::cerr << "Invalid archive: " << path.string() << std::endl;
+		return false;
+	}
+	memcpy(&header, data.data(), sizeof(header));
+
+	const uint64_t tocSize = sizeof(header) + uint64_t(header.entryCount) * sizeof(ArchiveEntry) + header.pathTableSize;
+	if (header.magic != ARCHIVE_MAGIC || header.version != ARCHIVE_VERSION || header.fileSize != data.size() || tocSize > data.size())
+	{
+		std::cerr << "Invalid or unsupported archive: " << path.string() << std::endl;
+		return false;
+	}
+
+	std::vector<ArchiveEntry> entries(header.entryCount);
+	memcpy(entries.data(), data.data() + sizeof(header), entries.size() * sizeof(ArchiveEntry));
+	const char *pathTable = data.data() + sizeof(header) + entries.size() * sizeof(ArchiveEntry);
+
+	uint32_t failedCount = 0;
+	for (const auto &entry : entries)
+	{
+		const bool pathValid = uint64_t(entry.pathOffset) + entry.pathLength <= header.pathTableSize;
+		const std::string entryPath = pathValid ? std::string(pathTable + entry.pathOffset, entry.pathLength) : "<invalid path>";
+		const bool payloadValid = entry.offset % ARCHIVE_ALIGNMENT == 0 && entry.offset >= tocSize && entry.offset <= data.size() && entry.size <= data.size() - entry.offset;
+
+		if (!pathValid || !payloadValid || hashData(data.data() + entry.offset, static_cast<size_t>(entry.size)) != entry.hash)
+		{
+			std::cerr << "Corrupt entry: " << entryPath << std::endl;
+			++failedCount;
+		}
+	}
+
+	printf("Verified %u files in %s, %u corrupt\n", header.entryCount, path.string().c_str(), failedCount);
+	return failedCount == 0;
+}
+
+void printUsage()
+{
+	std::cout <<
+		"Usage: AssetPacker [options] -o <archive.pak> <file | directory>...\n"
+		"       AssetPacker --verify <archive.pak>\n"
+		"Packs the given files, and all files in the given directories, into a single archive.\n"
+		"Files are stored under their path relative to the root directory.\n"
+		"\n"
+		"Options:\n"
+		"  -o, --output <file>     the archive to write\n"
+		"  -r, --root <dir>        directory the stored paths are relative to (default: current directory)\n"
+		"  -e, --extension <ext>   only pack files with this extension from directories, may be repeated\n"
+		"      --verify <file>     check the table of contents and the content hashes of an archive\n"
+		"  -h, --help              show this message\n"
+		"\n"
+		"Exit codes: 0 success, 1 packing or verification failed, 2 invalid arguments." << std::endl;
+}
+
+enum ExitCode
+{
+	EXIT_CODE_SUCCESS = 0,
+	EXIT_CODE_FAILED = 1,
+	EXIT_CODE_INVALID_ARGUMENTS = 2,
+};
+
+int main(int argc, char *argv[])
+{
+	namespace fs = std::filesystem;
+
+	fs::path outputPath;
+	fs::path verifyPath;
+	fs::path rootDirectory = fs::current_path();
+	std::vector<std::string> extensions;
+	std::vector<fs::path> srcPaths;
+
+	auto toLower = [](std::string str)
+	{
+		std::transform(str.begin(), str.end(), str.begin(), [](char c) { return static_cast<char>(tolower(c)); });
+		return str;
+	};
+
+	// parse arguments
+	for (int i = 1; i < argc; ++i)
+	{
+		const std::string arg = argv[i];
+		const bool hasValue = i + 1 < argc;
+
+		if (arg == "-h" || arg == "--help")
+		{
+			printUsage();
+			return EXIT_CODE_SUCCESS;
+		}
+		else if ((arg == "-o" || arg == "--output") && hasValue)
+		{
+			outputPath = argv[++i];
+		}
+		else if ((arg == "-r" || arg == "--root") && hasValue)
+		{
+			rootDirectory = argv[++i];
+		}
+		else if ((arg == "-e" || arg == "--extension") && hasValue)
+		{
+			std::string extension = toLower(argv[++i]);
+			extensions.push_back(extension[0] == '.' ? extension : "." + extension);
+		}
+		else if (arg == "--verify" && hasValue)
+		{
+			verifyPath = argv[++i];
+		}
+		else if (!arg.empty() && arg[0] == '-')
+		{
+			std::cerr << "Unknown or incomplete option: " << arg << std::endl;
+			printUsage();
+			return EXIT_CODE_INVALID_ARGUMENTS;
+		}
+		else
+		{
+			srcPaths.push_back(arg);
+		}
+	}
+
+	if (!verifyPath.empty())
+	{
+		return verifyArchive(verifyPath) ? EXIT_CODE_SUCCESS : EXIT_CODE_FAILED;
+	}
+
+	if (outputPath.empty())
+	{
+		std::cerr << "No output archive." << std::endl;
+		printUsage();
+		return EXIT_CODE_INVALID_ARGUMENTS;
+	}
+
+	// expand directories recursively
+	std::vector<InputFile> inputFiles;
+	for (const auto &path : srcPaths)
+	{
+		std::error_code errorCode;
+		std::vector<fs::path> files;
+
+		if (fs::is_directory(path, errorCode))
+		{
+			for (const auto &entry : fs::recursive_directory_iterator(path, errorCode))
+			{
+				const std::string extension = toLower(entry.path().extension().string());
+
+				if (entry.is_regular_file(errorCode) && (extensions.empty() || std::find(extensions.begin(), extensions.end(), extension) != extensions.end()))
+				{
+					files.push_back(entry.path());
+				}
+			}
+		}
+		else if (fs::is_regular_file(path, errorCode))
+		{
+			files.push_back(path);
+		}
+		else
+		{
+			std::cerr << "No such file or directory: " << path.string() << std::endl;
+			return EXIT_CODE_INVALID_ARGUMENTS;
+		}
+
+		for (const auto &file : files)
+		{
+			const std::string archivePath = fs::relative(file, rootDirectory, errorCode).generic_string();
+			if (errorCode || archivePath.empty() || archivePath.compare(0, 2, "..") == 0)
+			{
+				std::cerr << "File is not inside the root directory: " << file.string() << std::endl;
+				return EXIT_CODE_INVALID_ARGUMENTS;
+			}
+			inputFiles.push_back({ file, archivePath });
+		}
+	}
+
+	if (inputFiles.empty())
+	{
+		std::cerr << "No input files." << std::endl;
+		printUsage();
+		return EXIT_CODE_INVALID_ARGUMENTS;
+	}
+
+	// the runtime looks files up with a binary search
+	std::sort(inputFiles.begin(), inputFiles.end(), [](const auto &lhs, const auto &rhs) { return lhs.archivePath < rhs.archivePath; });
+	inputFiles.erase(std::unique(inputFiles.begin(), inputFiles.end(), [](const auto &lhs, const auto &rhs) { return lhs.archivePath == rhs.archivePath; }), inputFiles.end());
+
+	return writeArchive(outputPath, inputFiles) ? EXIT_CODE_SUCCESS : EXIT_CODE_FAILED;
+}
@@ -1,11 +1,24 @@
-glslc --target-env=vulkan1.0 -O -Werror -c shadow_vert.vert -o shadow_vert.spv
-glslc --target-env=vulkan1.0 -O -Werror -c lighting_vert.vert -o lighting_vert.spv
-glslc --target-env=vulkan1.0 -O -Werror -c lighting_frag.frag -o lighting_frag.spv
-glslc --target-env=vulkan1.0 -O -Werror -c -DSSS=1 lighting_frag.frag -o lighting_frag_SSS.spv
-glslc --target-env=vulkan1.0 -O -Werror -c skybox_vert.vert -o skybox_vert.spv
-glslc --target-env=vulkan1.0 -O -Werror -c skybox_frag.frag -o skybox_frag.spv
-glslc --target-env=vulkan1.0 -O -Werror -c fullscreen_vert.vert -o fullscreen_vert.spv
-glslc --target-env=vulkan1.0 -O -Werror -c sssBlur_comp.comp -o sssBlur_comp.spv
-glslc --target-env=vulkan1.0 -O -Werror -c postprocess_comp.comp -o postprocess_comp.spv
+rem compiles all shaders to spir-v. the build runs this with "nopause" and fails if a shader does not compile
+cd /d "%~dp0"
+glslc --target-env=vulkan1.0 -O -Werror -c shadow_vert.vert -o shadow_vert.spv || goto failed
+glslc --target-env=vulkan1.0 -O -Werror -c lighting_vert.vert -o lighting_vert.spv || goto failed
+glslc --target-env=vulkan1.0 -O -Werror -c lighting_frag.frag -o lighting_frag.spv || goto failed
+glslc --target-env=vulkan1.0 -O -Werror -c -DSSS=1 lighting_frag.frag -o lighting_frag_SSS.spv || goto failed
+glslc --target-env=vulkan1.0 -O -Werror -c skybox_vert.vert -o skybox_vert.spv || goto failed
+glslc --target-env=vulkan1.0 -O -Werror -c skybox_frag.frag -o skybox_frag.spv || goto failed
+glslc --target-env=vulkan1.0 -O -Werror -c fullscreen_vert.vert -o fullscreen_vert.spv || goto failed
+glslc --target-env=vulkan1.0 -O -Werror -c sssClassify_comp.comp -o sssClassify_comp.spv || goto failed
+glslc --target-env=vulkan1.0 -O -Werror -c -DHALF_RES=1 sssClassify_comp.comp -o sssClassify_comp_HALF_RES.spv || goto failed
+glslc --target-env=vulkan1.0 -O -Werror -c sssBlur_comp.comp -o sssBlur_comp.spv || goto failed
+glslc --target-env=vulkan1.0 -O -Werror -c -DTILED=1 sssBlur_comp.comp -o sssBlur_comp_TILED.spv || goto failed
+glslc --target-env=vulkan1.0 -O -Werror -c sssBurley_comp.comp -o sssBurley_comp.spv || goto failed
+glslc --target-env=vulkan1.0 -O -Werror -c sssUpsample_comp.comp -o sssUpsample_comp.spv || goto failed
+glslc --target-env=vulkan1.0 -O -Werror -c postprocess_comp.comp -o postprocess_comp.spv || goto failed
+glslc --target-env=vulkan1.0 -O -Werror -c -DFUSED_SSS_BLUR=1 postprocess_comp.comp -o postprocess_comp_FUSED_SSS_BLUR.spv || goto failed
 
-pause
\ No newline at end of file
+if not "%1"=="nopause" pause
+exit /b 0
+
+:failed
+if not "%1"=="nopause" pause
+exit /b 1
@@ -18,6 +18,7 @@ struct PushConsts
 	uint specularTexture;
 	uint cavityTexture;
 	uint detailNormalTexture;
+	uint sssProfileIndex;
 };
 
 layout(set = 0, binding = 0) uniform sampler2D uTextures[10];
@@ -46,6 +47,7 @@ layout(early_fragment_tests) in;
 layout(location = 0) in vec2 vTexCoord;
 layout(location = 1) in vec3 vNormal;
 layout(location = 2) in vec3 vWorldPos;
+layout(location = 3) in vec4 vTangent;
 
 #if SSS
 layout(location = 0) out vec4 oSpecular;
@@ -54,24 +56,12 @@ layout(location = 1) out vec4 oDiffuse;
 layout(location = 0) out vec4 oColor;
 #endif // SSS
 
-// based on http://www.thetenthplanet.de/archives/1180
-mat3 calculateTBN( vec3 N, vec3 p, vec2 uv )
+// per vertex tangent frame baked by the converter. the interpolated vectors are not normalized.
+// the tangent is negated to match the x axis convention of the normal maps
+mat3 calculateTBN(vec3 N, vec4 T)
 {
-    // get edge vectors of the pixel triangle
-    vec3 dp1 = dFdx( p );
-    vec3 dp2 = dFdy( p );
-    vec2 duv1 = dFdx( uv );
-    vec2 duv2 = dFdy( uv );
- 
-    // solve the linear system
-    vec3 dp2perp = cross( dp2, N );
-    vec3 dp1perp = cross( N, dp1 );
-    vec3 T = dp2perp * duv1.x + dp1perp * duv2.x;
-    vec3 B = dp2perp * duv1.y + dp1perp * duv2.y;
- 
-    // construct a scale-invariant frame 
-    float invmax = inversesqrt( max( dot(T,T), dot(B,B) ) );
-    return mat3( T * -invmax, B * invmax, N );
+	vec3 B = T.w * cross(N, T.xyz);
+	return mat3(-T.xyz, B, N);
 }
 
 float DistributionGGX(vec3 N, vec3 H, float roughness)
@@ -192,7 +182,7 @@ void main()
 	if (uPushConsts.normalTexture != 0)
 	{
 		// construct TBN matrix and transform tangent space normal into world space
-		const mat3 tbn = calculateTBN(N, vWorldPos, vTexCoord);
+		const mat3 tbn = calculateTBN(vNormal, vTangent);
 		const vec3 tangentSpaceNormal = texture(uTextures[uPushConsts.normalTexture - 1], vTexCoord).xyz * 2.0 - 1.0;
 		N = normalize(tbn * tangentSpaceNormal);
 	}
@@ -282,7 +272,8 @@ void main()
 	
 #if SSS
 	oSpecular = vec4(specularTerm, 1.0);
-	oDiffuse = vec4(diffuseTerm, 1.0);
+	// alpha tags the pixel as SSS and selects its entry of the sss profile table in sssBlur_comp.comp
+	oDiffuse = vec4(diffuseTerm, float(uPushConsts.sssProfileIndex + 1));
 #else
 	oColor = vec4(result, 1.0);
 #endif // SSS
@@ -9,20 +9,41 @@ layout(set = 1, binding = 0) uniform CONSTANTS
 	vec4 cameraPosition;
 } uConsts;
 
-layout(location = 0) in vec3 inPosition;
-layout(location = 1) in vec3 inNormal;
+// the fragment shader push constants come first
+layout(push_constant) uniform PUSH_CONSTS
+{
+	layout(offset = 48) vec4 positionScale;
+	vec4 positionBias;
+} uPushConsts;
+
+layout(location = 0) in vec3 inPosition; // 16 bit unorm, quantized to the mesh bounds
+layout(location = 1) in vec2 inNormal; // octahedral encoded
 layout(location = 2) in vec2 inTexCoord;
+layout(location = 3) in vec4 inTangent; // xyz: tangent, w: bitangent sign
 
 layout(location = 0) out vec2 vTexCoord;
 layout(location = 1) out vec3 vNormal;
 layout(location = 2) out vec3 vWorldPos;
+layout(location = 3) out vec4 vTangent;
+
+vec3 decodeOctahedron(vec2 e)
+{
+	vec3 n = vec3(e, 1.0 - abs(e.x) - abs(e.y));
+	float t = max(-n.z, 0.0);
+	n.x += n.x >= 0.0 ? -t : t;
+	n.y += n.y >= 0.0 ? -t : t;
+	return normalize(n);
+}
 
 void main() 
 {
-	gl_Position = uConsts.viewProjectionMatrix * vec4(inPosition, 1.0);
+	vec3 position = inPosition * uPushConsts.positionScale.xyz + uPushConsts.positionBias.xyz;
+	
+	gl_Position = uConsts.viewProjectionMatrix * vec4(position, 1.0);
 	
 	vTexCoord = inTexCoord;
-	vNormal = inNormal;
-	vWorldPos = inPosition;
+	vNormal = decodeOctahedron(inNormal);
+	vWorldPos = position;
+	vTangent = inTangent;
 }
 
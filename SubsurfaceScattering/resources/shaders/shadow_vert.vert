@@ -3,6 +3,8 @@
 struct PushConsts
 {
 	mat4 viewProjectionMatrix;
+	vec4 positionScale;
+	vec4 positionBias;
 };
 
 layout(push_constant) uniform PUSH_CONSTS 
@@ -10,10 +12,11 @@ layout(push_constant) uniform PUSH_CONSTS
 	PushConsts uPushConsts;
 };
 
-layout(location = 0) in vec3 inPosition;
+layout(location = 0) in vec3 inPosition; // 16 bit unorm, quantized to the mesh bounds
 
 void main() 
 {
-	gl_Position = uPushConsts.viewProjectionMatrix * vec4(inPosition, 1.0);
+	vec3 position = inPosition * uPushConsts.positionScale.xyz + uPushConsts.positionBias.xyz;
+	gl_Position = uPushConsts.viewProjectionMatrix * vec4(position, 1.0);
 }
 
@@ -1,8 +1,16 @@
 #include <cstdlib>
+#include <cstdio>
+#include <cstring>
+#include <chrono>
+#include <string>
+#include <vector>
 #include "window/Window.h"
 #include "input/UserInput.h"
 #include "utility/Timer.h"
 #include "vulkan/Renderer.h"
+#include "scene/SceneCompiler.h"
+#include "utility/AssetFile.h"
+#include "utility/Utility.h"
 #include "input/ArcBallCamera.h"
 #include <glm/gtc/matrix_transform.hpp>
 #include "imgui/imgui.h"
@@ -11,10 +19,409 @@
 
 using namespace sss;
 
-int main()
+namespace
+{
+	// selectable sample counts of the separable sss kernel, from lowest to highest quality
+	const uint32_t sssSampleCounts[] = { 7, 11, 17, 25 };
+
+	// selectable sample counts of burley's normalized diffusion; one 2D tap per sample
+	const uint32_t burleySampleCounts[] = { 8, 16, 24, 32 };
+	const char *sssModeNames[] = { "separable", "burley", "split" };
+
+	// diffusion profiles of the scene, uploaded to the renderer's sss profile table
+	struct SSSProfileSettings
+	{
+		std::string name;
+		float width; // mm
+		int quality; // index into sssSampleCounts
+		glm::vec3 strength;
+		glm::vec3 falloff;
+	};
+
+	struct Settings
+	{
+		bool subsurfaceScatteringEnabled = true;
+		bool sssHalfResolution = false;
+		int sssMode = vulkan::SSS_MODE_SEPARABLE;
+		int burleyQuality = 1; // index into burleySampleCounts
+		int sssEditProfile = 0; // profile edited in the gui
+		std::vector<SSSProfileSettings> sssProfiles;
+		bool tiledBlur = false;
+		bool fusedSSSBlur = false;
+		bool asyncCompute = true; // only read when creating the renderer
+		bool taaEnabled = true;
+		float lightTheta = 60.0f;
+		float lightHeight = 0.2f;
+		float lightRadius = 5.0f;
+		float lightLuminousPower = 700.0f;
+		glm::vec3 lightColor = glm::vec3(1.0f);
+		// command line overrides of the scene, applied whenever the scene is loaded
+		std::string sssProfileOverride;
+		int sssProfileOverrideIndex = -1; // sssProfileOverride resolved against the profiles of the scene
+		int sssQualityOverride = -1;
+	};
+
+	// takes the profiles and the light of the scene over into the settings
+	bool applyScene(const scene::Scene &scene, Settings &settings, std::string &error)
+	{
+		if (scene.profiles.size() > vulkan::SSSKernel::MAX_PROFILE_COUNT)
+		{
+			error = "Too many sss profiles, the renderer supports " + std::to_string(vulkan::SSSKernel::MAX_PROFILE_COUNT);
+			return false;
+		}
+
+		settings.sssProfiles.clear();
+		for (const auto &profile : scene.profiles)
+		{
+			int quality = -1;
+			for (int j = 0; j < static_cast<int>(sizeof(sssSampleCounts) / sizeof(sssSampleCounts[0])); ++j)
+			{
+				if (sssSampleCounts[j] == profile.sampleCount)
+				{
+					quality = j;
+				}
+			}
+			if (quality == -1)
+			{
+				error = "Unsupported sss sample count " + std::to_string(profile.sampleCount) + " in profile " + profile.name + ", use 7, 11, 17 or 25";
+				return false;
+			}
+
+			SSSProfileSettings profileSettings;
+			profileSettings.name = profile.name;
+			profileSettings.width = profile.width;
+			profileSettings.quality = settings.sssQualityOverride != -1 ? settings.sssQualityOverride : quality;
+			profileSettings.strength = glm::vec3(profile.strength[0], profile.strength[1], profile.strength[2]);
+			profileSettings.falloff = glm::vec3(profile.falloff[0], profile.falloff[1], profile.falloff[2]);
+			settings.sssProfiles.push_back(profileSettings);
+		}
+
+		// every SSS material keeps the profile assigned by the scene unless the command line overrides it
+		settings.sssProfileOverrideIndex = -1;
+		if (!settings.sssProfileOverride.empty())
+		{
+			for (size_t j = 0; j < settings.sssProfiles.size(); ++j)
+			{
+				if (settings.sssProfiles[j].name == settings.sssProfileOverride)
+				{
+					settings.sssProfileOverrideIndex = static_cast<int>(j);
+				}
+			}
+			if (settings.sssProfileOverrideIndex == -1)
+			{
+				error = "Unknown sss profile " + settings.sssProfileOverride;
+				return false;
+			}
+		}
+
+		// the gui starts out editing the profile of the first SSS material that is actually rendered with
+		settings.sssEditProfile = 0;
+		for (auto it = scene.materials.rbegin(); it != scene.materials.rend(); ++it)
+		{
+			if (it->sss)
+			{
+				settings.sssEditProfile = static_cast<int>(it->material.sssProfileIndex);
+			}
+		}
+		if (settings.sssProfileOverrideIndex != -1)
+		{
+			settings.sssEditProfile = settings.sssProfileOverrideIndex;
+		}
+
+		settings.lightTheta = scene.light.angle;
+		settings.lightHeight = scene.light.height;
+		settings.lightRadius = scene.light.radius;
+		settings.lightLuminousPower = scene.light.luminousPower;
+		settings.lightColor = glm::vec3(scene.light.color[0], scene.light.color[1], scene.light.color[2]);
+
+		return true;
+	}
+
+	// the text scene is compiled next to itself with a "bin" suffix when it changed. only the compiled file has to be shipped
+	bool loadSceneFile(const std::string &filepath, scene::Scene &scene, Settings &settings, std::string &error)
+	{
+		const std::string compiledFilepath = filepath + "bin";
+		return scene::updateCompiledScene(filepath.c_str(), compiledFilepath.c_str(), error)
+			&& scene::loadScene(compiledFilepath.c_str(), scene, error)
+			&& applyScene(scene, settings, error);
+	}
+
+	void applySSSProfiles(vulkan::Renderer &renderer, const Settings &settings)
+	{
+		for (size_t i = 0; i < settings.sssProfiles.size(); ++i)
+		{
+			const SSSProfileSettings &profile = settings.sssProfiles[i];
+			renderer.setSSSProfile(static_cast<uint32_t>(i), sssSampleCounts[profile.quality], profile.width * 0.001f, profile.strength, profile.falloff);
+		}
+		if (settings.sssProfileOverrideIndex != -1)
+		{
+			renderer.setSSSMaterialProfile(static_cast<uint32_t>(settings.sssProfileOverrideIndex));
+		}
+	}
+
+	void renderFrame(vulkan::Renderer &renderer, const ArcBallCamera &camera, const Settings &settings, uint32_t width, uint32_t height)
+	{
+		const float lightRadius = settings.lightRadius;
+		const glm::vec3 lightIntensity = settings.lightColor * settings.lightLuminousPower * (1.0f / (4.0f * glm::pi<float>()));
+
+		// calculate light position
+		const float lightThetaRadians = glm::radians(settings.lightTheta);
+		const glm::vec3 lightPos(glm::cos(lightThetaRadians), settings.lightHeight, glm::sin(lightThetaRadians));
+
+		const float fovy = glm::radians(20.0f);
+
+		// calculate view, projection and shadow matrix
+		const glm::mat4 vulkanCorrection =
+		{
+			{ 1.0f, 0.0f, 0.0f, 0.0f },
+			{ 0.0f, -1.0f, 0.0f, 0.0f },
+			{ 0.0f, 0.0f, 0.5f, 0.0f },
+			{ 0.0f, 0.0f, 0.5f, 1.0f }
+		};
+
+		const float nearPlane = 0.01f;
+		const float farPlane = 50.0f;
+		const glm::mat4 viewMatrix = camera.getViewMatrix();
+		const glm::mat4 viewProjection = vulkanCorrection * glm::perspective(fovy, width / float(height), nearPlane, farPlane) * viewMatrix;
+		const glm::mat4 shadowMatrix = vulkanCorrection * glm::perspective(glm::radians(40.0f), 1.0f, 0.1f, 3.0f) * glm::lookAt(lightPos, glm::vec3(0.0f, 0.15f, 0.0f), glm::vec3(0.0f, 1.0f, 0.0f));
+
+		renderer.render(viewProjection,
+			shadowMatrix,
+			glm::vec4(lightPos, lightRadius),
+			glm::vec4(lightIntensity, 1.0f / (lightRadius * lightRadius)),
+			glm::vec4(camera.getPosition(), 0.0f),
+			settings.subsurfaceScatteringEnabled,
+			settings.sssHalfResolution,
+			static_cast<vulkan::SSSMode>(settings.sssMode),
+			burleySampleCounts[settings.burleyQuality],
+			settings.tiledBlur,
+			settings.fusedSSSBlur,
+			settings.taaEnabled,
+			fovy,
+			nearPlane,
+			farPlane);
+	}
+
+	// startup time covers renderer construction, which includes pipeline creation and loading all assets
+	void printStartupTiming(const vulkan::Renderer &renderer, float startupTime)
+	{
+		printf("Startup %.1f ms (pipeline creation %.1f ms, %s pipeline cache)\n", startupTime, renderer.getPipelineCreationTiming(), renderer.isPipelineCacheWarm() ? "warm" : "cold");
+	}
+
+	// renders a fixed number of frames without window and swapchain and reports averaged gpu pass timings
+	int runHeadless(uint32_t width, uint32_t height, uint32_t frameCount, const char *outputPath, const Settings &settings, const scene::Scene &scene)
+	{
+		const auto startupBegin = std::chrono::steady_clock::now();
+		vulkan::Renderer renderer(nullptr, width, height, settings.asyncCompute, scene);
+		const float startupTime = std::chrono::duration<float, std::milli>(std::chrono::steady_clock::now() - startupBegin).count();
+		printStartupTiming(renderer, startupTime);
+		applySSSProfiles(renderer, settings);
+
+		ArcBallCamera camera(glm::vec3(0.0f, 0.25f, 0.0f), 1.0f);
+
+		double shadowTime = 0.0;
+		double mainTime = 0.0;
+		double sssTime = 0.0;
+		double sssSeparableTime = 0.0;
+		double sssBurleyTime = 0.0;
+		double postprocessTime = 0.0;
+		uint32_t timedFrames = 0;
+
+		for (uint32_t i = 0; i < frameCount; ++i)
+		{
+			renderFrame(renderer, camera, settings, width, height);
+
+			// timings lag FRAMES_IN_FLIGHT frames behind
+			if (i >= vulkan::FRAMES_IN_FLIGHT)
+			{
+				shadowTime += renderer.getShadowPassTiming();
+				mainTime += renderer.getMainPassTiming();
+				sssTime += renderer.getSSSEffectTiming();
+				sssSeparableTime += renderer.getSSSSeparableTiming();
+				sssBurleyTime += renderer.getSSSBurleyTiming();
+				postprocessTime += renderer.getPostprocessTiming();
+				++timedFrames;
+			}
+		}
+
+		if (timedFrames > 0)
+		{
+			printf("Frames: %u (%u timed) at %ux%u%s\n", frameCount, timedFrames, width, height, renderer.isAsyncComputeEnabled() ? " with async compute" : "");
+			printf("Shadow pass      %.3f ms\n", shadowTime / timedFrames);
+			printf("Main pass        %.3f ms\n", mainTime / timedFrames);
+			printf("SSS blur (%s) %.3f ms\n", settings.sssHalfResolution ? "half" : "full", sssTime / timedFrames);
+			printf("  separable      %.3f ms\n", sssSeparableTime / timedFrames);
+			printf("  burley (%2u)    %.3f ms\n", burleySampleCounts[settings.burleyQuality], sssBurleyTime / timedFrames);
+			printf("Postprocessing   %.3f ms\n", postprocessTime / timedFrames);
+		}
+
+		if (outputPath && !renderer.writeOutputImage(outputPath))
+		{
+			fprintf(stderr, "Failed to write output image %s!\n", outputPath);
+			return EXIT_FAILURE;
+		}
+
+		return EXIT_SUCCESS;
+	}
+}
+
+int main(int argc, char *argv[])
 {
 	uint32_t width = 1600;
 	uint32_t height = 900;
+	Settings settings;
+
+	// command line options
+	bool headless = false;
+	uint32_t frameCount = 100;
+	const char *outputPath = nullptr;
+	std::string scenePath = "resources/scenes/default.scene";
+	const char *archivePath = nullptr;
+	for (int i = 1; i < argc; ++i)
+	{
+		const bool hasValue = i + 1 < argc;
+		if (strcmp(argv[i], "--headless") == 0)
+		{
+			headless = true;
+			util::setHeadless(true);
+		}
+		else if (strcmp(argv[i], "--width") == 0 && hasValue)
+		{
+			width = static_cast<uint32_t>(atoi(argv[++i]));
+		}
+		else if (strcmp(argv[i], "--height") == 0 && hasValue)
+		{
+			height = static_cast<uint32_t>(atoi(argv[++i]));
+		}
+		else if (strcmp(argv[i], "--frames") == 0 && hasValue)
+		{
+			frameCount = static_cast<uint32_t>(atoi(argv[++i]));
+		}
+		else if (strcmp(argv[i], "--output") == 0 && hasValue)
+		{
+			outputPath = argv[++i];
+		}
+		else if (strcmp(argv[i], "--no-sss") == 0)
+		{
+			settings.subsurfaceScatteringEnabled = false;
+		}
+		else if (strcmp(argv[i], "--sss-half-res") == 0)
+		{
+			settings.sssHalfResolution = true;
+		}
+		else if (strcmp(argv[i], "--sss-samples") == 0 && hasValue)
+		{
+			const uint32_t sampleCount = static_cast<uint32_t>(atoi(argv[++i]));
+			int quality = -1;
+			for (int j = 0; j < static_cast<int>(sizeof(sssSampleCounts) / sizeof(sssSampleCounts[0])); ++j)
+			{
+				if (sssSampleCounts[j] == sampleCount)
+				{
+					quality = j;
+				}
+			}
+			if (quality == -1)
+			{
+				fprintf(stderr, "Unsupported sss sample count %u, use 7, 11, 17 or 25\n", sampleCount);
+				return EXIT_FAILURE;
+			}
+			settings.sssQualityOverride = quality;
+		}
+		else if (strcmp(argv[i], "--sss-profile") == 0 && hasValue)
+		{
+			// resolved against the profiles of the scene once it is loaded
+			settings.sssProfileOverride = argv[++i];
+		}
+		else if (strcmp(argv[i], "--scene") == 0 && hasValue)
+		{
+			scenePath = argv[++i];
+		}
+		else if (strcmp(argv[i], "--archive") == 0 && hasValue)
+		{
+			archivePath = argv[++i];
+		}
+		else if (strcmp(argv[i], "--sss-mode") == 0 && hasValue)
+		{
+			const char *name = argv[++i];
+			settings.sssMode = -1;
+			for (int j = 0; j < static_cast<int>(sizeof(sssModeNames) / sizeof(sssModeNames[0])); ++j)
+			{
+				if (strcmp(sssModeNames[j], name) == 0)
+				{
+					settings.sssMode = j;
+				}
+			}
+			if (settings.sssMode == -1)
+			{
+				fprintf(stderr, "Unknown sss mode %s, use separable, burley or split\n", name);
+				return EXIT_FAILURE;
+			}
+		}
+		else if (strcmp(argv[i], "--burley-samples") == 0 && hasValue)
+		{
+			const uint32_t sampleCount = static_cast<uint32_t>(atoi(argv[++i]));
+			settings.burleyQuality = -1;
+			for (int j = 0; j < static_cast<int>(sizeof(burleySampleCounts) / sizeof(burleySampleCounts[0])); ++j)
+			{
+				if (burleySampleCounts[j] == sampleCount)
+				{
+					settings.burleyQuality = j;
+				}
+			}
+			if (settings.burleyQuality == -1)
+			{
+				fprintf(stderr, "Unsupported burley sample count %u, use 8, 16, 24 or 32\n", sampleCount);
+				return EXIT_FAILURE;
+			}
+		}
+		else if (strcmp(argv[i], "--tiled-blur") == 0)
+		{
+			settings.tiledBlur = true;
+		}
+		else if (strcmp(argv[i], "--fused-blur") == 0)
+		{
+			settings.fusedSSSBlur = true;
+		}
+		else if (strcmp(argv[i], "--no-async-compute") == 0)
+		{
+			settings.asyncCompute = false;
+		}
+		else if (strcmp(argv[i], "--no-taa") == 0)
+		{
+			settings.taaEnabled = false;
+		}
+		else
+		{
+			fprintf(stderr, "Unknown option %s\n", argv[i]);
+			fprintf(stderr, "Usage: %s [--headless] [--scene file.scene] [--archive file.pak] [--width N] [--height N] [--frames N] [--output file.ppm] [--no-sss] [--sss-half-res] [--sss-samples 7|11|17|25] [--sss-profile name] [--sss-mode separable|burley|split] [--burley-samples 8|16|24|32] [--tiled-blur] [--fused-blur] [--no-async-compute] [--no-taa]\n", argv[0]);
+			return EXIT_FAILURE;
+		}
+	}
+
+	// textures, meshes and shaders packed with AssetPacker are read from the archive, everything else from disk
+	if (archivePath)
+	{
+		util::AssetFile::mountArchive(archivePath);
+	}
+
+	scene::Scene scene;
+	std::string sceneError;
+	if (!loadSceneFile(scenePath, scene, settings, sceneError))
+	{
+		fprintf(stderr, "%s\n", sceneError.c_str());
+		return EXIT_FAILURE;
+	}
+
+	if (headless)
+	{
+		if (width == 0 || height == 0)
+		{
+			fprintf(stderr, "Invalid resolution %ux%u\n", width, height);
+			return EXIT_FAILURE;
+		}
+		return runHeadless(width, height, frameCount, outputPath, settings, scene);
+	}
+
 	Window window(width, height, "Subsurface Scattering Demo");
 	UserInput userInput;
 
@@ -39,20 +446,14 @@ int main()
 	}
 	assert(currentResolutionIndex != -1);
 
-	vulkan::Renderer renderer(window.getWindowHandle(), width, height);
+	const auto startupBegin = std::chrono::steady_clock::now();
+	vulkan::Renderer renderer(window.getWindowHandle(), width, height, settings.asyncCompute, scene);
+	const float startupTime = std::chrono::duration<float, std::milli>(std::chrono::steady_clock::now() - startupBegin).count();
+	printStartupTiming(renderer, startupTime);
+	applySSSProfiles(renderer, settings);
 
 	ArcBallCamera camera(glm::vec3(0.0f, 0.25f, 0.0f), 1.0f);
 
-	const float lightRadius = 5.0f;
-	const float lightLuminousPower = 700.0f;
-	const glm::vec3 lightColor = glm::vec3(255.0f, 206.0f, 166.0f) / 255.0f;
-	const glm::vec3 lightIntensity = lightColor * lightLuminousPower * (1.0f / (4.0f * glm::pi<float>()));
-
-	bool subsurfaceScatteringEnabled = true;
-	float sssWidth = 10.0f;
-	bool taaEnabled = true;
-	float lightTheta = 60.0f;
-
 	glm::vec2 mouseHistory(0.0f);
 	float scrollHistory = 0.0f;
 
@@ -93,48 +494,81 @@ int main()
 			}
 		}
 
-		ImGui::Checkbox("Subsurface Scattering", &subsurfaceScatteringEnabled);
-		ImGui::SliderFloat("Scattering Radius (mm)", &sssWidth, 1.0f, 40.0f);
-		ImGui::Checkbox("Temporal AA", &taaEnabled);
-		ImGui::SliderFloat("Light Angle", &lightTheta, 0.0f, 360.0f);
+		ImGui::Checkbox("Subsurface Scattering", &settings.subsurfaceScatteringEnabled);
+		ImGui::SameLine();
+		ImGui::Checkbox("Half Resolution", &settings.sssHalfResolution);
+		ImGui::Combo("Scattering Technique", &settings.sssMode, "Separable\0" "Burley\0" "Split Screen (Separable | Burley)\0");
+		ImGui::Combo("Burley Samples", &settings.burleyQuality, "8 Samples\0" "16 Samples\0" "24 Samples\0" "32 Samples\0");
+		// profile settings only require regenerating the profile buffer content
+		if (!settings.sssProfiles.empty())
+		{
+			struct ProfileNameGetter { static bool ItemGetter(void* data, int idx, const char** out_str) { *out_str = ((SSSProfileSettings *)data)[idx].name.c_str(); return true; } };
+			// only selects the profile to edit, the materials keep the profiles assigned by the scene
+			ImGui::Combo("Edit Diffusion Profile", &settings.sssEditProfile, &ProfileNameGetter::ItemGetter, settings.sssProfiles.data(), static_cast<int>(settings.sssProfiles.size()));
+			SSSProfileSettings &profile = settings.sssProfiles[settings.sssEditProfile];
+			bool profileChanged = ImGui::SliderFloat("Scattering Radius (mm)", &profile.width, 1.0f, 40.0f);
+			profileChanged |= ImGui::Combo("Scattering Quality", &profile.quality, "7 Samples\0" "11 Samples\0" "17 Samples\0" "25 Samples\0");
+			profileChanged |= ImGui::ColorEdit3("Scattering Strength", &profile.strength[0]);
+			profileChanged |= ImGui::ColorEdit3("Scattering Falloff", &profile.falloff[0]);
+			if (profileChanged)
+			{
+				applySSSProfiles(renderer, settings);
+			}
+		}
+		ImGui::Checkbox("Tiled Blur (Shared Memory)", &settings.tiledBlur);
+		ImGui::Checkbox("Vertical Blur in Postprocessing", &settings.fusedSSSBlur);
+		ImGui::Checkbox("Temporal AA", &settings.taaEnabled);
+		ImGui::SliderFloat("Light Angle", &settings.lightTheta, 0.0f, 360.0f);
+		if (ImGui::Button("Reload Scene"))
+		{
+			// the current scene and settings are kept if the scene fails to load
+			scene::Scene reloadedScene;
+			Settings reloadedSettings = settings;
+			if (loadSceneFile(scenePath, reloadedScene, reloadedSettings, sceneError))
+			{
+				settings = reloadedSettings;
+				renderer.loadScene(reloadedScene);
+				applySSSProfiles(renderer, settings);
+				sceneError.clear();
+			}
+		}
+		if (!sceneError.empty())
+		{
+			ImGui::TextColored(ImVec4(1.0f, 0.3f, 0.3f, 1.0f), "%s", sceneError.c_str());
+		}
 		ImGui::Text("Application average %.3f ms/frame (%.1f FPS)", 1000.0f / ImGui::GetIO().Framerate, ImGui::GetIO().Framerate);
-		ImGui::Text("Subsurface Scattering Time %.3f ms", renderer.getSSSEffectTiming());
+		ImGui::Text("Shadow Pass Time %.3f ms", renderer.getShadowPassTiming());
+		ImGui::Text("Main Pass Time %.3f ms", renderer.getMainPassTiming());
+		ImGui::Text("Subsurface Scattering Time (%s Resolution) %.3f ms", settings.sssHalfResolution ? "Half" : "Full", renderer.getSSSEffectTiming());
+		ImGui::Text("    Separable %.3f ms | Burley %.3f ms", renderer.getSSSSeparableTiming(), renderer.getSSSBurleyTiming());
+		ImGui::Text("Postprocessing Time %.3f ms", renderer.getPostprocessTiming());
+		ImGui::Text("Async Compute %s", renderer.isAsyncComputeEnabled() ? "On" : "Off");
+		ImGui::Text("Startup %.1f ms | Pipelines %.1f ms (%s Cache)", startupTime, renderer.getPipelineCreationTiming(), renderer.isPipelineCacheWarm() ? "Warm" : "Cold");
+		if (ImGui::CollapsingHeader("Device Memory"))
+		{
+			const auto memoryStatistics = renderer.getMemoryStatistics();
+			for (size_t i = 0; i < memoryStatistics.size(); ++i)
+			{
+				const auto &stats = memoryStatistics[i];
+				if (stats.memoryObjectCount == 0)
+				{
+					continue;
+				}
+
+				const float mib = 1.0f / (1024.0f * 1024.0f);
+				ImGui::Text("Heap %d (%s, %.0f MiB)", static_cast<int>(i), (stats.heapFlags & VK_MEMORY_HEAP_DEVICE_LOCAL_BIT) ? "Device Local" : "Host", stats.heapSize * mib);
+				ImGui::Text("    %.1f / %.1f MiB used by %u allocations in %u memory objects", stats.usedSize * mib, stats.allocatedSize * mib, stats.allocationCount, stats.memoryObjectCount);
+			}
+		}
 		ImGui::End();
 
 		ImGui::Render();
 
-		// calculate light position
-		const float lightThetaRadians = glm::radians(lightTheta);
-		const glm::vec3 lightPos(glm::cos(lightThetaRadians), 0.2f, glm::sin(lightThetaRadians));
-
-		const float fovy = glm::radians(20.0f);
-
-		// calculate view, projection and shadow matrix
-		const glm::mat4 vulkanCorrection =
-		{
-			{ 1.0f, 0.0f, 0.0f, 0.0f },
-			{ 0.0f, -1.0f, 0.0f, 0.0f },
-			{ 0.0f, 0.0f, 0.5f, 0.0f },
-			{ 0.0f, 0.0f, 0.5f, 1.0f }
-		};
-
-		const glm::mat4 viewMatrix = camera.getViewMatrix();
-		const glm::mat4 viewProjection = vulkanCorrection * glm::perspective(fovy, width / float(height), 0.01f, 50.0f) * viewMatrix;
-		const glm::mat4 shadowMatrix = vulkanCorrection * glm::perspective(glm::radians(40.0f), 1.0f, 0.1f, 3.0f) * glm::lookAt(lightPos, glm::vec3(0.0f, 0.15f, 0.0f), glm::vec3(0.0f, 1.0f, 0.0f));
-		
 		if (!window.isIconified())
 		{
-			renderer.render(viewProjection,
-				shadowMatrix,
-				glm::vec4(lightPos, lightRadius),
-				glm::vec4(lightIntensity, 1.0f / (lightRadius * lightRadius)),
-				glm::vec4(camera.getPosition(), 0.0f),
-				subsurfaceScatteringEnabled,
-				sssWidth * 0.001f,
-				taaEnabled,
-				fovy);
+			renderFrame(renderer, camera, settings, width, height);
 		}
 	}
 
 	return EXIT_SUCCESS;
-}
\ No newline at end of file
+}
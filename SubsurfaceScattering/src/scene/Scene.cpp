@@ -0,0 +1,138 @@
+#include "Scene.h"
+#include <fstream>
+#include <cstring>
+
+namespace
+{
+	const uint32_t FILE_MAGIC = 0x4E435353; // "SSCN"
+	const uint32_t FILE_VERSION = 1;
+
+	// followed by the texture, material and profile arrays
+	struct FileHeader
+	{
+		uint32_t magic;
+		uint32_t version;
+		uint32_t textureCount;
+		uint32_t materialCount;
+		uint32_t profileCount;
+		char meshPath[sss::scene::MAX_PATH_LENGTH];
+		sss::scene::Light light;
+	};
+
+	bool isTerminated(const char *str, size_t size)
+	{
+		return memchr(str, '\0', size) != nullptr;
+	}
+}
+
+bool sss::scene::loadScene(const char *filepath, Scene &scene, std::string &error)
+{
+	std::vector<char> data;
+	{
+		std::ifstream file(filepath, std::ios::binary | std::ios::ate);
+		if (!file.is_open())
+		{
+			error = std::string("Failed to open scene file ") + filepath;
+			return false;
+		}
+
+		data.resize(static_cast<size_t>(file.tellg()));
+		file.seekg(0, std::ios::beg);
+
+		if (!file.read(data.data(), data.size()))
+		{
+			error = std::string("Failed to read scene file ") + filepath;
+			return false;
+		}
+	}
+
+	FileHeader header;
+	if (data.size() < sizeof(header))
+	{
+		error = std::string("Invalid scene file ") + filepath;
+		return false;
+	}
+	memcpy(&header, data.data(), sizeof(header));
+
+	if (header.magic != FILE_MAGIC || header.version != FILE_VERSION)
+	{
+		error = std::string("Unsupported scene file version in ") + filepath;
+		return false;
+	}
+
+	const size_t texturesSize = header.textureCount * sizeof(Texture);
+	const size_t materialsSize = header.materialCount * sizeof(Material);
+	const size_t profilesSize = header.profileCount * sizeof(SSSProfile);
+
+	if (header.textureCount > MAX_TEXTURE_COUNT || data.size() != sizeof(header) + texturesSize + materialsSize + profilesSize)
+	{
+		error = std::string("Invalid scene file ") + filepath;
+		return false;
+	}
+
+	memcpy(scene.meshPath, header.meshPath, sizeof(scene.meshPath));
+	scene.light = header.light;
+	scene.textures.resize(header.textureCount);
+	scene.materials.resize(header.materialCount);
+	scene.profiles.resize(header.profileCount);
+
+	const char *arrayData = data.data() + sizeof(header);
+	memcpy(scene.textures.data(), arrayData, texturesSize);
+	memcpy(scene.materials.data(), arrayData + texturesSize, materialsSize);
+	memcpy(scene.profiles.data(), arrayData + texturesSize + materialsSize, profilesSize);
+
+	// the renderer indexes with these values, so a corrupt file must not get past this point
+	bool valid = isTerminated(scene.meshPath, sizeof(scene.meshPath));
+	for (const auto &texture : scene.textures)
+	{
+		valid = valid && isTerminated(texture.path, sizeof(texture.path));
+	}
+	for (const auto &material : scene.materials)
+	{
+		const auto &m = material.material;
+		const uint32_t textures[] = { m.albedoTexture, m.normalTexture, m.glossTexture, m.specularTexture, m.cavityTexture, m.detailNormalTexture };
+		for (uint32_t texture : textures)
+		{
+			valid = valid && texture <= header.textureCount;
+		}
+		valid = valid && isTerminated(material.name, sizeof(material.name)) && (!material.sss || m.sssProfileIndex < header.profileCount);
+	}
+	for (const auto &profile : scene.profiles)
+	{
+		valid = valid && isTerminated(profile.name, sizeof(profile.name));
+	}
+
+	if (!valid)
+	{
+		error = std::string("Invalid scene file ") + filepath;
+		return false;
+	}
+
+	return true;
+}
+
+bool sss::scene::writeScene(const char *filepath, const Scene &scene, std::string &error)
+{
+	FileHeader header{};
+	header.magic = FILE_MAGIC;
+	header.version = FILE_VERSION;
+	header.textureCount = static_cast<uint32_t>(scene.textures.size());
+	header.materialCount = static_cast<uint32_t>(scene.materials.size());
+	header.profileCount = static_cast<uint32_t>(scene.profiles.size());
+	memcpy(header.meshPath, scene.meshPath, sizeof(header.meshPath));
+	header.light = scene.light;
+
+	std::ofstream file(filepath, std::ios::binary | std::ios::trunc);
+	const bool written = file.write(reinterpret_cast<const char *>(&header), sizeof(header))
+		&& file.write(reinterpret_cast<const char *>(scene.textures.data()), scene.textures.size() * sizeof(Texture))
+		&& file.write(reinterpret_cast<const char *>(scene.materials.data()), scene.materials.size() * sizeof(Material))
+		&& file.write(reinterpret_cast<const char *>(scene.profiles.data()), scene.profiles.size() * sizeof(SSSProfile));
+
+	if (!written)
+	{
+		error = std::string("Failed to write scene file ") + filepath;
+		return false;
+	}
+
+	return true;
+}
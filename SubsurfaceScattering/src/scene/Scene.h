@@ -0,0 +1,62 @@
+#pragma once
+#include <cstdint>
+#include <vector>
+#include <string>
+#include "vulkan/Material.h"
+
+namespace sss
+{
+	namespace scene
+	{
+		const uint32_t MAX_NAME_LENGTH = 64;
+		const uint32_t MAX_PATH_LENGTH = 256;
+		const uint32_t MAX_TEXTURE_COUNT = 10; // size of the texture array of lighting_frag.frag
+
+		// the structs below are stored as they are in the compiled scene file, so they only hold fixed size data
+
+		struct Texture
+		{
+			char path[MAX_PATH_LENGTH];
+		};
+
+		struct Material
+		{
+			char name[MAX_NAME_LENGTH]; // matched to the material names of the submeshes
+			vulkan::Material material; // texture indices are 1 based, 0 means no texture
+			uint32_t sss; // 1 if the material is rendered with subsurface scattering
+		};
+
+		struct SSSProfile
+		{
+			char name[MAX_NAME_LENGTH];
+			float width; // mm
+			uint32_t sampleCount;
+			float strength[3];
+			float falloff[3];
+		};
+
+		// a point light orbiting the origin
+		struct Light
+		{
+			float angle; // degrees
+			float height;
+			float radius;
+			float luminousPower;
+			float color[3];
+		};
+
+		struct Scene
+		{
+			char meshPath[MAX_PATH_LENGTH];
+			Light light;
+			std::vector<Texture> textures;
+			std::vector<Material> materials;
+			std::vector<SSSProfile> profiles;
+		};
+
+		// reads a scene compiled by compileScene() with a single read and validates its references
+		bool loadScene(const char *filepath, Scene &scene, std::string &error);
+		// writes the compiled scene file read by loadScene()
+		bool writeScene(const char *filepath, const Scene &scene, std::string &error);
+	}
+}
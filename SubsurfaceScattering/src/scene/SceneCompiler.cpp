@@ -0,0 +1,416 @@
+#include "SceneCompiler.h"
+#include <fstream>
+#include <sstream>
+#include <filesystem>
+#include <cstring>
+#include <cstdlib>
+#include <glm/vec4.hpp>
+#include <glm/packing.hpp>
+
+namespace
+{
+	using namespace sss::scene;
+
+	enum Block
+	{
+		BLOCK_NONE,
+		BLOCK_MATERIAL,
+		BLOCK_PROFILE,
+		BLOCK_LIGHT,
+	};
+
+	class Parser
+	{
+	public:
+		explicit Parser(const char *filepath, Scene &scene)
+			:m_filepath(filepath),
+			m_scene(scene),
+			m_lineNumber(),
+			m_block(BLOCK_NONE)
+		{
+		}
+
+		bool parseLine(const std::string &line, std::string &error)
+		{
+			++m_lineNumber;
+
+			std::istringstream stream(line.substr(0, line.find('#')));
+			m_tokens.clear();
+			for (std::string token; stream >> token; )
+			{
+				m_tokens.push_back(token);
+			}
+
+			if (m_tokens.empty())
+			{
+				return true;
+			}
+
+			if (!parseStatement())
+			{
+				error = m_filepath + ":" + std::to_string(m_lineNumber) + ": " + m_error;
+				return false;
+			}
+
+			return true;
+		}
+
+		bool finish(std::string &error)
+		{
+			if (m_scene.meshPath[0] == '\0')
+			{
+				error = m_filepath + ": No mesh specified!";
+				return false;
+			}
+			return true;
+		}
+
+	private:
+		std::string m_filepath;
+		Scene &m_scene;
+		uint32_t m_lineNumber;
+		Block m_block;
+		std::vector<std::string> m_tokens;
+		std::vector<std::string> m_textureNames;
+		std::string m_error;
+
+		bool fail(const std::string &message)
+		{
+			m_error = message;
+			return false;
+		}
+
+		bool expectArguments(size_t count)
+		{
+			if (m_tokens.size() != count + 1)
+			{
+				return fail("'" + m_tokens[0] + "' expects " + std::to_string(count) + " argument(s)");
+			}
+			return true;
+		}
+
+		bool parseFloats(size_t count, float *values)
+		{
+			if (!expectArguments(count))
+			{
+				return false;
+			}
+
+			for (size_t i = 0; i < count; ++i)
+			{
+				const char *str = m_tokens[i + 1].c_str();
+				char *end;
+				values[i] = strtof(str, &end);
+				if (end == str || *end != '\0')
+				{
+					return fail("Invalid number '" + m_tokens[i + 1] + "'");
+				}
+			}
+			return true;
+		}
+
+		// colors are given as 8 bit values
+		bool parseColor(float *color)
+		{
+			if (!parseFloats(3, color))
+			{
+				return false;
+			}
+
+			for (size_t i = 0; i < 3; ++i)
+			{
+				color[i] /= 255.0f;
+			}
+			return true;
+		}
+
+		bool copyString(const std::string &str, char *dst, size_t dstSize)
+		{
+			if (str.size() >= dstSize)
+			{
+				return fail("'" + str + "' is too long");
+			}
+			memcpy(dst, str.c_str(), str.size() + 1);
+			return true;
+		}
+
+		bool parseTextureReference(uint32_t &texture)
+		{
+			if (!expectArguments(1))
+			{
+				return false;
+			}
+
+			for (size_t i = 0; i < m_textureNames.size(); ++i)
+			{
+				if (m_textureNames[i] == m_tokens[1])
+				{
+					texture = static_cast<uint32_t>(i + 1);
+					return true;
+				}
+			}
+			return fail("Unknown texture '" + m_tokens[1] + "'");
+		}
+
+		bool parseStatement()
+		{
+			const std::string &keyword = m_tokens[0];
+
+			if (keyword == "mesh")
+			{
+				m_block = BLOCK_NONE;
+				return expectArguments(1) && copyString(m_tokens[1], m_scene.meshPath, sizeof(m_scene.meshPath));
+			}
+			else if (keyword == "texture")
+			{
+				m_block = BLOCK_NONE;
+				if (!expectArguments(2))
+				{
+					return false;
+				}
+				for (const auto &name : m_textureNames)
+				{
+					if (name == m_tokens[1])
+					{
+						return fail("Duplicate texture '" + name + "'");
+					}
+				}
+				if (m_scene.textures.size() == MAX_TEXTURE_COUNT)
+				{
+					return fail("Too many textures, the renderer supports " + std::to_string(MAX_TEXTURE_COUNT));
+				}
+				m_textureNames.push_back(m_tokens[1]);
+				m_scene.textures.push_back({});
+				return copyString(m_tokens[2], m_scene.textures.back().path, sizeof(m_scene.textures.back().path));
+			}
+			else if (keyword == "material")
+			{
+				m_block = BLOCK_MATERIAL;
+				if (!expectArguments(1))
+				{
+					return false;
+				}
+				for (const auto &material : m_scene.materials)
+				{
+					if (m_tokens[1] == material.name)
+					{
+						return fail("Duplicate material '" + m_tokens[1] + "'");
+					}
+				}
+				Material material{};
+				material.material.albedo = 0xFFFFFFFF;
+				m_scene.materials.push_back(material);
+				return copyString(m_tokens[1], m_scene.materials.back().name, sizeof(m_scene.materials.back().name));
+			}
+			else if (keyword == "profile")
+			{
+				m_block = BLOCK_PROFILE;
+				if (!expectArguments(1))
+				{
+					return false;
+				}
+				for (const auto &profile : m_scene.profiles)
+				{
+					if (m_tokens[1] == profile.name)
+					{
+						return fail("Duplicate profile '" + m_tokens[1] + "'");
+					}
+				}
+				SSSProfile profile{};
+				profile.width = 10.0f;
+				profile.sampleCount = 25;
+				m_scene.profiles.push_back(profile);
+				return copyString(m_tokens[1], m_scene.profiles.back().name, sizeof(m_scene.profiles.back().name));
+			}
+			else if (keyword == "light")
+			{
+				m_block = BLOCK_LIGHT;
+				return expectArguments(0);
+			}
+
+			switch (m_block)
+			{
+			case BLOCK_MATERIAL:
+				return parseMaterialProperty(m_scene.materials.back());
+			case BLOCK_PROFILE:
+				return parseProfileProperty(m_scene.profiles.back());
+			case BLOCK_LIGHT:
+				return parseLightProperty(m_scene.light);
+			default:
+				return fail("Unknown keyword '" + keyword + "'");
+			}
+		}
+
+		bool parseMaterialProperty(Material &material)
+		{
+			const std::string &property = m_tokens[0];
+			auto &m = material.material;
+
+			if (property == "sss")
+			{
+				if (!expectArguments(1))
+				{
+					return false;
+				}
+				for (size_t i = 0; i < m_scene.profiles.size(); ++i)
+				{
+					if (m_tokens[1] == m_scene.profiles[i].name)
+					{
+						material.sss = 1;
+						m.sssProfileIndex = static_cast<uint32_t>(i);
+						return true;
+					}
+				}
+				return fail("Unknown profile '" + m_tokens[1] + "'");
+			}
+			else if (property == "gloss")
+			{
+				return parseFloats(1, &m.gloss);
+			}
+			else if (property == "specular")
+			{
+				return parseFloats(1, &m.specular);
+			}
+			else if (property == "detailNormalScale")
+			{
+				return parseFloats(1, &m.detailNormalScale);
+			}
+			else if (property == "albedo")
+			{
+				float color[3];
+				if (!parseColor(color))
+				{
+					return false;
+				}
+				m.albedo = glm::packUnorm4x8(glm::vec4(color[0], color[1], color[2], 1.0f));
+				return true;
+			}
+			else if (property == "albedoTexture")
+			{
+				return parseTextureReference(m.albedoTexture);
+			}
+			else if (property == "normalTexture")
+			{
+				return parseTextureReference(m.normalTexture);
+			}
+			else if (property == "glossTexture")
+			{
+				return parseTextureReference(m.glossTexture);
+			}
+			else if (property == "specularTexture")
+			{
+				return parseTextureReference(m.specularTexture);
+			}
+			else if (property == "cavityTexture")
+			{
+				return parseTextureReference(m.cavityTexture);
+			}
+			else if (property == "detailNormalTexture")
+			{
+				return parseTextureReference(m.detailNormalTexture);
+			}
+			return fail("Unknown material property '" + property + "'");
+		}
+
+		bool parseProfileProperty(SSSProfile &profile)
+		{
+			const std::string &property = m_tokens[0];
+
+			if (property == "width")
+			{
+				return parseFloats(1, &profile.width);
+			}
+			else if (property == "samples")
+			{
+				float sampleCount;
+				if (!parseFloats(1, &sampleCount))
+				{
+					return false;
+				}
+				profile.sampleCount = static_cast<uint32_t>(sampleCount);
+				return true;
+			}
+			else if (property == "strength")
+			{
+				return parseFloats(3, profile.strength);
+			}
+			else if (property == "falloff")
+			{
+				return parseFloats(3, profile.falloff);
+			}
+			return fail("Unknown profile property '" + property + "'");
+		}
+
+		bool parseLightProperty(Light &light)
+		{
+			const std::string &property = m_tokens[0];
+
+			if (property == "angle")
+			{
+				return parseFloats(1, &light.angle);
+			}
+			else if (property == "height")
+			{
+				return parseFloats(1, &light.height);
+			}
+			else if (property == "radius")
+			{
+				return parseFloats(1, &light.radius);
+			}
+			else if (property == "power")
+			{
+				return parseFloats(1, &light.luminousPower);
+			}
+			else if (property == "color")
+			{
+				return parseColor(light.color);
+			}
+			return fail("Unknown light property '" + property + "'");
+		}
+	};
+}
+
+bool sss::scene::compileScene(const char *sourceFilepath, Scene &scene, std::string &error)
+{
+	std::ifstream file(sourceFilepath);
+	if (!file.is_open())
+	{
+		error = std::string("Failed to open scene file ") + sourceFilepath;
+		return false;
+	}
+
+	scene = {};
+	scene.light = { 60.0f, 0.2f, 5.0f, 700.0f, { 1.0f, 1.0f, 1.0f } };
+
+	Parser parser(sourceFilepath, scene);
+	for (std::string line; std::getline(file, line); )
+	{
+		if (!parser.parseLine(line, error))
+		{
+			return false;
+		}
+	}
+
+	return parser.finish(error);
+}
+
+bool sss::scene::updateCompiledScene(const char *sourceFilepath, const char *compiledFilepath, std::string &error)
+{
+	namespace fs = std::filesystem;
+
+	std::error_code ec;
+	const auto sourceTime = fs::last_write_time(sourceFilepath, ec);
+	if (ec)
+	{
+		return true;
+	}
+
+	const auto compiledTime = fs::last_write_time(compiledFilepath, ec);
+	if (!ec && compiledTime >= sourceTime)
+	{
+		return true;
+	}
+
+	Scene scene;
+	return compileScene(sourceFilepath, scene, error) && writeScene(compiledFilepath, scene, error);
+}
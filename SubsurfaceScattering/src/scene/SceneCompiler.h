@@ -0,0 +1,15 @@
+#pragma once
+#include <string>
+#include "Scene.h"
+
+namespace sss
+{
+	namespace scene
+	{
+		// parses a text scene file. see resources/scenes/default.scene for the format
+		bool compileScene(const char *sourceFilepath, Scene &scene, std::string &error);
+		// recompiles compiledFilepath if the source file exists and is newer. without the source file, as in a shipped build,
+		// the compiled file is used as it is
+		bool updateCompiledScene(const char *sourceFilepath, const char *compiledFilepath, std::string &error);
+	}
+}
@@ -0,0 +1,103 @@
+#include "Archive.h"
+#include "Utility.h"
+#include <string>
+#include <cstdlib>
+#include <cstring>
+#include <algorithm>
+
+namespace
+{
+	const uint32_t ARCHIVE_MAGIC = 0x4B505353; // "SSPK"
+	const uint32_t ARCHIVE_VERSION = 1;
+	const uint64_t ARCHIVE_ALIGNMENT = 4096;
+
+	struct ArchiveHeader
+	{
+		uint32_t magic;
+		uint32_t version;
+		uint32_t entryCount;
+		uint32_t pathTableSize;
+		uint64_t fileSize;
+	};
+}
+
+struct sss::util::Archive::Entry
+{
+	uint32_t pathOffset; // relative to the start of the path table
+	uint32_t pathLength;
+	uint64_t offset;
+	uint64_t size;
+	uint64_t hash;
+};
+
+sss::util::Archive::Archive(const char *filepath)
+	:m_file(filepath),
+	m_entries(),
+	m_pathTable(),
+	m_entryCount()
+{
+	const uint8_t *data = m_file.getData();
+	const size_t size = m_file.getSize();
+
+	ArchiveHeader header;
+	if (size < sizeof(header))
+	{
+		fatalExit(("Invalid archive: " + std::string(filepath)).c_str(), EXIT_FAILURE);
+	}
+
+	memcpy(&header, data, sizeof(header));
+
+	const uint64_t tocSize = sizeof(header) + uint64_t(header.entryCount) * sizeof(Entry) + header.pathTableSize;
+
+	if (header.magic != ARCHIVE_MAGIC || header.version != ARCHIVE_VERSION || header.fileSize != size || tocSize > size)
+	{
+		fatalExit(("Invalid or unsupported archive, pack it again with AssetPacker: " + std::string(filepath)).c_str(), EXIT_FAILURE);
+	}
+
+	// the mapping is page aligned, so the entries directly following the header can be used in place
+	m_entries = reinterpret_cast<const Entry *>(data + sizeof(header));
+	m_pathTable = reinterpret_cast<const char *>(m_entries + header.entryCount);
+	m_entryCount = header.entryCount;
+
+	// validate the table of contents once, so that find() can hand out views without further checks.
+	// the content hashes are not checked here, as that would read the whole archive; use AssetPacker --verify
+	for (uint32_t i = 0; i < m_entryCount; ++i)
+	{
+		const Entry &entry = m_entries[i];
+		const bool pathValid = uint64_t(entry.pathOffset) + entry.pathLength <= header.pathTableSize;
+		const bool payloadValid = entry.offset % ARCHIVE_ALIGNMENT == 0 && entry.offset >= tocSize && entry.offset <= size && entry.size <= size - entry.offset;
+
+		if (!pathValid || !payloadValid)
+		{
+			fatalExit(("Corrupt archive: " + std::string(filepath)).c_str(), EXIT_FAILURE);
+		}
+	}
+}
+
+bool sss::util::Archive::find(const char *path, const uint8_t *&data, size_t &size) const
+{
+	// entries are sorted by path
+	std::string key = path;
+	std::replace(key.begin(), key.end(), '\\', '/');
+
+	auto comparePath = [this](const Entry &entry, const std::string &str)
+	{
+		return str.compare(0, std::string::npos, m_pathTable + entry.pathOffset, entry.pathLength) > 0;
+	};
+
+	const Entry *entry = std::lower_bound(m_entries, m_entries + m_entryCount, key, comparePath);
+
+	if (entry == m_entries + m_entryCount || key.compare(0, std::string::npos, m_pathTable + entry->pathOffset, entry->pathLength) != 0)
+	{
+		return false;
+	}
+
+	data = m_file.getData() + entry->offset;
+	size = static_cast<size_t>(entry->size);
+	return true;
+}
+
+uint32_t sss::util::Archive::getFileCount() const
+{
+	return m_entryCount;
+}
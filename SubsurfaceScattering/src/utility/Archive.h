@@ -0,0 +1,33 @@
+#pragma once
+#include <cstdint>
+#include <cstddef>
+#include "MappedFile.h"
+
+namespace sss
+{
+	namespace util
+	{
+		// read only pack file written by AssetPacker. the archive is mapped as a whole and files are handed out as views
+		// into the mapping, so looking up a file neither opens nor copies anything. payloads are aligned to 4096 bytes
+		class Archive
+		{
+		public:
+			explicit Archive(const char *filepath);
+			Archive(const Archive &) = delete;
+			Archive(const Archive &&) = delete;
+			Archive &operator= (const Archive &) = delete;
+			Archive &operator= (const Archive &&) = delete;
+			// returns false if the archive does not contain the file. paths are relative to the working directory
+			bool find(const char *path, const uint8_t *&data, size_t &size) const;
+			uint32_t getFileCount() const;
+
+		private:
+			struct Entry;
+
+			MappedFile m_file;
+			const Entry *m_entries;
+			const char *m_pathTable;
+			uint32_t m_entryCount;
+		};
+	}
+}
@@ -0,0 +1,39 @@
+#include "AssetFile.h"
+#include "Archive.h"
+#include "MappedFile.h"
+
+namespace
+{
+	std::unique_ptr<sss::util::Archive> s_archive;
+}
+
+void sss::util::AssetFile::mountArchive(const char *filepath)
+{
+	s_archive = std::make_unique<Archive>(filepath);
+}
+
+sss::util::AssetFile::AssetFile(const char *path)
+	:m_data(),
+	m_size()
+{
+	if (s_archive && s_archive->find(path, m_data, m_size))
+	{
+		return;
+	}
+
+	m_file = std::make_unique<MappedFile>(path);
+	m_data = m_file->getData();
+	m_size = m_file->getSize();
+}
+
+sss::util::AssetFile::~AssetFile() = default;
+
+const uint8_t *sss::util::AssetFile::getData() const
+{
+	return m_data;
+}
+
+size_t sss::util::AssetFile::getSize() const
+{
+	return m_size;
+}
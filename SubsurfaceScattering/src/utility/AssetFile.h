@@ -0,0 +1,35 @@
+#pragma once
+#include <cstdint>
+#include <cstddef>
+#include <memory>
+
+namespace sss
+{
+	namespace util
+	{
+		class MappedFile;
+
+		// read only view of an asset. the file is taken from the mounted archive if it contains it and mapped from disk
+		// otherwise. either way the data is at least 4 byte aligned and not copied
+		class AssetFile
+		{
+		public:
+			// all assets opened afterwards are looked up in this archive first. not thread safe, mount before loading assets
+			static void mountArchive(const char *filepath);
+			explicit AssetFile(const char *path);
+			AssetFile(const AssetFile &) = delete;
+			AssetFile(const AssetFile &&) = delete;
+			AssetFile &operator= (const AssetFile &) = delete;
+			AssetFile &operator= (const AssetFile &&) = delete;
+			~AssetFile();
+			// nullptr for empty files
+			const uint8_t *getData() const;
+			size_t getSize() const;
+
+		private:
+			std::unique_ptr<MappedFile> m_file; // nullptr if the file is in the archive
+			const uint8_t *m_data;
+			size_t m_size;
+		};
+	}
+}
@@ -0,0 +1,127 @@
+#include "MappedFile.h"
+#include "Utility.h"
+#include <string>
+#ifdef _WIN32
+#include <Windows.h>
+#else
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#endif
+
+#ifdef _WIN32
+sss::util::MappedFile::MappedFile(const char *filepath)
+	:m_fileHandle(INVALID_HANDLE_VALUE),
+	m_mappingHandle(nullptr),
+	m_data(),
+	m_size()
+{
+	// the file is read front to back, which lets the os read ahead
+	m_fileHandle = CreateFileA(filepath, GENERIC_READ, FILE_SHARE_READ, nullptr, OPEN_EXISTING, FILE_ATTRIBUTE_NORMAL | FILE_FLAG_SEQUENTIAL_SCAN, nullptr);
+
+	if (m_fileHandle == INVALID_HANDLE_VALUE)
+	{
+		std::string msg = "Failed to open file " + std::string(filepath) + "!";
+		fatalExit(msg.c_str(), -1);
+	}
+
+	LARGE_INTEGER fileSize;
+	if (!GetFileSizeEx(m_fileHandle, &fileSize))
+	{
+		std::string msg = "Failed to read file " + std::string(filepath) + "!";
+		fatalExit(msg.c_str(), -1);
+	}
+
+	m_size = static_cast<size_t>(fileSize.QuadPart);
+
+	// empty files can not be mapped
+	if (m_size == 0)
+	{
+		return;
+	}
+
+	m_mappingHandle = CreateFileMappingA(m_fileHandle, nullptr, PAGE_READONLY, 0, 0, nullptr);
+	m_data = m_mappingHandle ? reinterpret_cast<const uint8_t *>(MapViewOfFile(m_mappingHandle, FILE_MAP_READ, 0, 0, 0)) : nullptr;
+
+	if (!m_data)
+	{
+		std::string msg = "Failed to map file " + std::string(filepath) + "!";
+		fatalExit(msg.c_str(), -1);
+	}
+}
+
+sss::util::MappedFile::~MappedFile()
+{
+	if (m_data)
+	{
+		UnmapViewOfFile(m_data);
+	}
+	if (m_mappingHandle)
+	{
+		CloseHandle(m_mappingHandle);
+	}
+	CloseHandle(m_fileHandle);
+}
+#else
+sss::util::MappedFile::MappedFile(const char *filepath)
+	:m_file(-1),
+	m_data(),
+	m_size()
+{
+	m_file = open(filepath, O_RDONLY);
+
+	if (m_file < 0)
+	{
+		std::string msg = "Failed to open file " + std::string(filepath) + "!";
+		fatalExit(msg.c_str(), -1);
+	}
+
+	struct stat fileStat;
+	if (fstat(m_file, &fileStat) != 0)
+	{
+		std::string msg = "Failed to read file " + std::string(filepath) + "!";
+		fatalExit(msg.c_str(), -1);
+	}
+
+	m_size = static_cast<size_t>(fileStat.st_size);
+
+	// empty files can not be mapped
+	if (m_size == 0)
+	{
+		return;
+	}
+
+	void *data = mmap(nullptr, m_size, PROT_READ, MAP_PRIVATE, m_file, 0);
+
+	if (data == MAP_FAILED)
+	{
+		std::string msg = "Failed to map file " + std::string(filepath) + "!";
+		fatalExit(msg.c_str(), -1);
+	}
+
+	m_data = static_cast<const uint8_t *>(data);
+
+	// the file is read front to back, which lets the os read ahead
+	madvise(data, m_size, MADV_SEQUENTIAL);
+}
+
+sss::util::MappedFile::~MappedFile()
+{
+	if (m_data)
+	{
+		munmap(const_cast<uint8_t *>(m_data), m_size);
+	}
+	close(m_file);
+}
+#endif
+
+const uint8_t *sss::util::MappedFile::getData() const
+{
+	return m_data;
+}
+
+size_t sss::util::MappedFile::getSize() const
+{
+	return m_size;
+}
@@ -0,0 +1,35 @@
+#pragma once
+#include <cstdint>
+#include <cstddef>
+
+namespace sss
+{
+	namespace util
+	{
+		// read only view of a whole file mapped into memory. pages are read by the os on first access, so the file contents
+		// can be consumed without copying them into an intermediate buffer first
+		class MappedFile
+		{
+		public:
+			explicit MappedFile(const char *filepath);
+			MappedFile(const MappedFile &) = delete;
+			MappedFile(const MappedFile &&) = delete;
+			MappedFile &operator= (const MappedFile &) = delete;
+			MappedFile &operator= (const MappedFile &&) = delete;
+			~MappedFile();
+			// nullptr for empty files
+			const uint8_t *getData() const;
+			size_t getSize() const;
+
+		private:
+#ifdef _WIN32
+			void *m_fileHandle;
+			void *m_mappingHandle;
+#else
+			int m_file;
+#endif
+			const uint8_t *m_data;
+			size_t m_size;
+		};
+	}
+}
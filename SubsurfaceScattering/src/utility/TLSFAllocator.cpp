@@ -0,0 +1,306 @@
+#include "TLSFAllocator.h"
+#include <cassert>
+#include <algorithm>
+#ifdef _MSC_VER
+#include <intrin.h>
+#endif
+
+namespace
+{
+	uint32_t findMSB(uint64_t value)
+	{
+		assert(value != 0);
+#ifdef _MSC_VER
+		unsigned long index;
+		_BitScanReverse64(&index, value);
+		return static_cast<uint32_t>(index);
+#else
+		return 63 - static_cast<uint32_t>(__builtin_clzll(value));
+#endif
+	}
+
+	uint32_t findLSB(uint64_t value)
+	{
+		assert(value != 0);
+#ifdef _MSC_VER
+		unsigned long index;
+		_BitScanForward64(&index, value);
+		return static_cast<uint32_t>(index);
+#else
+		return static_cast<uint32_t>(__builtin_ctzll(value));
+#endif
+	}
+}
+
+sss::util::TLSFAllocator::TLSFAllocator(uint64_t size)
+	:m_size(size),
+	m_usedSize(),
+	m_allocationCount(),
+	m_firstLevelBitmap(),
+	m_secondLevelBitmaps()
+{
+	for (auto &list : m_freeLists)
+	{
+		std::fill(list, list + SECOND_LEVEL_COUNT, INVALID_HANDLE);
+	}
+
+	insertFreeBlock(createBlock(0, size, INVALID_HANDLE, INVALID_HANDLE));
+}
+
+uint32_t sss::util::TLSFAllocator::alloc(uint64_t size, uint64_t alignment, uint64_t &offset)
+{
+	assert(alignment != 0 && (alignment & (alignment - 1)) == 0);
+
+	size = std::max<uint64_t>(size, 1);
+
+	// look for a block that fits the size even in the worst case of alignment
+	const uint32_t blockIndex = findFreeBlock(size + alignment - 1);
+
+	if (blockIndex == INVALID_HANDLE)
+	{
+		return INVALID_HANDLE;
+	}
+
+	removeFreeBlock(blockIndex);
+
+	// split off the padding in front as a separate free block. the physical predecessor of a free block is never free,
+	// so there is nothing to merge with
+	const uint64_t blockOffset = m_blocks[blockIndex].offset;
+	const uint64_t alignedOffset = (blockOffset + alignment - 1) & ~(alignment - 1);
+	if (alignedOffset != blockOffset)
+	{
+		const uint32_t paddingBlock = createBlock(blockOffset, alignedOffset - blockOffset, m_blocks[blockIndex].prevPhysical, blockIndex);
+		if (m_blocks[paddingBlock].prevPhysical != INVALID_HANDLE)
+		{
+			m_blocks[m_blocks[paddingBlock].prevPhysical].nextPhysical = paddingBlock;
+		}
+		m_blocks[blockIndex].prevPhysical = paddingBlock;
+		m_blocks[blockIndex].offset = alignedOffset;
+		m_blocks[blockIndex].size -= alignedOffset - blockOffset;
+		insertFreeBlock(paddingBlock);
+	}
+
+	// return the remainder to the free lists
+	if (m_blocks[blockIndex].size > size)
+	{
+		const uint32_t remainderBlock = createBlock(alignedOffset + size, m_blocks[blockIndex].size - size, blockIndex, m_blocks[blockIndex].nextPhysical);
+		if (m_blocks[remainderBlock].nextPhysical != INVALID_HANDLE)
+		{
+			m_blocks[m_blocks[remainderBlock].nextPhysical].prevPhysical = remainderBlock;
+		}
+		m_blocks[blockIndex].nextPhysical = remainderBlock;
+		m_blocks[blockIndex].size = size;
+		insertFreeBlock(remainderBlock);
+	}
+
+	m_usedSize += size;
+	++m_allocationCount;
+
+	offset = alignedOffset;
+	return blockIndex;
+}
+
+void sss::util::TLSFAllocator::free(uint32_t handle)
+{
+	assert(handle < m_blocks.size() && !m_blocks[handle].free);
+
+	uint32_t blockIndex = handle;
+	m_usedSize -= m_blocks[blockIndex].size;
+	--m_allocationCount;
+
+	// merge with the previous block
+	const uint32_t prevIndex = m_blocks[blockIndex].prevPhysical;
+	if (prevIndex != INVALID_HANDLE && m_blocks[prevIndex].free)
+	{
+		removeFreeBlock(prevIndex);
+		m_blocks[prevIndex].size += m_blocks[blockIndex].size;
+		m_blocks[prevIndex].nextPhysical = m_blocks[blockIndex].nextPhysical;
+		if (m_blocks[prevIndex].nextPhysical != INVALID_HANDLE)
+		{
+			m_blocks[m_blocks[prevIndex].nextPhysical].prevPhysical = prevIndex;
+		}
+		destroyBlock(blockIndex);
+		blockIndex = prevIndex;
+	}
+
+	// merge with the next block
+	const uint32_t nextIndex = m_blocks[blockIndex].nextPhysical;
+	if (nextIndex != INVALID_HANDLE && m_blocks[nextIndex].free)
+	{
+		removeFreeBlock(nextIndex);
+		m_blocks[blockIndex].size += m_blocks[nextIndex].size;
+		m_blocks[blockIndex].nextPhysical = m_blocks[nextIndex].nextPhysical;
+		if (m_blocks[blockIndex].nextPhysical != INVALID_HANDLE)
+		{
+			m_blocks[m_blocks[blockIndex].nextPhysical].prevPhysical = blockIndex;
+		}
+		destroyBlock(nextIndex);
+	}
+
+	insertFreeBlock(blockIndex);
+}
+
+uint64_t sss::util::TLSFAllocator::getSize() const
+{
+	return m_size;
+}
+
+uint64_t sss::util::TLSFAllocator::getUsedSize() const
+{
+	return m_usedSize;
+}
+
+uint32_t sss::util::TLSFAllocator::getAllocationCount() const
+{
+	return m_allocationCount;
+}
+
+uint64_t sss::util::TLSFAllocator::getLargestFreeBlockSize() const
+{
+	if (m_firstLevelBitmap == 0)
+	{
+		return 0;
+	}
+
+	// only the highest non-empty list can contain the largest block, but its blocks are not sorted
+	const uint32_t firstLevel = findMSB(m_firstLevelBitmap);
+	const uint32_t secondLevel = findMSB(m_secondLevelBitmaps[firstLevel]);
+
+	uint64_t largestSize = 0;
+	for (uint32_t blockIndex = m_freeLists[firstLevel][secondLevel]; blockIndex != INVALID_HANDLE; blockIndex = m_blocks[blockIndex].nextFree)
+	{
+		largestSize = std::max(largestSize, m_blocks[blockIndex].size);
+	}
+
+	return largestSize;
+}
+
+void sss::util::TLSFAllocator::mapping(uint64_t size, uint32_t &firstLevel, uint32_t &secondLevel) const
+{
+	// small sizes map linearly into the first list
+	if (size < SECOND_LEVEL_COUNT)
+	{
+		firstLevel = 0;
+		secondLevel = static_cast<uint32_t>(size);
+		return;
+	}
+
+	const uint32_t msb = findMSB(size);
+	firstLevel = msb - SECOND_LEVEL_BITS + 1;
+	secondLevel = static_cast<uint32_t>(size >> (msb - SECOND_LEVEL_BITS)) - SECOND_LEVEL_COUNT;
+}
+
+uint32_t sss::util::TLSFAllocator::findFreeBlock(uint64_t size) const
+{
+	// round up to the next list so that every block found is large enough
+	if (size >= SECOND_LEVEL_COUNT)
+	{
+		const uint64_t roundUp = (uint64_t(1) << (findMSB(size) - SECOND_LEVEL_BITS)) - 1;
+		if (size > ~uint64_t(0) - roundUp)
+		{
+			return INVALID_HANDLE;
+		}
+		size += roundUp;
+	}
+
+	uint32_t firstLevel;
+	uint32_t secondLevel;
+	mapping(size, firstLevel, secondLevel);
+
+	uint32_t secondLevelBitmap = m_secondLevelBitmaps[firstLevel] & (~0u << secondLevel);
+
+	if (secondLevelBitmap == 0)
+	{
+		const uint64_t firstLevelBitmap = firstLevel + 1 < FIRST_LEVEL_COUNT ? m_firstLevelBitmap & (~uint64_t(0) << (firstLevel + 1)) : 0;
+
+		if (firstLevelBitmap == 0)
+		{
+			return INVALID_HANDLE;
+		}
+
+		firstLevel = findLSB(firstLevelBitmap);
+		secondLevelBitmap = m_secondLevelBitmaps[firstLevel];
+	}
+
+	secondLevel = findLSB(secondLevelBitmap);
+
+	return m_freeLists[firstLevel][secondLevel];
+}
+
+void sss::util::TLSFAllocator::insertFreeBlock(uint32_t block)
+{
+	uint32_t firstLevel;
+	uint32_t secondLevel;
+	mapping(m_blocks[block].size, firstLevel, secondLevel);
+
+	const uint32_t head = m_freeLists[firstLevel][secondLevel];
+
+	m_blocks[block].free = true;
+	m_blocks[block].prevFree = INVALID_HANDLE;
+	m_blocks[block].nextFree = head;
+
+	if (head != INVALID_HANDLE)
+	{
+		m_blocks[head].prevFree = block;
+	}
+
+	m_freeLists[firstLevel][secondLevel] = block;
+	m_firstLevelBitmap |= uint64_t(1) << firstLevel;
+	m_secondLevelBitmaps[firstLevel] |= 1u << secondLevel;
+}
+
+void sss::util::TLSFAllocator::removeFreeBlock(uint32_t block)
+{
+	uint32_t firstLevel;
+	uint32_t secondLevel;
+	mapping(m_blocks[block].size, firstLevel, secondLevel);
+
+	const uint32_t prevFree = m_blocks[block].prevFree;
+	const uint32_t nextFree = m_blocks[block].nextFree;
+
+	if (prevFree != INVALID_HANDLE)
+	{
+		m_blocks[prevFree].nextFree = nextFree;
+	}
+	else
+	{
+		m_freeLists[firstLevel][secondLevel] = nextFree;
+	}
+
+	if (nextFree != INVALID_HANDLE)
+	{
+		m_blocks[nextFree].prevFree = prevFree;
+	}
+
+	if (m_freeLists[firstLevel][secondLevel] == INVALID_HANDLE)
+	{
+		m_secondLevelBitmaps[firstLevel] &= ~(1u << secondLevel);
+		if (m_secondLevelBitmaps[firstLevel] == 0)
+		{
+			m_firstLevelBitmap &= ~(uint64_t(1) << firstLevel);
+		}
+	}
+
+	m_blocks[block].free = false;
+}
+
+uint32_t sss::util::TLSFAllocator::createBlock(uint64_t offset, uint64_t size, uint32_t prevPhysical, uint32_t nextPhysical)
+{
+	const Block block{ offset, size, prevPhysical, nextPhysical, INVALID_HANDLE, INVALID_HANDLE, false };
+
+	if (!m_unusedBlocks.empty())
+	{
+		const uint32_t index = m_unusedBlocks.back();
+		m_unusedBlocks.pop_back();
+		m_blocks[index] = block;
+		return index;
+	}
+
+	m_blocks.push_back(block);
+	return static_cast<uint32_t>(m_blocks.size() - 1);
+}
+
+void sss::util::TLSFAllocator::destroyBlock(uint32_t block)
+{
+	m_unusedBlocks.push_back(block);
+}
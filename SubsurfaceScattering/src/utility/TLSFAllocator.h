@@ -0,0 +1,65 @@
+#pragma once
+#include <cstdint>
+#include <vector>
+
+namespace sss
+{
+	namespace util
+	{
+		// two level segregated fit allocator managing offsets into a range of the given size. allocation and free are O(1):
+		// free blocks are kept in lists bucketed by the highest set bit of their size and a linear subdivision of it,
+		// and neighbouring free blocks are merged on free. the allocator does not own any memory itself
+		class TLSFAllocator
+		{
+		public:
+			enum : uint32_t
+			{
+				INVALID_HANDLE = ~0u
+			};
+
+			explicit TLSFAllocator(uint64_t size);
+			// returns INVALID_HANDLE if there is no free block large enough
+			uint32_t alloc(uint64_t size, uint64_t alignment, uint64_t &offset);
+			void free(uint32_t handle);
+			uint64_t getSize() const;
+			uint64_t getUsedSize() const;
+			uint32_t getAllocationCount() const;
+			uint64_t getLargestFreeBlockSize() const;
+
+		private:
+			enum : uint32_t
+			{
+				SECOND_LEVEL_BITS = 4,
+				SECOND_LEVEL_COUNT = 1u << SECOND_LEVEL_BITS,
+				FIRST_LEVEL_COUNT = 64 - SECOND_LEVEL_BITS + 1,
+			};
+
+			struct Block
+			{
+				uint64_t offset;
+				uint64_t size;
+				uint32_t prevPhysical;
+				uint32_t nextPhysical;
+				uint32_t prevFree;
+				uint32_t nextFree;
+				bool free;
+			};
+
+			uint64_t m_size;
+			uint64_t m_usedSize;
+			uint32_t m_allocationCount;
+			uint64_t m_firstLevelBitmap;
+			uint32_t m_secondLevelBitmaps[FIRST_LEVEL_COUNT];
+			uint32_t m_freeLists[FIRST_LEVEL_COUNT][SECOND_LEVEL_COUNT];
+			std::vector<Block> m_blocks;
+			std::vector<uint32_t> m_unusedBlocks;
+
+			void mapping(uint64_t size, uint32_t &firstLevel, uint32_t &secondLevel) const;
+			uint32_t findFreeBlock(uint64_t size) const;
+			void insertFreeBlock(uint32_t block);
+			void removeFreeBlock(uint32_t block);
+			uint32_t createBlock(uint64_t offset, uint64_t size, uint32_t prevPhysical, uint32_t nextPhysical);
+			void destroyBlock(uint32_t block);
+		};
+	}
+}
@@ -1,7 +1,13 @@
 #include "Utility.h"
 #include <fstream>
+#include <cstdio>
 #include <Windows.h>
 
+namespace
+{
+	bool g_headless = false;
+}
+
 std::vector<char> sss::util::readBinaryFile(const char * filepath)
 {
 	std::ifstream file(filepath, std::ios::binary | std::ios::ate);
@@ -30,10 +36,20 @@ std::vector<char> sss::util::readBinaryFile(const char * filepath)
 
 void sss::util::fatalExit(const char * message, int exitCode)
 {
-	MessageBox(nullptr, message, nullptr, MB_OK | MB_ICONERROR);
+	// also log to stderr so failures of headless runs end up in the log
+	fprintf(stderr, "%s\n", message);
+	if (!g_headless)
+	{
+		MessageBox(nullptr, message, nullptr, MB_OK | MB_ICONERROR);
+	}
 	exit(exitCode);
 }
 
+void sss::util::setHeadless(bool headless)
+{
+	g_headless = headless;
+}
+
 std::string sss::util::getFileExtension(const std::string & filepath)
 {
 	return filepath.substr(filepath.find_last_of('.') + 1);
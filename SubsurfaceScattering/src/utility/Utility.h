@@ -8,6 +8,8 @@ namespace sss
 	{
 		std::vector<char> readBinaryFile(const char *filepath);
 		void fatalExit(const char *message, int exitCode);
+		// headless runs report fatal errors on stderr only instead of blocking on a message box
+		void setHeadless(bool headless);
 		std::string getFileExtension(const std::string &filepath);
 
 		template <class T>
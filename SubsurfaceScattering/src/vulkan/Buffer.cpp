@@ -2,13 +2,11 @@
 #include "VKUtility.h"
 #include "utility/Utility.h"
 
-sss::vulkan::Buffer::Buffer(VkPhysicalDevice physicalDevice, VkDevice device, const VkBufferCreateInfo & createInfo, VkMemoryPropertyFlags requiredFlags, VkMemoryPropertyFlags preferredFlags)
-	:m_physicalDevice(physicalDevice),
-	m_device(device),
-	m_size(createInfo.size),
-	m_mappedPtr()
+sss::vulkan::Buffer::Buffer(MemoryAllocator &allocator, const VkBufferCreateInfo & createInfo, VkMemoryPropertyFlags requiredFlags, VkMemoryPropertyFlags preferredFlags, MemoryPool pool)
+	:m_allocator(allocator),
+	m_size(createInfo.size)
 {
-	if (vkutil::createBuffer(m_physicalDevice, m_device, createInfo, requiredFlags, preferredFlags, m_buffer, m_memory) != VK_SUCCESS)
+	if (vkutil::createBuffer(m_allocator, createInfo, requiredFlags, preferredFlags, pool, m_buffer, m_allocation) != VK_SUCCESS)
 	{
 		util::fatalExit("Failed to create buffer!", EXIT_FAILURE);
 	}
@@ -16,8 +14,8 @@ sss::vulkan::Buffer::Buffer(VkPhysicalDevice physicalDevice, VkDevice device, co
 
 sss::vulkan::Buffer::~Buffer()
 {
-	vkDestroyBuffer(m_device, m_buffer, nullptr);
-	vkFreeMemory(m_device, m_memory, nullptr);
+	vkDestroyBuffer(m_allocator.getDevice(), m_buffer, nullptr);
+	m_allocator.free(m_allocation);
 }
 
 VkBuffer sss::vulkan::Buffer::getBuffer() const
@@ -27,7 +25,7 @@ VkBuffer sss::vulkan::Buffer::getBuffer() const
 
 VkDeviceMemory sss::vulkan::Buffer::getMemory() const
 {
-	return m_memory;
+	return m_allocation.memory;
 }
 
 size_t sss::vulkan::Buffer::getSize() const
@@ -37,21 +35,9 @@ size_t sss::vulkan::Buffer::getSize() const
 
 uint8_t *sss::vulkan::Buffer::map()
 {
-	if (!m_mappedPtr)
+	if (!m_allocation.mappedPtr)
 	{
-		if (vkMapMemory(m_device, m_memory, 0, m_size, 0, (void **)&m_mappedPtr) != VK_SUCCESS)
-		{
-			util::fatalExit("Failed to map constant buffer memory!", EXIT_FAILURE);
-		}
-	}
-	return m_mappedPtr;
-}
-
-void sss::vulkan::Buffer::unmap()
-{
-	if (m_mappedPtr)
-	{
-		vkUnmapMemory(m_device, m_memory);
-		m_mappedPtr = nullptr;
+		util::fatalExit("Failed to map buffer memory!", EXIT_FAILURE);
 	}
+	return m_allocation.mappedPtr;
 }
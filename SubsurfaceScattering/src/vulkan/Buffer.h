@@ -1,5 +1,6 @@
 #pragma once
 #include "volk.h"
+#include "MemoryAllocator.h"
 
 namespace sss
 {
@@ -8,7 +9,7 @@ namespace sss
 		class Buffer
 		{
 		public:
-			explicit Buffer(VkPhysicalDevice physicalDevice, VkDevice device, const VkBufferCreateInfo &createInfo, VkMemoryPropertyFlags requiredFlags, VkMemoryPropertyFlags preferredFlags);
+			explicit Buffer(MemoryAllocator &allocator, const VkBufferCreateInfo &createInfo, VkMemoryPropertyFlags requiredFlags, VkMemoryPropertyFlags preferredFlags, MemoryPool pool = MEMORY_POOL_DEFAULT);
 			Buffer(const Buffer &) = delete;
 			Buffer(const Buffer &&) = delete;
 			Buffer &operator= (const Buffer &) = delete;
@@ -17,16 +18,14 @@ namespace sss
 			VkBuffer getBuffer() const;
 			VkDeviceMemory getMemory() const;
 			size_t getSize() const;
+			// host visible memory stays mapped for the lifetime of the buffer
 			uint8_t *map();
-			void unmap();
 
 		private:
-			VkPhysicalDevice m_physicalDevice;
-			VkDevice m_device;
+			MemoryAllocator &m_allocator;
 			VkDeviceSize m_size;
-			uint8_t *m_mappedPtr;
 			VkBuffer m_buffer;
-			VkDeviceMemory m_memory;
+			MemoryAllocator::Allocation m_allocation;
 		};
 	}
 }
\ No newline at end of file
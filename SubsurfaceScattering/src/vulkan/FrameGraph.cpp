@@ -0,0 +1,212 @@
+#include "FrameGraph.h"
+#include <cassert>
+
+namespace
+{
+	struct StateInfo
+	{
+		VkImageLayout layout;
+		VkPipelineStageFlags stages;
+		VkAccessFlags readAccess;
+		VkAccessFlags writeAccess;
+	};
+
+	// indexed by sss::vulkan::ResourceState
+	const StateInfo s_stateInfos[] =
+	{
+		{ VK_IMAGE_LAYOUT_TRANSFER_SRC_OPTIMAL, VK_PIPELINE_STAGE_TRANSFER_BIT, VK_ACCESS_TRANSFER_READ_BIT, 0 },
+		{ VK_IMAGE_LAYOUT_TRANSFER_DST_OPTIMAL, VK_PIPELINE_STAGE_TRANSFER_BIT, 0, VK_ACCESS_TRANSFER_WRITE_BIT },
+		{ VK_IMAGE_LAYOUT_UNDEFINED, VK_PIPELINE_STAGE_DRAW_INDIRECT_BIT, VK_ACCESS_INDIRECT_COMMAND_READ_BIT, 0 },
+		{ VK_IMAGE_LAYOUT_SHADER_READ_ONLY_OPTIMAL, VK_PIPELINE_STAGE_COMPUTE_SHADER_BIT, VK_ACCESS_SHADER_READ_BIT, 0 },
+		{ VK_IMAGE_LAYOUT_GENERAL, VK_PIPELINE_STAGE_COMPUTE_SHADER_BIT, 0, VK_ACCESS_SHADER_WRITE_BIT },
+		{ VK_IMAGE_LAYOUT_GENERAL, VK_PIPELINE_STAGE_COMPUTE_SHADER_BIT, VK_ACCESS_SHADER_READ_BIT, VK_ACCESS_SHADER_WRITE_BIT },
+	};
+
+	// advances the tracked state by an access and returns true if a barrier is needed before it
+	template<typename SyncState>
+	bool accessResource(SyncState &state, const StateInfo &info, bool isImage, VkPipelineStageFlags &srcStages, VkAccessFlags &srcAccess)
+	{
+		const bool layoutChange = isImage && state.layout != info.layout;
+		const bool write = info.writeAccess != 0;
+
+		if (layoutChange || write)
+		{
+			// layout transitions and writes have to wait for all prior accesses, but only prior writes need to be made available
+			srcStages = state.writeStages | state.readStages;
+			srcAccess = state.writeAccess;
+
+			const bool barrier = layoutChange || srcStages != 0;
+
+			if (write)
+			{
+				state.writeStages = info.stages;
+				state.writeAccess = info.writeAccess;
+			}
+			state.layout = isImage ? info.layout : state.layout;
+			state.readStages = info.readAccess != 0 ? info.stages : 0;
+			state.visibleStages = info.stages;
+			state.visibleAccess = info.readAccess;
+
+			return barrier;
+		}
+
+		// reads in the current layout only need to wait for a prior write that is not yet visible to them
+		const bool barrier = state.writeStages != 0 && ((info.stages & ~state.visibleStages) != 0 || (info.readAccess & ~state.visibleAccess) != 0);
+		if (barrier)
+		{
+			srcStages = state.writeStages;
+			srcAccess = state.writeAccess;
+			state.visibleStages |= info.stages;
+			state.visibleAccess |= info.readAccess;
+		}
+		state.readStages |= info.stages;
+
+		return barrier;
+	}
+}
+
+void sss::vulkan::FrameGraph::importImage(VkImage image, ResourceState state, VkImageAspectFlags aspectMask)
+{
+	const StateInfo &info = s_stateInfos[state];
+
+	ImageRecord &record = getImageRecord(image);
+	record.aspectMask = aspectMask;
+	record.state = { info.layout, 0, 0, info.stages, info.stages, info.readAccess };
+}
+
+void sss::vulkan::FrameGraph::importDiscardedImage(VkImage image, ResourceState state, VkImageAspectFlags aspectMask)
+{
+	const StateInfo &info = s_stateInfos[state];
+
+	// the undefined layout forces a barrier on the first access, which then also drops the contents
+	ImageRecord &record = getImageRecord(image);
+	record.aspectMask = aspectMask;
+	record.state = { VK_IMAGE_LAYOUT_UNDEFINED, info.stages, info.writeAccess, info.readAccess != 0 ? info.stages : 0, 0, 0 };
+}
+
+void sss::vulkan::FrameGraph::beginPass(VkCommandBuffer cmdBuf, std::initializer_list<ImageAccess> images, std::initializer_list<BufferAccess> buffers)
+{
+	VkPipelineStageFlags srcStageMask = 0;
+	VkPipelineStageFlags dstStageMask = 0;
+
+	VkImageMemoryBarrier imageBarriers[16];
+	VkBufferMemoryBarrier bufferBarriers[8];
+	uint32_t imageBarrierCount = 0;
+	uint32_t bufferBarrierCount = 0;
+
+	for (const auto &access : images)
+	{
+		if (access.image == VK_NULL_HANDLE)
+		{
+			continue;
+		}
+
+		const StateInfo &info = s_stateInfos[access.state];
+		ImageRecord &record = getImageRecord(access.image);
+		const VkImageLayout previousLayout = record.state.layout;
+
+		VkPipelineStageFlags srcStages = 0;
+		VkAccessFlags srcAccess = 0;
+		if (accessResource(record.state, info, true, srcStages, srcAccess))
+		{
+			assert(imageBarrierCount < sizeof(imageBarriers) / sizeof(imageBarriers[0]));
+
+			VkImageMemoryBarrier &barrier = imageBarriers[imageBarrierCount++];
+			barrier = { VK_STRUCTURE_TYPE_IMAGE_MEMORY_BARRIER };
+			barrier.srcAccessMask = srcAccess;
+			barrier.dstAccessMask = info.readAccess | info.writeAccess;
+			barrier.oldLayout = access.discard && previousLayout != info.layout ? VK_IMAGE_LAYOUT_UNDEFINED : previousLayout;
+			barrier.newLayout = info.layout;
+			barrier.srcQueueFamilyIndex = VK_QUEUE_FAMILY_IGNORED;
+			barrier.dstQueueFamilyIndex = VK_QUEUE_FAMILY_IGNORED;
+			barrier.image = access.image;
+			barrier.subresourceRange = { record.aspectMask, 0, VK_REMAINING_MIP_LEVELS, 0, VK_REMAINING_ARRAY_LAYERS };
+
+			srcStageMask |= srcStages;
+			dstStageMask |= info.stages;
+		}
+	}
+
+	for (const auto &access : buffers)
+	{
+		if (access.buffer == VK_NULL_HANDLE)
+		{
+			continue;
+		}
+
+		const StateInfo &info = s_stateInfos[access.state];
+		BufferRecord &record = getBufferRecord(access.buffer);
+
+		VkPipelineStageFlags srcStages = 0;
+		VkAccessFlags srcAccess = 0;
+		if (accessResource(record.state, info, false, srcStages, srcAccess))
+		{
+			// a buffer accessed in several ways by the same pass gets a single barrier
+			VkBufferMemoryBarrier *barrier = nullptr;
+			for (uint32_t i = 0; i < bufferBarrierCount; ++i)
+			{
+				if (bufferBarriers[i].buffer == access.buffer)
+				{
+					barrier = &bufferBarriers[i];
+				}
+			}
+
+			if (!barrier)
+			{
+				assert(bufferBarrierCount < sizeof(bufferBarriers) / sizeof(bufferBarriers[0]));
+
+				barrier = &bufferBarriers[bufferBarrierCount++];
+				*barrier = { VK_STRUCTURE_TYPE_BUFFER_MEMORY_BARRIER };
+				barrier->srcQueueFamilyIndex = VK_QUEUE_FAMILY_IGNORED;
+				barrier->dstQueueFamilyIndex = VK_QUEUE_FAMILY_IGNORED;
+				barrier->buffer = access.buffer;
+				barrier->offset = 0;
+				barrier->size = VK_WHOLE_SIZE;
+			}
+
+			barrier->srcAccessMask |= srcAccess;
+			barrier->dstAccessMask |= info.readAccess | info.writeAccess;
+
+			srcStageMask |= srcStages;
+			dstStageMask |= info.stages;
+		}
+	}
+
+	if (imageBarrierCount == 0 && bufferBarrierCount == 0)
+	{
+		return;
+	}
+
+	// only layout transitions of resources not accessed before in this frame have no stages to wait for
+	srcStageMask = srcStageMask != 0 ? srcStageMask : VkPipelineStageFlags(VK_PIPELINE_STAGE_TOP_OF_PIPE_BIT);
+
+	vkCmdPipelineBarrier(cmdBuf, srcStageMask, dstStageMask, 0, 0, nullptr, bufferBarrierCount, bufferBarriers, imageBarrierCount, imageBarriers);
+}
+
+sss::vulkan::FrameGraph::ImageRecord &sss::vulkan::FrameGraph::getImageRecord(VkImage image)
+{
+	for (auto &record : m_images)
+	{
+		if (record.image == image)
+		{
+			return record;
+		}
+	}
+
+	m_images.push_back({ image, VK_IMAGE_ASPECT_COLOR_BIT, { VK_IMAGE_LAYOUT_UNDEFINED, 0, 0, 0, 0, 0 } });
+	return m_images.back();
+}
+
+sss::vulkan::FrameGraph::BufferRecord &sss::vulkan::FrameGraph::getBufferRecord(VkBuffer buffer)
+{
+	for (auto &record : m_buffers)
+	{
+		if (record.buffer == buffer)
+		{
+			return record;
+		}
+	}
+
+	m_buffers.push_back({ buffer, { VK_IMAGE_LAYOUT_UNDEFINED, 0, 0, 0, 0, 0 } });
+	return m_buffers.back();
+}
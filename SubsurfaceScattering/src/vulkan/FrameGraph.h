@@ -0,0 +1,81 @@
+#pragma once
+#include <vector>
+#include <initializer_list>
+#include "volk.h"
+
+namespace sss
+{
+	namespace vulkan
+	{
+		// the ways a pass can access an image or buffer
+		enum ResourceState
+		{
+			RESOURCE_STATE_TRANSFER_READ,
+			RESOURCE_STATE_TRANSFER_WRITE,
+			RESOURCE_STATE_INDIRECT_READ, // buffers only
+			RESOURCE_STATE_COMPUTE_READ, // sampled images and storage buffers
+			RESOURCE_STATE_COMPUTE_WRITE,
+			RESOURCE_STATE_COMPUTE_READ_WRITE,
+		};
+
+		// tracks the state of images and buffers over the passes of a frame. every pass declares the resources it reads and writes
+		// and the graph records the barriers that are actually needed before it: layout transitions, waits on prior writes that
+		// are not yet visible to the pass and waits on prior reads before overwriting. passes are recorded in declaration order.
+		// render passes and queue ownership transfers synchronize themselves and import the resulting state.
+		// a graph only lives for one frame; resources it has not seen yet are treated as undefined
+		class FrameGraph
+		{
+		public:
+			struct ImageAccess
+			{
+				VkImage image; // ignored if VK_NULL_HANDLE
+				ResourceState state;
+				bool discard; // the pass overwrites the whole image, so a layout transition may drop its contents
+			};
+
+			struct BufferAccess
+			{
+				VkBuffer buffer; // ignored if VK_NULL_HANDLE
+				ResourceState state;
+			};
+
+			// sets the state of an image whose prior writes are already visible in that state, without recording a barrier
+			void importImage(VkImage image, ResourceState state, VkImageAspectFlags aspectMask = VK_IMAGE_ASPECT_COLOR_BIT);
+			// sets the state of an image whose contents are not needed anymore, but whose prior accesses in that state, e.g. by the
+			// previous frame on the same queue, may still be executing. the first access of the graph waits for them
+			void importDiscardedImage(VkImage image, ResourceState state, VkImageAspectFlags aspectMask = VK_IMAGE_ASPECT_COLOR_BIT);
+			// declares the resources accessed by the next pass and records the barriers it needs into cmdBuf
+			void beginPass(VkCommandBuffer cmdBuf, std::initializer_list<ImageAccess> images, std::initializer_list<BufferAccess> buffers = {});
+
+		private:
+			struct SyncState
+			{
+				VkImageLayout layout;
+				VkPipelineStageFlags writeStages; // stages of the last write
+				VkAccessFlags writeAccess;
+				VkPipelineStageFlags readStages; // stages that read since the last write or layout transition
+				VkPipelineStageFlags visibleStages; // stages and access types the last write has been made visible to
+				VkAccessFlags visibleAccess;
+			};
+
+			struct ImageRecord
+			{
+				VkImage image;
+				VkImageAspectFlags aspectMask;
+				SyncState state;
+			};
+
+			struct BufferRecord
+			{
+				VkBuffer buffer;
+				SyncState state;
+			};
+
+			std::vector<ImageRecord> m_images;
+			std::vector<BufferRecord> m_buffers;
+
+			ImageRecord &getImageRecord(VkImage image);
+			BufferRecord &getBufferRecord(VkBuffer buffer);
+		};
+	}
+}
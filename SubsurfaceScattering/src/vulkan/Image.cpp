@@ -2,12 +2,12 @@
 #include "VKUtility.h"
 #include "utility/Utility.h"
 
-sss::vulkan::Image::Image(VkPhysicalDevice physicalDevice, VkDevice device, const VkImageCreateInfo &createInfo,
-	VkMemoryPropertyFlags requiredFlags, VkMemoryPropertyFlags preferredFlags, VkImageViewType viewType, const VkImageSubresourceRange &subresourceRange)
-	:m_physicalDevice(physicalDevice),
-	m_device(device)
+sss::vulkan::Image::Image(MemoryAllocator &allocator, const VkImageCreateInfo &createInfo, VkMemoryPropertyFlags requiredFlags, VkMemoryPropertyFlags preferredFlags,
+	VkImageViewType viewType, const VkImageSubresourceRange &subresourceRange, MemoryPool pool)
+	:m_allocator(&allocator),
+	m_device(allocator.getDevice())
 {
-	if (vkutil::createImage(m_physicalDevice, m_device, createInfo, requiredFlags, preferredFlags, m_image, m_memory) != VK_SUCCESS)
+	if (vkutil::createImage(allocator, createInfo, requiredFlags, preferredFlags, pool, m_image, m_allocation) != VK_SUCCESS)
 	{
 		util::fatalExit("Failed to create image!", EXIT_FAILURE);
 	}
@@ -24,11 +24,32 @@ sss::vulkan::Image::Image(VkPhysicalDevice physicalDevice, VkDevice device, cons
 	}
 }
 
+sss::vulkan::Image::Image(VkDevice device, VkImage image, VkFormat format, VkImageViewType viewType, const VkImageSubresourceRange &subresourceRange)
+	:m_allocator(),
+	m_device(device),
+	m_image(image),
+	m_allocation()
+{
+	VkImageViewCreateInfo viewCreateInfo{ VK_STRUCTURE_TYPE_IMAGE_VIEW_CREATE_INFO };
+	viewCreateInfo.viewType = viewType;
+	viewCreateInfo.image = m_image;
+	viewCreateInfo.format = format;
+	viewCreateInfo.subresourceRange = subresourceRange;
+
+	if (vkCreateImageView(m_device, &viewCreateInfo, nullptr, &m_view) != VK_SUCCESS)
+	{
+		util::fatalExit("Failed to create image view!", EXIT_FAILURE);
+	}
+}
+
 sss::vulkan::Image::~Image()
 {
 	vkDestroyImageView(m_device, m_view, nullptr);
 	vkDestroyImage(m_device, m_image, nullptr);
-	vkFreeMemory(m_device, m_memory, nullptr);
+	if (m_allocator)
+	{
+		m_allocator->free(m_allocation);
+	}
 }
 
 const VkImage &sss::vulkan::Image::getImage() const
@@ -43,5 +64,5 @@ const VkImageView &sss::vulkan::Image::getView() const
 
 const VkDeviceMemory &sss::vulkan::Image::getMemory() const
 {
-	return m_memory;
+	return m_allocation.memory;
 }
@@ -1,5 +1,6 @@
 #pragma once
 #include "volk.h"
+#include "MemoryAllocator.h"
 
 namespace sss
 {
@@ -8,8 +9,10 @@ namespace sss
 		class Image
 		{
 		public:
-			explicit Image(VkPhysicalDevice physicalDevice, VkDevice device, const VkImageCreateInfo &createInfo, 
-				VkMemoryPropertyFlags requiredFlags, VkMemoryPropertyFlags preferredFlags, VkImageViewType viewType, const VkImageSubresourceRange &subresourceRange);
+			explicit Image(MemoryAllocator &allocator, const VkImageCreateInfo &createInfo, VkMemoryPropertyFlags requiredFlags, VkMemoryPropertyFlags preferredFlags,
+				VkImageViewType viewType, const VkImageSubresourceRange &subresourceRange, MemoryPool pool = MEMORY_POOL_DEFAULT);
+			// takes ownership of an image bound to memory owned by someone else, see vkutil::createAliasedImages()
+			explicit Image(VkDevice device, VkImage image, VkFormat format, VkImageViewType viewType, const VkImageSubresourceRange &subresourceRange);
 			Image(const Image &) = delete;
 			Image(const Image &&) = delete;
 			Image &operator= (const Image &) = delete;
@@ -20,11 +23,11 @@ namespace sss
 			const VkDeviceMemory &getMemory() const;
 
 		private:
-			VkPhysicalDevice m_physicalDevice;
+			MemoryAllocator *m_allocator; // nullptr if the memory is owned by someone else
 			VkDevice m_device;
 			VkImage m_image;
 			VkImageView m_view;
-			VkDeviceMemory m_memory;
+			MemoryAllocator::Allocation m_allocation;
 		};
 	}
 }
\ No newline at end of file
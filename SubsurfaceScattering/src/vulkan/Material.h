@@ -17,6 +17,7 @@ namespace sss
 			uint32_t specularTexture;
 			uint32_t cavityTexture;
 			uint32_t detailNormalTexture;
+			uint32_t sssProfileIndex; // index into the sss profile table; only used by SSS materials
 		};
 	}
 }
\ No newline at end of file
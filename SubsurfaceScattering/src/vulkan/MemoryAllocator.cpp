@@ -0,0 +1,305 @@
+#include "MemoryAllocator.h"
+#include "VKUtility.h"
+#include "utility/TLSFAllocator.h"
+#include <algorithm>
+#include <cassert>
+
+struct sss::vulkan::MemoryAllocator::Block
+{
+	VkDeviceMemory memory;
+	VkDeviceSize size;
+	uint8_t *mappedPtr;
+	uint32_t memoryTypeIndex;
+	bool optimalImage;
+	MemoryPool pool;
+	bool dedicated; // the block holds a single allocation and is freed with it
+	std::unique_ptr<util::TLSFAllocator> tlsf; // MEMORY_POOL_DEFAULT only
+	VkDeviceSize linearOffset; // MEMORY_POOL_LINEAR only
+	uint32_t allocationCount;
+	VkDeviceSize usedSize;
+};
+
+sss::vulkan::MemoryAllocator::MemoryAllocator(VkPhysicalDevice physicalDevice, VkDevice device)
+	:m_physicalDevice(physicalDevice),
+	m_device(device),
+	m_memoryObjectCount(),
+	m_deviceMemoryHostVisible()
+{
+	vkGetPhysicalDeviceMemoryProperties(m_physicalDevice, &m_memoryProperties);
+
+	VkPhysicalDeviceProperties properties;
+	vkGetPhysicalDeviceProperties(m_physicalDevice, &properties);
+	m_maxMemoryAllocationCount = properties.limits.maxMemoryAllocationCount;
+
+	// without resizable bar only a small extra heap of discrete gpus is host visible, so look at the largest heap
+	uint32_t largestDeviceLocalHeap = ~0u;
+	for (uint32_t i = 0; i < m_memoryProperties.memoryHeapCount; ++i)
+	{
+		const VkMemoryHeap &heap = m_memoryProperties.memoryHeaps[i];
+		if ((heap.flags & VK_MEMORY_HEAP_DEVICE_LOCAL_BIT) != 0 && (largestDeviceLocalHeap == ~0u || heap.size > m_memoryProperties.memoryHeaps[largestDeviceLocalHeap].size))
+		{
+			largestDeviceLocalHeap = i;
+		}
+	}
+
+	const VkMemoryPropertyFlags hostVisibleDeviceLocalFlags = VK_MEMORY_PROPERTY_DEVICE_LOCAL_BIT | VK_MEMORY_PROPERTY_HOST_VISIBLE_BIT | VK_MEMORY_PROPERTY_HOST_COHERENT_BIT;
+	for (uint32_t i = 0; i < m_memoryProperties.memoryTypeCount; ++i)
+	{
+		const VkMemoryType &memoryType = m_memoryProperties.memoryTypes[i];
+		if (memoryType.heapIndex == largestDeviceLocalHeap && (memoryType.propertyFlags & hostVisibleDeviceLocalFlags) == hostVisibleDeviceLocalFlags)
+		{
+			m_deviceMemoryHostVisible = true;
+		}
+	}
+}
+
+sss::vulkan::MemoryAllocator::~MemoryAllocator()
+{
+	for (auto &memoryTypeBlocks : m_blocks)
+	{
+		for (auto &kindBlocks : memoryTypeBlocks)
+		{
+			for (auto &blocks : kindBlocks)
+			{
+				for (auto &block : blocks)
+				{
+					assert(block->allocationCount == 0);
+					vkFreeMemory(m_device, block->memory, nullptr);
+				}
+			}
+		}
+	}
+}
+
+VkResult sss::vulkan::MemoryAllocator::allocate(const VkMemoryRequirements &memoryRequirements, VkMemoryPropertyFlags requiredFlags, VkMemoryPropertyFlags preferredFlags,
+	bool optimalImage, MemoryPool pool, Allocation &allocation)
+{
+	uint32_t memoryTypeIndex;
+	if (vkutil::findMemoryTypeIndex(m_memoryProperties, memoryRequirements.memoryTypeBits, requiredFlags, preferredFlags, memoryTypeIndex) != VK_SUCCESS)
+	{
+		return VK_ERROR_FEATURE_NOT_PRESENT;
+	}
+
+	std::lock_guard<std::mutex> lock(m_mutex);
+
+	const VkDeviceSize blockSize = getPreferredBlockSize(memoryTypeIndex);
+
+	Block *block = nullptr;
+	VkDeviceSize offset = 0;
+	uint32_t handle = 0;
+
+	// large resources in the default pool get a block of their own, which is freed together with them
+	if (pool == MEMORY_POOL_DEFAULT && memoryRequirements.size > blockSize / 2)
+	{
+		block = createBlock(memoryTypeIndex, optimalImage, pool, memoryRequirements.size, true);
+	}
+	else
+	{
+		for (auto &b : m_blocks[memoryTypeIndex][optimalImage][pool])
+		{
+			if (!b->dedicated && allocateFromBlock(*b, memoryRequirements, offset, handle))
+			{
+				block = b.get();
+				break;
+			}
+		}
+
+		// the linear pool grows its blocks to fit large resources instead
+		if (!block)
+		{
+			block = createBlock(memoryTypeIndex, optimalImage, pool, std::max(blockSize, memoryRequirements.size), false);
+
+			if (block && !allocateFromBlock(*block, memoryRequirements, offset, handle))
+			{
+				destroyBlock(block);
+				block = nullptr;
+			}
+		}
+	}
+
+	if (!block)
+	{
+		return VK_ERROR_OUT_OF_DEVICE_MEMORY;
+	}
+
+	++block->allocationCount;
+	block->usedSize += memoryRequirements.size;
+
+	allocation.memory = block->memory;
+	allocation.offset = offset;
+	allocation.size = memoryRequirements.size;
+	allocation.mappedPtr = block->mappedPtr ? block->mappedPtr + offset : nullptr;
+	allocation.block = block;
+	allocation.handle = handle;
+
+	return VK_SUCCESS;
+}
+
+void sss::vulkan::MemoryAllocator::free(const Allocation &allocation)
+{
+	std::lock_guard<std::mutex> lock(m_mutex);
+
+	Block *block = allocation.block;
+	assert(block && block->allocationCount > 0);
+
+	--block->allocationCount;
+	block->usedSize -= allocation.size;
+
+	if (block->dedicated)
+	{
+		destroyBlock(block);
+		return;
+	}
+
+	if (block->pool == MEMORY_POOL_DEFAULT)
+	{
+		block->tlsf->free(allocation.handle);
+	}
+
+	if (block->allocationCount == 0)
+	{
+		block->linearOffset = 0;
+
+		// keep one empty block per pool so that freeing and recreating resources does not thrash memory objects
+		const auto &blocks = m_blocks[block->memoryTypeIndex][block->optimalImage][block->pool];
+		const bool otherBlockExists = std::any_of(blocks.begin(), blocks.end(), [block](const auto &b) { return b.get() != block && !b->dedicated; });
+
+		if (otherBlockExists)
+		{
+			destroyBlock(block);
+		}
+	}
+}
+
+VkDevice sss::vulkan::MemoryAllocator::getDevice() const
+{
+	return m_device;
+}
+
+bool sss::vulkan::MemoryAllocator::isDeviceMemoryHostVisible() const
+{
+	return m_deviceMemoryHostVisible;
+}
+
+std::vector<sss::vulkan::MemoryAllocator::Statistics> sss::vulkan::MemoryAllocator::getStatistics() const
+{
+	std::vector<Statistics> statistics(m_memoryProperties.memoryHeapCount);
+
+	for (uint32_t i = 0; i < m_memoryProperties.memoryHeapCount; ++i)
+	{
+		statistics[i] = {};
+		statistics[i].heapFlags = m_memoryProperties.memoryHeaps[i].flags;
+		statistics[i].heapSize = m_memoryProperties.memoryHeaps[i].size;
+	}
+
+	std::lock_guard<std::mutex> lock(m_mutex);
+
+	for (uint32_t memoryTypeIndex = 0; memoryTypeIndex < m_memoryProperties.memoryTypeCount; ++memoryTypeIndex)
+	{
+		Statistics &heapStatistics = statistics[m_memoryProperties.memoryTypes[memoryTypeIndex].heapIndex];
+
+		for (const auto &kindBlocks : m_blocks[memoryTypeIndex])
+		{
+			for (const auto &blocks : kindBlocks)
+			{
+				for (const auto &block : blocks)
+				{
+					++heapStatistics.memoryObjectCount;
+					heapStatistics.allocationCount += block->allocationCount;
+					heapStatistics.allocatedSize += block->size;
+					heapStatistics.usedSize += block->usedSize;
+				}
+			}
+		}
+	}
+
+	return statistics;
+}
+
+bool sss::vulkan::MemoryAllocator::allocateFromBlock(Block &block, const VkMemoryRequirements &memoryRequirements, VkDeviceSize &offset, uint32_t &handle)
+{
+	if (block.pool == MEMORY_POOL_LINEAR)
+	{
+		const VkDeviceSize alignedOffset = (block.linearOffset + memoryRequirements.alignment - 1) / memoryRequirements.alignment * memoryRequirements.alignment;
+
+		if (alignedOffset + memoryRequirements.size > block.size)
+		{
+			return false;
+		}
+
+		block.linearOffset = alignedOffset + memoryRequirements.size;
+		offset = alignedOffset;
+		handle = 0;
+		return true;
+	}
+
+	handle = block.tlsf->alloc(memoryRequirements.size, memoryRequirements.alignment, offset);
+	return handle != util::TLSFAllocator::INVALID_HANDLE;
+}
+
+VkDeviceSize sss::vulkan::MemoryAllocator::getPreferredBlockSize(uint32_t memoryTypeIndex) const
+{
+	// small heaps, like the host visible part of device local memory without resizable bar, get proportionally smaller blocks
+	const VkDeviceSize heapSize = m_memoryProperties.memoryHeaps[m_memoryProperties.memoryTypes[memoryTypeIndex].heapIndex].size;
+	const VkDeviceSize defaultBlockSize = 64 * 1024 * 1024;
+
+	return std::min(defaultBlockSize, heapSize / 8);
+}
+
+sss::vulkan::MemoryAllocator::Block *sss::vulkan::MemoryAllocator::createBlock(uint32_t memoryTypeIndex, bool optimalImage, MemoryPool pool, VkDeviceSize size, bool dedicated)
+{
+	if (m_memoryObjectCount >= m_maxMemoryAllocationCount)
+	{
+		return nullptr;
+	}
+
+	VkMemoryAllocateInfo memoryAllocateInfo{ VK_STRUCTURE_TYPE_MEMORY_ALLOCATE_INFO };
+	memoryAllocateInfo.allocationSize = size;
+	memoryAllocateInfo.memoryTypeIndex = memoryTypeIndex;
+
+	VkDeviceMemory memory;
+	if (vkAllocateMemory(m_device, &memoryAllocateInfo, nullptr, &memory) != VK_SUCCESS)
+	{
+		return nullptr;
+	}
+
+	uint8_t *mappedPtr = nullptr;
+	if ((m_memoryProperties.memoryTypes[memoryTypeIndex].propertyFlags & VK_MEMORY_PROPERTY_HOST_VISIBLE_BIT) != 0)
+	{
+		if (vkMapMemory(m_device, memory, 0, VK_WHOLE_SIZE, 0, (void **)&mappedPtr) != VK_SUCCESS)
+		{
+			vkFreeMemory(m_device, memory, nullptr);
+			return nullptr;
+		}
+	}
+
+	auto block = std::make_unique<Block>();
+	block->memory = memory;
+	block->size = size;
+	block->mappedPtr = mappedPtr;
+	block->memoryTypeIndex = memoryTypeIndex;
+	block->optimalImage = optimalImage;
+	block->pool = pool;
+	block->dedicated = dedicated;
+	block->tlsf = !dedicated && pool == MEMORY_POOL_DEFAULT ? std::make_unique<util::TLSFAllocator>(size) : nullptr;
+	block->linearOffset = 0;
+	block->allocationCount = 0;
+	block->usedSize = 0;
+
+	Block *result = block.get();
+	m_blocks[memoryTypeIndex][optimalImage][pool].push_back(std::move(block));
+	++m_memoryObjectCount;
+
+	return result;
+}
+
+void sss::vulkan::MemoryAllocator::destroyBlock(Block *block)
+{
+	auto &blocks = m_blocks[block->memoryTypeIndex][block->optimalImage][block->pool];
+	auto it = std::find_if(blocks.begin(), blocks.end(), [block](const auto &b) { return b.get() == block; });
+	assert(it != blocks.end());
+
+	vkFreeMemory(m_device, block->memory, nullptr);
+	blocks.erase(it);
+	--m_memoryObjectCount;
+}
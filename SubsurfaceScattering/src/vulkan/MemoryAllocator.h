@@ -0,0 +1,82 @@
+#pragma once
+#include "volk.h"
+#include <vector>
+#include <memory>
+#include <mutex>
+
+namespace sss
+{
+	namespace vulkan
+	{
+		enum MemoryPool
+		{
+			// long lived resources, sub-allocated with a TLSF allocator from large blocks per memory type
+			MEMORY_POOL_DEFAULT,
+			// bump allocated from blocks per memory type. a block is only reused once all of its allocations are freed, which makes
+			// this a fit for resources created and destroyed together, like the per frame render targets that are recreated on resize
+			MEMORY_POOL_LINEAR,
+			MEMORY_POOL_COUNT
+		};
+
+		// sub-allocates device memory so that resources do not each need their own vkAllocateMemory call. host visible blocks
+		// stay mapped for their whole lifetime. buffers and optimal tiling images never share a block, which makes
+		// bufferImageGranularity a non-issue. thread safe
+		class MemoryAllocator
+		{
+			struct Block;
+
+		public:
+			struct Allocation
+			{
+				VkDeviceMemory memory;
+				VkDeviceSize offset;
+				VkDeviceSize size;
+				uint8_t *mappedPtr; // nullptr if the memory is not host visible
+				Block *block;
+				uint32_t handle;
+			};
+
+			struct Statistics
+			{
+				VkMemoryHeapFlags heapFlags;
+				VkDeviceSize heapSize;
+				uint32_t memoryObjectCount; // device memory allocations, including dedicated ones
+				uint32_t allocationCount;
+				VkDeviceSize allocatedSize; // total size of all memory objects
+				VkDeviceSize usedSize;
+			};
+
+			explicit MemoryAllocator(VkPhysicalDevice physicalDevice, VkDevice device);
+			MemoryAllocator(const MemoryAllocator &) = delete;
+			MemoryAllocator(const MemoryAllocator &&) = delete;
+			MemoryAllocator &operator= (const MemoryAllocator &) = delete;
+			MemoryAllocator &operator= (const MemoryAllocator &&) = delete;
+			~MemoryAllocator();
+			// optimalImage must be true for images with VK_IMAGE_TILING_OPTIMAL and false for buffers and linear images
+			VkResult allocate(const VkMemoryRequirements &memoryRequirements, VkMemoryPropertyFlags requiredFlags, VkMemoryPropertyFlags preferredFlags,
+				bool optimalImage, MemoryPool pool, Allocation &allocation);
+			void free(const Allocation &allocation);
+			VkDevice getDevice() const;
+			// true on uma and resizable bar systems, where the largest device local heap can be mapped by the cpu
+			bool isDeviceMemoryHostVisible() const;
+			// one entry per memory heap
+			std::vector<Statistics> getStatistics() const;
+
+		private:
+			VkPhysicalDevice m_physicalDevice;
+			VkDevice m_device;
+			VkPhysicalDeviceMemoryProperties m_memoryProperties;
+			uint32_t m_maxMemoryAllocationCount;
+			uint32_t m_memoryObjectCount;
+			bool m_deviceMemoryHostVisible;
+			mutable std::mutex m_mutex;
+			// per memory type, resource kind (buffers and linear images, optimal images) and pool
+			std::vector<std::unique_ptr<Block>> m_blocks[VK_MAX_MEMORY_TYPES][2][MEMORY_POOL_COUNT];
+
+			static bool allocateFromBlock(Block &block, const VkMemoryRequirements &memoryRequirements, VkDeviceSize &offset, uint32_t &handle);
+			VkDeviceSize getPreferredBlockSize(uint32_t memoryTypeIndex) const;
+			Block *createBlock(uint32_t memoryTypeIndex, bool optimalImage, MemoryPool pool, VkDeviceSize size, bool dedicated);
+			void destroyBlock(Block *block);
+		};
+	}
+}
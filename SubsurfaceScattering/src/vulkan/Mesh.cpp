@@ -1,112 +1,145 @@
 #include "Mesh.h"
-#include <fstream>
+#include <cstring>
 #include "utility/Utility.h"
+#include "utility/AssetFile.h"
 #include "VKUtility.h"
+#include "UploadManager.h"
 
-
-std::shared_ptr<sss::vulkan::Mesh> sss::vulkan::Mesh::load(VkPhysicalDevice physicalDevice, VkDevice device, VkQueue queue, VkCommandPool cmdPool, const char *path)
+namespace
 {
-	const std::vector<char> meshData = util::readBinaryFile(path);
-	const uint8_t *meshDataPtr = reinterpret_cast<const uint8_t *>(meshData.data());
-
-	const uint32_t vertexCount = ((uint32_t *)meshDataPtr)[0];
-	const uint32_t indexCount = ((uint32_t *)meshDataPtr)[1];
-	const uint32_t positionsSize = vertexCount * sizeof(float) * 3;
-	const uint32_t normalsSize = vertexCount * sizeof(float) * 3;
-	const uint32_t texCoordsSize = vertexCount * sizeof(float) * 2;
-
-	auto mesh = std::make_shared<Mesh>();
-	mesh->m_device = device;
-	mesh->m_indexCount = indexCount;
-	mesh->m_vertexCount = vertexCount;
+	// .mesh version 4 file layout: MeshFileHeader, MeshFileSubmesh[submeshCount], positions, normals, texcoords, tangents,
+	// indices. see Mesh.h for the vertex formats
+	const uint32_t MESH_FILE_MAGIC = 0x4D535353; // "SSSM"
+	const uint32_t MESH_FILE_VERSION = 4;
 
-	const VkDeviceSize vertexBufferSize = positionsSize + normalsSize + texCoordsSize;
-	const VkDeviceSize indexBufferSize = indexCount * sizeof(uint32_t);
+	struct MeshFileHeader
+	{
+		uint32_t magic;
+		uint32_t version;
+		uint32_t vertexCount;
+		uint32_t indexCount;
+		uint32_t indexSize; // 2 or 4 bytes
+		float positionScale[3];
+		float positionBias[3];
+		uint32_t submeshCount;
+	};
+
+	struct MeshFileSubmesh
+	{
+		char materialName[64]; // null terminated
+		uint32_t firstIndex;
+		uint32_t indexCount;
+	};
 
-	// vertex buffer
+	// returns true if the buffer memory is host visible and can be written directly
+	bool createMeshBuffer(sss::vulkan::MemoryAllocator &allocator, VkDeviceSize size, VkBufferUsageFlags usage, VkBuffer &buffer, sss::vulkan::MemoryAllocator::Allocation &allocation)
 	{
+		using namespace sss::vulkan;
+
 		VkBufferCreateInfo createInfo{ VK_STRUCTURE_TYPE_BUFFER_CREATE_INFO };
-		createInfo.size = vertexBufferSize;
-		createInfo.usage = VK_BUFFER_USAGE_TRANSFER_DST_BIT | VK_BUFFER_USAGE_VERTEX_BUFFER_BIT;
+		createInfo.size = size;
+		createInfo.usage = VK_BUFFER_USAGE_TRANSFER_DST_BIT | usage;
 		createInfo.sharingMode = VK_SHARING_MODE_EXCLUSIVE;
 
-		if (vkutil::createBuffer(physicalDevice, device, createInfo, VK_MEMORY_PROPERTY_DEVICE_LOCAL_BIT, 0, mesh->m_vertexBuffer, mesh->m_vertexBufferMemory) != VK_SUCCESS)
+		// on uma and resizable bar systems the cpu writes the buffer itself, which saves the staging copy and the transfer
+		if (allocator.isDeviceMemoryHostVisible()
+			&& vkutil::createBuffer(allocator, createInfo, VK_MEMORY_PROPERTY_DEVICE_LOCAL_BIT | VK_MEMORY_PROPERTY_HOST_VISIBLE_BIT | VK_MEMORY_PROPERTY_HOST_COHERENT_BIT, 0, MEMORY_POOL_DEFAULT, buffer, allocation) == VK_SUCCESS)
 		{
-			util::fatalExit("Failed to create vertex buffer!", EXIT_FAILURE);
+			return true;
 		}
-	}
-
-	// index buffer
-	{
-		VkBufferCreateInfo createInfo{ VK_STRUCTURE_TYPE_BUFFER_CREATE_INFO };
-		createInfo.size = indexBufferSize;
-		createInfo.usage = VK_BUFFER_USAGE_TRANSFER_DST_BIT | VK_BUFFER_USAGE_INDEX_BUFFER_BIT;
-		createInfo.sharingMode = VK_SHARING_MODE_EXCLUSIVE;
 
-		if (vkutil::createBuffer(physicalDevice, device, createInfo, VK_MEMORY_PROPERTY_DEVICE_LOCAL_BIT, 0, mesh->m_indexBuffer, mesh->m_indexBufferMemory) != VK_SUCCESS)
+		if (vkutil::createBuffer(allocator, createInfo, VK_MEMORY_PROPERTY_DEVICE_LOCAL_BIT, 0, MEMORY_POOL_DEFAULT, buffer, allocation) != VK_SUCCESS)
 		{
-			util::fatalExit("Failed to create index buffer!", EXIT_FAILURE);
+			sss::util::fatalExit("Failed to create mesh buffer!", EXIT_FAILURE);
 		}
+
+		return false;
 	}
+}
 
-	// staging buffer
-	VkBuffer stagingBuffer;
-	VkDeviceMemory stagingBufferMemory;
-	{
-		VkBufferCreateInfo createInfo{ VK_STRUCTURE_TYPE_BUFFER_CREATE_INFO };
-		createInfo.size = vertexBufferSize + indexBufferSize;
-		createInfo.usage = VK_BUFFER_USAGE_TRANSFER_SRC_BIT;
-		createInfo.sharingMode = VK_SHARING_MODE_EXCLUSIVE;
+std::shared_ptr<sss::vulkan::Mesh> sss::vulkan::Mesh::load(MemoryAllocator &allocator, VkDevice device, UploadManager &uploadManager, const char *path)
+{
+	// the file is mapped instead of read, so its contents are copied only once: into the staging ring or the buffers
+	const util::AssetFile file(path);
+	const uint8_t *meshDataPtr = file.getData();
 
-		if (vkutil::createBuffer(physicalDevice, device, createInfo, VK_MEMORY_PROPERTY_HOST_VISIBLE_BIT | VK_MEMORY_PROPERTY_HOST_COHERENT_BIT, 0, stagingBuffer, stagingBufferMemory) != VK_SUCCESS)
-		{
-			util::fatalExit("Failed to create staging buffer!", EXIT_FAILURE);
-		}
+	MeshFileHeader header;
+
+	if (file.getSize() < sizeof(header))
+	{
+		util::fatalExit(("Invalid mesh file: " + std::string(path)).c_str(), EXIT_FAILURE);
 	}
 
-	// write data to staging buffer
+	memcpy(&header, meshDataPtr, sizeof(header));
+
+	if (header.magic != MESH_FILE_MAGIC || header.version != MESH_FILE_VERSION)
 	{
-		uint8_t *ptr;
-		if (vkMapMemory(device, stagingBufferMemory, 0, vertexBufferSize + indexBufferSize, 0, (void **)&ptr) != VK_SUCCESS)
-		{
-			util::fatalExit("Failed to map staging buffer memory!", EXIT_FAILURE);
-		}
+		util::fatalExit(("Unsupported mesh file version, convert it again with WavefrontObjToBinaryConverter: " + std::string(path)).c_str(), EXIT_FAILURE);
+	}
+
+	const uint32_t vertexCount = header.vertexCount;
+	const uint32_t indexCount = header.indexCount;
 
-		meshDataPtr += 8;
-		memcpy(ptr, meshDataPtr, positionsSize);
-		meshDataPtr += positionsSize;
-		ptr += positionsSize;
-		memcpy(ptr, meshDataPtr, normalsSize);
-		meshDataPtr += normalsSize;
-		ptr += normalsSize;
-		memcpy(ptr, meshDataPtr, texCoordsSize);
-		meshDataPtr += texCoordsSize;
-		ptr += texCoordsSize;
-		memcpy(ptr, meshDataPtr, indexBufferSize);
-
-		vkUnmapMemory(device, stagingBufferMemory);
+	const VkDeviceSize vertexBufferSize = uint64_t(vertexCount) * (POSITION_SIZE + NORMAL_SIZE + TEXCOORD_SIZE + TANGENT_SIZE);
+	const VkDeviceSize indexBufferSize = uint64_t(indexCount) * header.indexSize;
+	const uint64_t submeshTableSize = uint64_t(header.submeshCount) * sizeof(MeshFileSubmesh);
+
+	if (vertexCount == 0
+		|| indexCount == 0
+		|| (header.indexSize != sizeof(uint16_t) && header.indexSize != sizeof(uint32_t))
+		|| (header.indexSize == sizeof(uint16_t) && vertexCount > 65536)
+		|| header.submeshCount == 0
+		|| sizeof(header) + submeshTableSize + vertexBufferSize + indexBufferSize != file.getSize())
+	{
+		util::fatalExit(("Invalid mesh file: " + std::string(path)).c_str(), EXIT_FAILURE);
 	}
 
-	// copy from staging buffer to vertex and index buffer
+	auto mesh = std::make_shared<Mesh>();
+	mesh->m_allocator = &allocator;
+	mesh->m_device = device;
+	mesh->m_indexCount = indexCount;
+	mesh->m_vertexCount = vertexCount;
+	mesh->m_indexType = header.indexSize == sizeof(uint16_t) ? VK_INDEX_TYPE_UINT16 : VK_INDEX_TYPE_UINT32;
+	mesh->m_positionScale = glm::vec3(header.positionScale[0], header.positionScale[1], header.positionScale[2]);
+	mesh->m_positionBias = glm::vec3(header.positionBias[0], header.positionBias[1], header.positionBias[2]);
+
+	for (uint32_t i = 0; i < header.submeshCount; ++i)
 	{
-		VkBufferCopy bufferCopies[] =
-		{
-			{ 0, 0, vertexBufferSize },
-			{ vertexBufferSize, 0, indexBufferSize }
-		};
+		MeshFileSubmesh fileSubmesh;
+		memcpy(&fileSubmesh, meshDataPtr + sizeof(header) + i * sizeof(MeshFileSubmesh), sizeof(fileSubmesh));
 
-		VkCommandBuffer copyCmd = vkutil::beginSingleTimeCommands(device, cmdPool);
+		if (uint64_t(fileSubmesh.firstIndex) + fileSubmesh.indexCount > indexCount)
 		{
-			vkCmdCopyBuffer(copyCmd, stagingBuffer, mesh->m_vertexBuffer, 1, bufferCopies);
-			vkCmdCopyBuffer(copyCmd, stagingBuffer, mesh->m_indexBuffer, 1, bufferCopies + 1);
+			util::fatalExit(("Invalid mesh file: " + std::string(path)).c_str(), EXIT_FAILURE);
 		}
-		vkutil::endSingleTimeCommands(device, queue, cmdPool, copyCmd);
+
+		fileSubmesh.materialName[sizeof(fileSubmesh.materialName) - 1] = '\0';
+		mesh->m_submeshes.push_back({ fileSubmesh.materialName, fileSubmesh.firstIndex, fileSubmesh.indexCount });
+	}
+
+	const bool vertexBufferMapped = createMeshBuffer(allocator, vertexBufferSize, VK_BUFFER_USAGE_VERTEX_BUFFER_BIT, mesh->m_vertexBuffer, mesh->m_vertexBufferAllocation);
+	const bool indexBufferMapped = createMeshBuffer(allocator, indexBufferSize, VK_BUFFER_USAGE_INDEX_BUFFER_BIT, mesh->m_indexBuffer, mesh->m_indexBufferAllocation);
+
+	// positions, normals, texcoords and tangents are stored back to back, just like in the vertex buffer
+	const uint8_t *vertexData = meshDataPtr + sizeof(header) + submeshTableSize;
+	const uint8_t *indexData = vertexData + vertexBufferSize;
+
+	if (vertexBufferMapped)
+	{
+		memcpy(mesh->m_vertexBufferAllocation.mappedPtr, vertexData, vertexBufferSize);
+	}
+	else
+	{
+		uploadManager.uploadBuffer(mesh->m_vertexBuffer, 0, vertexData, vertexBufferSize);
 	}
 
-	// destroy staging buffer
+	if (indexBufferMapped)
+	{
+		memcpy(mesh->m_indexBufferAllocation.mappedPtr, indexData, indexBufferSize);
+	}
+	else
 	{
-		vkDestroyBuffer(device, stagingBuffer, nullptr);
-		vkFreeMemory(device, stagingBufferMemory, nullptr);
+		uploadManager.uploadBuffer(mesh->m_indexBuffer, 0, indexData, indexBufferSize);
 	}
 
 	return mesh;
@@ -116,8 +149,8 @@ sss::vulkan::Mesh::~Mesh()
 {
 	vkDestroyBuffer(m_device, m_vertexBuffer, nullptr);
 	vkDestroyBuffer(m_device, m_indexBuffer, nullptr);
-	vkFreeMemory(m_device, m_vertexBufferMemory, nullptr);
-	vkFreeMemory(m_device, m_indexBufferMemory, nullptr);
+	m_allocator->free(m_vertexBufferAllocation);
+	m_allocator->free(m_indexBufferAllocation);
 }
 
 uint32_t sss::vulkan::Mesh::getVertexCount() const
@@ -138,4 +171,32 @@ VkBuffer sss::vulkan::Mesh::getVertexBuffer() const
 VkBuffer sss::vulkan::Mesh::getIndexBuffer() const
 {
 	return m_indexBuffer;
+}
+
+VkIndexType sss::vulkan::Mesh::getIndexType() const
+{
+	return m_indexType;
+}
+
+void sss::vulkan::Mesh::getVertexBufferOffsets(VkDeviceSize *offsets) const
+{
+	offsets[0] = 0;
+	offsets[1] = VkDeviceSize(m_vertexCount) * POSITION_SIZE;
+	offsets[2] = VkDeviceSize(m_vertexCount) * (POSITION_SIZE + NORMAL_SIZE);
+	offsets[3] = VkDeviceSize(m_vertexCount) * (POSITION_SIZE + NORMAL_SIZE + TEXCOORD_SIZE);
+}
+
+glm::vec3 sss::vulkan::Mesh::getPositionScale() const
+{
+	return m_positionScale;
+}
+
+glm::vec3 sss::vulkan::Mesh::getPositionBias() const
+{
+	return m_positionBias;
+}
+
+const std::vector<sss::vulkan::Mesh::Submesh> &sss::vulkan::Mesh::getSubmeshes() const
+{
+	return m_submeshes;
 }
\ No newline at end of file
@@ -1,15 +1,40 @@
 #pragma once
 #include "volk.h"
 #include <memory>
+#include <vector>
+#include <string>
+#include "MemoryAllocator.h"
+#include <glm/vec3.hpp>
 
 namespace sss
 {
 	namespace vulkan
 	{
+		class UploadManager;
+
 		class Mesh
 		{
 		public:
-			static std::shared_ptr<Mesh> load(VkPhysicalDevice physicalDevice, VkDevice device, VkQueue queue, VkCommandPool cmdPool, const char *path);
+			// a range of the index buffer that is drawn with one material
+			struct Submesh
+			{
+				std::string materialName;
+				uint32_t firstIndex;
+				uint32_t indexCount;
+			};
+
+			// vertex attribute sizes. the vertex buffer holds one stream per attribute, in this order
+			enum : uint32_t
+			{
+				POSITION_SIZE = 8, // VK_FORMAT_R16G16B16A16_UNORM, dequantized with the position scale and bias
+				NORMAL_SIZE = 4, // VK_FORMAT_R16G16_SNORM, octahedral encoded
+				TEXCOORD_SIZE = 4, // VK_FORMAT_R16G16_SFLOAT
+				TANGENT_SIZE = 4, // VK_FORMAT_R8G8B8A8_SNORM, xyz is the tangent and w the bitangent sign
+				VERTEX_STREAM_COUNT = 4,
+			};
+
+			// the mesh is usable once the upload manager is flushed
+			static std::shared_ptr<Mesh> load(MemoryAllocator &allocator, VkDevice device, UploadManager &uploadManager, const char *path);
 			Mesh() = default;
 			Mesh(const Mesh &) = delete;
 			Mesh(const Mesh &&) = delete;
@@ -20,15 +45,27 @@ namespace sss
 			uint32_t getIndexCount() const;
 			VkBuffer getVertexBuffer() const;
 			VkBuffer getIndexBuffer() const;
+			VkIndexType getIndexType() const;
+			// offsets of the position, normal, texcoord and tangent streams
+			void getVertexBufferOffsets(VkDeviceSize *offsets) const;
+			// object space position = quantized position * scale + bias
+			glm::vec3 getPositionScale() const;
+			glm::vec3 getPositionBias() const;
+			const std::vector<Submesh> &getSubmeshes() const;
 
 		private:
+			MemoryAllocator *m_allocator;
 			VkDevice m_device;
 			uint32_t m_vertexCount;
 			uint32_t m_indexCount;
+			VkIndexType m_indexType;
+			glm::vec3 m_positionScale;
+			glm::vec3 m_positionBias;
+			std::vector<Submesh> m_submeshes;
 			VkBuffer m_vertexBuffer;
 			VkBuffer m_indexBuffer;
-			VkDeviceMemory m_vertexBufferMemory;
-			VkDeviceMemory m_indexBufferMemory;
+			MemoryAllocator::Allocation m_vertexBufferAllocation;
+			MemoryAllocator::Allocation m_indexBufferAllocation;
 		};
 	}
 }
\ No newline at end of file
@@ -0,0 +1,167 @@
+#include "PipelineCache.h"
+#include "utility/Utility.h"
+#include <fstream>
+#include <vector>
+#include <string>
+#include <cstdio>
+#include <cstring>
+
+namespace
+{
+	const uint32_t FILE_MAGIC = 0x43505353; // "SSPC"
+	const uint32_t FILE_VERSION = 1;
+
+	// precedes the cache data in the file. the driver version is not part of the vulkan cache header and the header of
+	// a truncated or otherwise corrupt file should not reach the driver
+	struct FileHeader
+	{
+		uint32_t magic;
+		uint32_t version;
+		uint32_t vendorID;
+		uint32_t deviceID;
+		uint32_t driverVersion;
+		uint8_t pipelineCacheUUID[VK_UUID_SIZE];
+		uint32_t dataSize;
+		uint32_t dataHash;
+	};
+
+	uint32_t hashData(const char *data, size_t size)
+	{
+		// FNV-1a
+		uint32_t hash = 2166136261u;
+		for (size_t i = 0; i < size; ++i)
+		{
+			hash = (hash ^ static_cast<uint8_t>(data[i])) * 16777619u;
+		}
+		return hash;
+	}
+
+	FileHeader createFileHeader(const VkPhysicalDeviceProperties &properties)
+	{
+		FileHeader header{};
+		header.magic = FILE_MAGIC;
+		header.version = FILE_VERSION;
+		header.vendorID = properties.vendorID;
+		header.deviceID = properties.deviceID;
+		header.driverVersion = properties.driverVersion;
+		memcpy(header.pipelineCacheUUID, properties.pipelineCacheUUID, VK_UUID_SIZE);
+		return header;
+	}
+}
+
+sss::vulkan::PipelineCache::PipelineCache(VkDevice device, const VkPhysicalDeviceProperties &properties, const char *filepath)
+	:m_device(device),
+	m_properties(properties),
+	m_filepath(filepath),
+	m_pipelineCache(VK_NULL_HANDLE),
+	m_warm(false)
+{
+	std::vector<char> data;
+
+	// load and validate the cache file; a missing or stale file just means a cold start
+	{
+		std::ifstream file(m_filepath, std::ios::binary | std::ios::ate);
+		const std::streamoff fileSize = file.is_open() ? static_cast<std::streamoff>(file.tellg()) : 0;
+		file.seekg(0, std::ios::beg);
+
+		FileHeader header;
+		const FileHeader expectedHeader = createFileHeader(m_properties);
+
+		if (fileSize >= static_cast<std::streamoff>(sizeof(header))
+			&& file.read(reinterpret_cast<char *>(&header), sizeof(header))
+			&& header.dataSize == static_cast<uint64_t>(fileSize) - sizeof(header)
+			&& header.magic == expectedHeader.magic
+			&& header.version == expectedHeader.version
+			&& header.vendorID == expectedHeader.vendorID
+			&& header.deviceID == expectedHeader.deviceID
+			&& header.driverVersion == expectedHeader.driverVersion
+			&& memcmp(header.pipelineCacheUUID, expectedHeader.pipelineCacheUUID, VK_UUID_SIZE) == 0)
+		{
+			data.resize(header.dataSize);
+
+			if (!file.read(data.data(), data.size()) || hashData(data.data(), data.size()) != header.dataHash)
+			{
+				data.clear();
+			}
+		}
+	}
+
+	VkPipelineCacheCreateInfo createInfo{ VK_STRUCTURE_TYPE_PIPELINE_CACHE_CREATE_INFO };
+	createInfo.initialDataSize = data.size();
+	createInfo.pInitialData = data.data();
+
+	if (vkCreatePipelineCache(m_device, &createInfo, nullptr, &m_pipelineCache) != VK_SUCCESS)
+	{
+		// the driver may still reject the data, retry with an empty cache
+		createInfo.initialDataSize = 0;
+		createInfo.pInitialData = nullptr;
+		data.clear();
+
+		if (vkCreatePipelineCache(m_device, &createInfo, nullptr, &m_pipelineCache) != VK_SUCCESS)
+		{
+			util::fatalExit("Failed to create pipeline cache!", EXIT_FAILURE);
+		}
+	}
+
+	m_warm = !data.empty();
+}
+
+sss::vulkan::PipelineCache::~PipelineCache()
+{
+	size_t dataSize = 0;
+	std::vector<char> data;
+
+	if (vkGetPipelineCacheData(m_device, m_pipelineCache, &dataSize, nullptr) == VK_SUCCESS && dataSize > 0)
+	{
+		data.resize(dataSize);
+		if (vkGetPipelineCacheData(m_device, m_pipelineCache, &dataSize, data.data()) == VK_SUCCESS)
+		{
+			data.resize(dataSize);
+		}
+		else
+		{
+			data.clear();
+		}
+	}
+
+	vkDestroyPipelineCache(m_device, m_pipelineCache, nullptr);
+
+	if (data.empty())
+	{
+		return;
+	}
+
+	// write to a temporary file first, so that an interrupted write does not leave a truncated cache behind
+	FileHeader header = createFileHeader(m_properties);
+	header.dataSize = static_cast<uint32_t>(data.size());
+	header.dataHash = hashData(data.data(), data.size());
+
+	const std::string tmpFilepath = std::string(m_filepath) + ".tmp";
+	bool written;
+	{
+		std::ofstream file(tmpFilepath, std::ios::binary | std::ios::trunc);
+		written = file.write(reinterpret_cast<const char *>(&header), sizeof(header)) && file.write(data.data(), data.size());
+	}
+
+	if (written)
+	{
+		std::remove(m_filepath);
+		written = std::rename(tmpFilepath.c_str(), m_filepath) == 0;
+	}
+
+	if (!written)
+	{
+		std::remove(tmpFilepath.c_str());
+		fprintf(stderr, "Failed to write pipeline cache %s\n", m_filepath);
+	}
+}
+
+VkPipelineCache sss::vulkan::PipelineCache::get() const
+{
+	return m_pipelineCache;
+}
+
+bool sss::vulkan::PipelineCache::isWarm() const
+{
+	return m_warm;
+}
@@ -0,0 +1,31 @@
+#pragma once
+#include "volk.h"
+
+namespace sss
+{
+	namespace vulkan
+	{
+		// a VkPipelineCache persisted to disk. the file is only used if it was written for the same device and driver version,
+		// otherwise the cache starts out empty. the cache is written back on destruction
+		class PipelineCache
+		{
+		public:
+			explicit PipelineCache(VkDevice device, const VkPhysicalDeviceProperties &properties, const char *filepath);
+			PipelineCache(const PipelineCache &) = delete;
+			PipelineCache(const PipelineCache &&) = delete;
+			PipelineCache &operator= (const PipelineCache &) = delete;
+			PipelineCache &operator= (const PipelineCache &&) = delete;
+			~PipelineCache();
+			VkPipelineCache get() const;
+			// true if valid cache data was loaded from disk
+			bool isWarm() const;
+
+		private:
+			VkDevice m_device;
+			VkPhysicalDeviceProperties m_properties;
+			const char *m_filepath;
+			VkPipelineCache m_pipelineCache;
+			bool m_warm;
+		};
+	}
+}
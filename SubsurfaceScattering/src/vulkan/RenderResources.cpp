@@ -3,17 +3,26 @@
 #include "pipelines/ShadowPipeline.h"
 #include "pipelines/LightingPipeline.h"
 #include "pipelines/SkyboxPipeline.h"
+#include "pipelines/SSSClassifyPipeline.h"
 #include "pipelines/SSSBlurPipeline.h"
+#include "pipelines/SSSBurleyPipeline.h"
+#include "pipelines/SSSUpsamplePipeline.h"
 #include "pipelines/PostprocessingPipeline.h"
 #include "utility/Utility.h"
 #include "SwapChain.h"
 #include "VKUtility.h"
+#include "SSSKernel.h"
+#include "scene/Scene.h"
+#include <future>
+#include <chrono>
 
-sss::vulkan::RenderResources::RenderResources(VkPhysicalDevice physicalDevice, VkDevice device, VkCommandPool cmdPool, uint32_t width, uint32_t height, SwapChain *swapChain)
-	:m_physicalDevice(physicalDevice),
+sss::vulkan::RenderResources::RenderResources(MemoryAllocator &memoryAllocator, VkDevice device, VkPipelineCache pipelineCache, VkCommandPool cmdPool, VkCommandPool computeCmdPool, uint32_t width, uint32_t height, SwapChain *swapChain)
+	:m_memoryAllocator(memoryAllocator),
 	m_device(device),
 	m_commandPool(cmdPool),
-	m_swapChain(swapChain)
+	m_computeCommandPool(computeCmdPool),
+	m_swapChain(swapChain),
+	m_pipelineCreationTime()
 {
 	// create images and views and buffers
 	{
@@ -26,7 +35,17 @@ sss::vulkan::RenderResources::RenderResources(VkPhysicalDevice physicalDevice, V
 				createInfo.usage = VK_BUFFER_USAGE_UNIFORM_BUFFER_BIT;
 				createInfo.sharingMode = VK_SHARING_MODE_EXCLUSIVE;
 
-				m_constantBuffer[i] = std::make_unique<Buffer>(m_physicalDevice, m_device, createInfo, VK_MEMORY_PROPERTY_HOST_VISIBLE_BIT | VK_MEMORY_PROPERTY_HOST_COHERENT_BIT, VK_MEMORY_PROPERTY_DEVICE_LOCAL_BIT);
+				m_constantBuffer[i] = std::make_unique<Buffer>(m_memoryAllocator, createInfo, VK_MEMORY_PROPERTY_HOST_VISIBLE_BIT | VK_MEMORY_PROPERTY_HOST_COHERENT_BIT, VK_MEMORY_PROPERTY_DEVICE_LOCAL_BIT);
+			}
+
+			// sss kernel buffer
+			{
+				VkBufferCreateInfo createInfo{ VK_STRUCTURE_TYPE_BUFFER_CREATE_INFO };
+				createInfo.size = sizeof(SSSKernel::Data) * SSSKernel::MAX_PROFILE_COUNT;
+				createInfo.usage = VK_BUFFER_USAGE_UNIFORM_BUFFER_BIT;
+				createInfo.sharingMode = VK_SHARING_MODE_EXCLUSIVE;
+
+				m_sssKernelBuffer[i] = std::make_unique<Buffer>(m_memoryAllocator, createInfo, VK_MEMORY_PROPERTY_HOST_VISIBLE_BIT | VK_MEMORY_PROPERTY_HOST_COHERENT_BIT, VK_MEMORY_PROPERTY_DEVICE_LOCAL_BIT);
 			}
 
 			// shadow
@@ -45,7 +64,7 @@ sss::vulkan::RenderResources::RenderResources(VkPhysicalDevice physicalDevice, V
 				imageCreateInfo.sharingMode = VK_SHARING_MODE_EXCLUSIVE;
 				imageCreateInfo.initialLayout = VK_IMAGE_LAYOUT_UNDEFINED;
 
-				m_shadowImage[i] = std::make_unique<Image>(m_physicalDevice, m_device, imageCreateInfo, VK_MEMORY_PROPERTY_DEVICE_LOCAL_BIT,
+				m_shadowImage[i] = std::make_unique<Image>(m_memoryAllocator, imageCreateInfo, VK_MEMORY_PROPERTY_DEVICE_LOCAL_BIT,
 					0, VK_IMAGE_VIEW_TYPE_2D, VkImageSubresourceRange{ VK_IMAGE_ASPECT_DEPTH_BIT, 0, 1, 0, 1 });
 			}
 		}
@@ -208,7 +227,9 @@ sss::vulkan::RenderResources::RenderResources(VkPhysicalDevice physicalDevice, V
 		}
 	}
 
-	// create gui renderpass
+	// create gui renderpass (headless rendering has no backbuffer to draw the gui into)
+	m_guiRenderPass = VK_NULL_HANDLE;
+	if (m_swapChain)
 	{
 		VkAttachmentDescription attachmentDescription{};
 		attachmentDescription.format = m_swapChain->getImageFormat();
@@ -266,6 +287,14 @@ sss::vulkan::RenderResources::RenderResources(VkPhysicalDevice physicalDevice, V
 		{
 			util::fatalExit("Failed to allocate command buffers!", EXIT_FAILURE);
 		}
+
+		cmdBufAllocInfo.commandBufferCount = FRAMES_IN_FLIGHT;
+		cmdBufAllocInfo.commandPool = m_computeCommandPool;
+
+		if (vkAllocateCommandBuffers(m_device, &cmdBufAllocInfo, m_computeCommandBuffers) != VK_SUCCESS)
+		{
+			util::fatalExit("Failed to allocate command buffers!", EXIT_FAILURE);
+		}
 	}
 
 	// create sync primitives
@@ -287,6 +316,21 @@ sss::vulkan::RenderResources::RenderResources(VkPhysicalDevice physicalDevice, V
 				util::fatalExit("Failed to create semaphore!", EXIT_FAILURE);
 			}
 
+			if (vkCreateSemaphore(m_device, &semaphoreCreateInfo, nullptr, &m_mainPassFinishedSemaphores[i]) != VK_SUCCESS)
+			{
+				util::fatalExit("Failed to create semaphore!", EXIT_FAILURE);
+			}
+
+			if (vkCreateSemaphore(m_device, &semaphoreCreateInfo, nullptr, &m_computeFinishedSemaphores[i]) != VK_SUCCESS)
+			{
+				util::fatalExit("Failed to create semaphore!", EXIT_FAILURE);
+			}
+
+			if (vkCreateSemaphore(m_device, &semaphoreCreateInfo, nullptr, &m_historyReleasedSemaphores[i]) != VK_SUCCESS)
+			{
+				util::fatalExit("Failed to create semaphore!", EXIT_FAILURE);
+			}
+
 			if (vkCreateFence(m_device, &fenceCreateInfo, nullptr, &m_frameFinishedFence[i]) != VK_SUCCESS)
 			{
 				util::fatalExit("Failed to create fence!", EXIT_FAILURE);
@@ -398,17 +442,18 @@ sss::vulkan::RenderResources::RenderResources(VkPhysicalDevice physicalDevice, V
 
 	// create descriptor sets
 	{
-		const size_t textureCount = 10;
+		const size_t textureCount = scene::MAX_TEXTURE_COUNT;
 		VkDescriptorPoolSize poolSizes[] =
 		{
-			{ VK_DESCRIPTOR_TYPE_UNIFORM_BUFFER, FRAMES_IN_FLIGHT },
-			{ VK_DESCRIPTOR_TYPE_COMBINED_IMAGE_SAMPLER, FRAMES_IN_FLIGHT * (1 /*shadow maps*/ + 4 /*depth and diffuse for 2 sss blur passes*/ + 4/* postprocessing input*/) + (textureCount + 4 /*cubemaps*/) + 1 /*imgui*/ },
-			{ VK_DESCRIPTOR_TYPE_STORAGE_IMAGE, FRAMES_IN_FLIGHT * 3 /* 2 sss blur passes + 1 postprocessing pass*/ }
+			{ VK_DESCRIPTOR_TYPE_UNIFORM_BUFFER, FRAMES_IN_FLIGHT * (1 /*constant buffer*/ + 4 /*sss kernel for 2 full and 2 half res sss blur passes*/ + 1 /*sss kernel for postprocessing*/) },
+			{ VK_DESCRIPTOR_TYPE_COMBINED_IMAGE_SAMPLER, FRAMES_IN_FLIGHT * (1 /*shadow maps*/ + 4 /*full and half res sss classification inputs*/ + 8 /*linear depth and diffuse for 2 full and 2 half res sss blur passes*/ + 4 /*sss upsample input*/ + 7/* postprocessing input*/) + (textureCount + 4 /*cubemaps*/) + 1 /*imgui*/ },
+			{ VK_DESCRIPTOR_TYPE_STORAGE_IMAGE, FRAMES_IN_FLIGHT * 9 /* 1 full + 2 half res sss classification outputs + 4 sss blur passes + 1 sss upsample + 1 postprocessing pass*/ },
+			{ VK_DESCRIPTOR_TYPE_STORAGE_BUFFER, FRAMES_IN_FLIGHT * 6 /* tile list of full and half res sss classification + 4 sss blur passes*/ }
 		};
 
 		VkDescriptorPoolCreateInfo poolCreateInfo{ VK_STRUCTURE_TYPE_DESCRIPTOR_POOL_CREATE_INFO };
-		poolCreateInfo.maxSets = FRAMES_IN_FLIGHT * 4 + 2;
-		poolCreateInfo.poolSizeCount = 3;
+		poolCreateInfo.maxSets = FRAMES_IN_FLIGHT * 9 + 2;
+		poolCreateInfo.poolSizeCount = static_cast<uint32_t>(sizeof(poolSizes) / sizeof(poolSizes[0]));
 		poolCreateInfo.pPoolSizes = poolSizes;
 
 		if (vkCreateDescriptorPool(m_device, &poolCreateInfo, nullptr, &m_descriptorPool) != VK_SUCCESS)
@@ -488,6 +533,48 @@ sss::vulkan::RenderResources::RenderResources(VkPhysicalDevice physicalDevice, V
 			}
 		}
 
+		// sss classification sets
+		{
+			VkDescriptorSetLayoutBinding bindings[] =
+			{
+				{ 0, VK_DESCRIPTOR_TYPE_COMBINED_IMAGE_SAMPLER, 1, VK_SHADER_STAGE_COMPUTE_BIT, &m_pointSamplerClamp },
+				{ 1, VK_DESCRIPTOR_TYPE_STORAGE_BUFFER, 1, VK_SHADER_STAGE_COMPUTE_BIT, nullptr },
+				{ 2, VK_DESCRIPTOR_TYPE_COMBINED_IMAGE_SAMPLER, 1, VK_SHADER_STAGE_COMPUTE_BIT, &m_pointSamplerClamp },
+				{ 3, VK_DESCRIPTOR_TYPE_STORAGE_IMAGE, 1, VK_SHADER_STAGE_COMPUTE_BIT, nullptr },
+				{ 4, VK_DESCRIPTOR_TYPE_STORAGE_IMAGE, 1, VK_SHADER_STAGE_COMPUTE_BIT, nullptr }, // only used by the half res variant
+			};
+
+			VkDescriptorSetLayoutCreateInfo layoutCreateInfo{ VK_STRUCTURE_TYPE_DESCRIPTOR_SET_LAYOUT_CREATE_INFO };
+			layoutCreateInfo.bindingCount = static_cast<uint32_t>(sizeof(bindings) / sizeof(bindings[0]));
+			layoutCreateInfo.pBindings = bindings;
+
+			if (vkCreateDescriptorSetLayout(m_device, &layoutCreateInfo, nullptr, &m_sssClassifyDescriptorSetLayout) != VK_SUCCESS)
+			{
+				util::fatalExit("Failed to create descriptor set layout!", EXIT_FAILURE);
+			}
+
+			VkDescriptorSetLayout setLayouts[FRAMES_IN_FLIGHT];
+			for (size_t i = 0; i < FRAMES_IN_FLIGHT; ++i)
+			{
+				setLayouts[i] = m_sssClassifyDescriptorSetLayout;
+			}
+
+			VkDescriptorSetAllocateInfo setAllocInfo{ VK_STRUCTURE_TYPE_DESCRIPTOR_SET_ALLOCATE_INFO };
+			setAllocInfo.descriptorPool = m_descriptorPool;
+			setAllocInfo.descriptorSetCount = FRAMES_IN_FLIGHT;
+			setAllocInfo.pSetLayouts = setLayouts;
+
+			if (vkAllocateDescriptorSets(m_device, &setAllocInfo, m_sssClassifyDescriptorSet) != VK_SUCCESS)
+			{
+				util::fatalExit("Failed to allocate descriptor sets!", EXIT_FAILURE);
+			}
+
+			if (vkAllocateDescriptorSets(m_device, &setAllocInfo, m_sssClassifyHalfResDescriptorSet) != VK_SUCCESS)
+			{
+				util::fatalExit("Failed to allocate descriptor sets!", EXIT_FAILURE);
+			}
+		}
+
 		// sss blur sets
 		{
 			VkDescriptorSetLayoutBinding bindings[] =
@@ -495,6 +582,8 @@ sss::vulkan::RenderResources::RenderResources(VkPhysicalDevice physicalDevice, V
 				{ 0, VK_DESCRIPTOR_TYPE_COMBINED_IMAGE_SAMPLER, 1, VK_SHADER_STAGE_COMPUTE_BIT, &m_linearSamplerClamp },
 				{ 1, VK_DESCRIPTOR_TYPE_COMBINED_IMAGE_SAMPLER, 1, VK_SHADER_STAGE_COMPUTE_BIT, &m_pointSamplerClamp },
 				{ 2, VK_DESCRIPTOR_TYPE_STORAGE_IMAGE, 1, VK_SHADER_STAGE_COMPUTE_BIT, nullptr },
+				{ 3, VK_DESCRIPTOR_TYPE_UNIFORM_BUFFER, 1, VK_SHADER_STAGE_COMPUTE_BIT, nullptr },
+				{ 4, VK_DESCRIPTOR_TYPE_STORAGE_BUFFER, 1, VK_SHADER_STAGE_COMPUTE_BIT, nullptr },
 			};
 
 			VkDescriptorSetLayoutCreateInfo layoutCreateInfo{ VK_STRUCTURE_TYPE_DESCRIPTOR_SET_LAYOUT_CREATE_INFO };
@@ -521,6 +610,48 @@ sss::vulkan::RenderResources::RenderResources(VkPhysicalDevice physicalDevice, V
 			{
 				util::fatalExit("Failed to allocate descriptor sets!", EXIT_FAILURE);
 			}
+
+			if (vkAllocateDescriptorSets(m_device, &setAllocInfo, m_sssBlurHalfResDescriptorSet) != VK_SUCCESS)
+			{
+				util::fatalExit("Failed to allocate descriptor sets!", EXIT_FAILURE);
+			}
+		}
+
+		// sss upsample sets
+		{
+			VkDescriptorSetLayoutBinding bindings[] =
+			{
+				{ 0, VK_DESCRIPTOR_TYPE_COMBINED_IMAGE_SAMPLER, 1, VK_SHADER_STAGE_COMPUTE_BIT, &m_pointSamplerClamp },
+				{ 1, VK_DESCRIPTOR_TYPE_COMBINED_IMAGE_SAMPLER, 1, VK_SHADER_STAGE_COMPUTE_BIT, &m_pointSamplerClamp },
+				{ 2, VK_DESCRIPTOR_TYPE_COMBINED_IMAGE_SAMPLER, 1, VK_SHADER_STAGE_COMPUTE_BIT, &m_pointSamplerClamp },
+				{ 3, VK_DESCRIPTOR_TYPE_STORAGE_IMAGE, 1, VK_SHADER_STAGE_COMPUTE_BIT, nullptr },
+				{ 4, VK_DESCRIPTOR_TYPE_COMBINED_IMAGE_SAMPLER, 1, VK_SHADER_STAGE_COMPUTE_BIT, &m_pointSamplerClamp },
+			};
+
+			VkDescriptorSetLayoutCreateInfo layoutCreateInfo{ VK_STRUCTURE_TYPE_DESCRIPTOR_SET_LAYOUT_CREATE_INFO };
+			layoutCreateInfo.bindingCount = static_cast<uint32_t>(sizeof(bindings) / sizeof(bindings[0]));
+			layoutCreateInfo.pBindings = bindings;
+
+			if (vkCreateDescriptorSetLayout(m_device, &layoutCreateInfo, nullptr, &m_sssUpsampleDescriptorSetLayout) != VK_SUCCESS)
+			{
+				util::fatalExit("Failed to create descriptor set layout!", EXIT_FAILURE);
+			}
+
+			VkDescriptorSetLayout setLayouts[FRAMES_IN_FLIGHT];
+			for (size_t i = 0; i < FRAMES_IN_FLIGHT; ++i)
+			{
+				setLayouts[i] = m_sssUpsampleDescriptorSetLayout;
+			}
+
+			VkDescriptorSetAllocateInfo setAllocInfo{ VK_STRUCTURE_TYPE_DESCRIPTOR_SET_ALLOCATE_INFO };
+			setAllocInfo.descriptorPool = m_descriptorPool;
+			setAllocInfo.descriptorSetCount = FRAMES_IN_FLIGHT;
+			setAllocInfo.pSetLayouts = setLayouts;
+
+			if (vkAllocateDescriptorSets(m_device, &setAllocInfo, m_sssUpsampleDescriptorSet) != VK_SUCCESS)
+			{
+				util::fatalExit("Failed to allocate descriptor sets!", EXIT_FAILURE);
+			}
 		}
 
 		// postprocessing set
@@ -532,6 +663,9 @@ sss::vulkan::RenderResources::RenderResources(VkPhysicalDevice physicalDevice, V
 				{ 2, VK_DESCRIPTOR_TYPE_COMBINED_IMAGE_SAMPLER, 1, VK_SHADER_STAGE_COMPUTE_BIT, &m_pointSamplerClamp },
 				{ 3, VK_DESCRIPTOR_TYPE_COMBINED_IMAGE_SAMPLER, 1, VK_SHADER_STAGE_COMPUTE_BIT, &m_pointSamplerClamp },
 				{ 4, VK_DESCRIPTOR_TYPE_COMBINED_IMAGE_SAMPLER, 1, VK_SHADER_STAGE_COMPUTE_BIT, &m_linearSamplerClamp },
+				{ 5, VK_DESCRIPTOR_TYPE_COMBINED_IMAGE_SAMPLER, 1, VK_SHADER_STAGE_COMPUTE_BIT, &m_linearSamplerClamp },
+				{ 6, VK_DESCRIPTOR_TYPE_COMBINED_IMAGE_SAMPLER, 1, VK_SHADER_STAGE_COMPUTE_BIT, &m_pointSamplerClamp },
+				{ 7, VK_DESCRIPTOR_TYPE_UNIFORM_BUFFER, 1, VK_SHADER_STAGE_COMPUTE_BIT, nullptr },
 			};
 
 			VkDescriptorSetLayoutCreateInfo layoutCreateInfo{ VK_STRUCTURE_TYPE_DESCRIPTOR_SET_LAYOUT_CREATE_INFO };
@@ -563,7 +697,7 @@ sss::vulkan::RenderResources::RenderResources(VkPhysicalDevice physicalDevice, V
 
 	VkQueryPoolCreateInfo queryPoolCreateInfo = { VK_STRUCTURE_TYPE_QUERY_POOL_CREATE_INFO };
 	queryPoolCreateInfo.queryType = VK_QUERY_TYPE_TIMESTAMP;
-	queryPoolCreateInfo.queryCount = FRAMES_IN_FLIGHT * 2;
+	queryPoolCreateInfo.queryCount = FRAMES_IN_FLIGHT * TIMESTAMP_COUNT;
 
 	if (vkCreateQueryPool(m_device, &queryPoolCreateInfo, nullptr, &m_queryPool) != VK_SUCCESS)
 	{
@@ -572,13 +706,36 @@ sss::vulkan::RenderResources::RenderResources(VkPhysicalDevice physicalDevice, V
 
 	VkDescriptorSetLayout lightingDescriptorSetLayouts[] = { m_textureDescriptorSetLayout, m_lightingDescriptorSetLayout };
 
-	m_shadowPipeline = ShadowPipeline::create(m_device, m_shadowRenderPass, 0, 0, nullptr);
-	m_lightingPipeline = LightingPipeline::create(m_device, m_mainRenderPass, 0, 2, lightingDescriptorSetLayouts, false);
-	m_sssLightingPipeline = LightingPipeline::create(m_device, m_mainRenderPass, 1, 2, lightingDescriptorSetLayouts, true);
-	m_skyboxPipeline = SkyboxPipeline::create(m_device, m_mainRenderPass, 2, 1, &m_textureDescriptorSetLayout);
-	m_sssBlurPipeline0 = SSSBlurPipeline::create(m_device, 1, &m_sssBlurDescriptorSetLayout);
-	m_sssBlurPipeline1 = SSSBlurPipeline::create(m_device, 1, &m_sssBlurDescriptorSetLayout);
-	m_posprocessingPipeline = PostprocessingPipeline::create(m_device, 1, &m_postprocessingDescriptorSetLayout);
+	// pipeline creation is dominated by shader compilation in the driver and the pipelines are independent of each other,
+	// so they are created on separate threads. the pipeline cache is internally synchronized
+	{
+		const auto startTime = std::chrono::steady_clock::now();
+
+		std::future<void> pipelineTasks[] =
+		{
+			std::async(std::launch::async, [&]() { m_shadowPipeline = ShadowPipeline::create(m_device, pipelineCache, m_shadowRenderPass, 0, 0, nullptr); }),
+			std::async(std::launch::async, [&]() { m_lightingPipeline = LightingPipeline::create(m_device, pipelineCache, m_mainRenderPass, 0, 2, lightingDescriptorSetLayouts, false); }),
+			std::async(std::launch::async, [&]() { m_sssLightingPipeline = LightingPipeline::create(m_device, pipelineCache, m_mainRenderPass, 1, 2, lightingDescriptorSetLayouts, true); }),
+			std::async(std::launch::async, [&]() { m_skyboxPipeline = SkyboxPipeline::create(m_device, pipelineCache, m_mainRenderPass, 2, 1, &m_textureDescriptorSetLayout); }),
+			std::async(std::launch::async, [&]() { m_sssClassifyPipeline = SSSClassifyPipeline::create(m_device, pipelineCache, 1, &m_sssClassifyDescriptorSetLayout, false); }),
+			std::async(std::launch::async, [&]() { m_sssClassifyHalfResPipeline = SSSClassifyPipeline::create(m_device, pipelineCache, 1, &m_sssClassifyDescriptorSetLayout, true); }),
+			std::async(std::launch::async, [&]() { m_sssBlurPipeline0 = SSSBlurPipeline::create(m_device, pipelineCache, 1, &m_sssBlurDescriptorSetLayout, false); }),
+			std::async(std::launch::async, [&]() { m_sssBlurPipeline1 = SSSBlurPipeline::create(m_device, pipelineCache, 1, &m_sssBlurDescriptorSetLayout, false); }),
+			std::async(std::launch::async, [&]() { m_sssBlurTiledPipeline0 = SSSBlurPipeline::create(m_device, pipelineCache, 1, &m_sssBlurDescriptorSetLayout, true); }),
+			std::async(std::launch::async, [&]() { m_sssBlurTiledPipeline1 = SSSBlurPipeline::create(m_device, pipelineCache, 1, &m_sssBlurDescriptorSetLayout, true); }),
+			std::async(std::launch::async, [&]() { m_sssBurleyPipeline = SSSBurleyPipeline::create(m_device, pipelineCache, 1, &m_sssBlurDescriptorSetLayout); }),
+			std::async(std::launch::async, [&]() { m_sssUpsamplePipeline = SSSUpsamplePipeline::create(m_device, pipelineCache, 1, &m_sssUpsampleDescriptorSetLayout); }),
+			std::async(std::launch::async, [&]() { m_posprocessingPipeline = PostprocessingPipeline::create(m_device, pipelineCache, 1, &m_postprocessingDescriptorSetLayout, false); }),
+			std::async(std::launch::async, [&]() { m_posprocessingFusedSSSBlurPipeline = PostprocessingPipeline::create(m_device, pipelineCache, 1, &m_postprocessingDescriptorSetLayout, true); })
+		};
+
+		for (auto &task : pipelineTasks)
+		{
+			task.get();
+		}
+
+		m_pipelineCreationTime = std::chrono::duration<float, std::milli>(std::chrono::steady_clock::now() - startTime).count();
+	}
 
 	createResizableResources(width, height);
 }
@@ -597,18 +754,34 @@ sss::vulkan::RenderResources::~RenderResources()
 	vkDestroyPipelineLayout(m_device, m_sssLightingPipeline.second, nullptr);
 	vkDestroyPipeline(m_device, m_skyboxPipeline.first, nullptr);
 	vkDestroyPipelineLayout(m_device, m_skyboxPipeline.second, nullptr);
+	vkDestroyPipeline(m_device, m_sssClassifyPipeline.first, nullptr);
+	vkDestroyPipelineLayout(m_device, m_sssClassifyPipeline.second, nullptr);
+	vkDestroyPipeline(m_device, m_sssClassifyHalfResPipeline.first, nullptr);
+	vkDestroyPipelineLayout(m_device, m_sssClassifyHalfResPipeline.second, nullptr);
 	vkDestroyPipeline(m_device, m_sssBlurPipeline0.first, nullptr);
 	vkDestroyPipelineLayout(m_device, m_sssBlurPipeline0.second, nullptr);
 	vkDestroyPipeline(m_device, m_sssBlurPipeline1.first, nullptr);
 	vkDestroyPipelineLayout(m_device, m_sssBlurPipeline1.second, nullptr);
+	vkDestroyPipeline(m_device, m_sssBlurTiledPipeline0.first, nullptr);
+	vkDestroyPipelineLayout(m_device, m_sssBlurTiledPipeline0.second, nullptr);
+	vkDestroyPipeline(m_device, m_sssBlurTiledPipeline1.first, nullptr);
+	vkDestroyPipelineLayout(m_device, m_sssBlurTiledPipeline1.second, nullptr);
+	vkDestroyPipeline(m_device, m_sssBurleyPipeline.first, nullptr);
+	vkDestroyPipelineLayout(m_device, m_sssBurleyPipeline.second, nullptr);
+	vkDestroyPipeline(m_device, m_sssUpsamplePipeline.first, nullptr);
+	vkDestroyPipelineLayout(m_device, m_sssUpsamplePipeline.second, nullptr);
 	vkDestroyPipeline(m_device, m_posprocessingPipeline.first, nullptr);
 	vkDestroyPipelineLayout(m_device, m_posprocessingPipeline.second, nullptr);
+	vkDestroyPipeline(m_device, m_posprocessingFusedSSSBlurPipeline.first, nullptr);
+	vkDestroyPipelineLayout(m_device, m_posprocessingFusedSSSBlurPipeline.second, nullptr);
 
 	vkDestroyQueryPool(m_device, m_queryPool, nullptr);
 
 	vkDestroyDescriptorSetLayout(m_device, m_textureDescriptorSetLayout, nullptr);
 	vkDestroyDescriptorSetLayout(m_device, m_lightingDescriptorSetLayout, nullptr);
+	vkDestroyDescriptorSetLayout(m_device, m_sssClassifyDescriptorSetLayout, nullptr);
 	vkDestroyDescriptorSetLayout(m_device, m_sssBlurDescriptorSetLayout, nullptr);
+	vkDestroyDescriptorSetLayout(m_device, m_sssUpsampleDescriptorSetLayout, nullptr);
 	vkDestroyDescriptorSetLayout(m_device, m_postprocessingDescriptorSetLayout, nullptr);
 	vkDestroyDescriptorPool(m_device, m_descriptorPool, nullptr);
 
@@ -622,6 +795,9 @@ sss::vulkan::RenderResources::~RenderResources()
 	{
 		vkDestroySemaphore(m_device, m_swapChainImageAvailableSemaphores[i], nullptr);
 		vkDestroySemaphore(m_device, m_renderFinishedSemaphores[i], nullptr);
+		vkDestroySemaphore(m_device, m_mainPassFinishedSemaphores[i], nullptr);
+		vkDestroySemaphore(m_device, m_computeFinishedSemaphores[i], nullptr);
+		vkDestroySemaphore(m_device, m_historyReleasedSemaphores[i], nullptr);
 		vkDestroyFence(m_device, m_frameFinishedFence[i], nullptr);
 	}
 
@@ -639,27 +815,67 @@ void sss::vulkan::RenderResources::resize(uint32_t width, uint32_t height)
 
 void sss::vulkan::RenderResources::createResizableResources(uint32_t width, uint32_t height)
 {
-	for (size_t i = 0; i < FRAMES_IN_FLIGHT; ++i)
+	// all of these are destroyed together on resize, so their memory comes from the linear pool
+	VkImageCreateInfo imageCreateInfo{ VK_STRUCTURE_TYPE_IMAGE_CREATE_INFO };
+	imageCreateInfo.imageType = VK_IMAGE_TYPE_2D;
+	imageCreateInfo.extent.width = width;
+	imageCreateInfo.extent.height = height;
+	imageCreateInfo.extent.depth = 1;
+	imageCreateInfo.mipLevels = 1;
+	imageCreateInfo.arrayLayers = 1;
+	imageCreateInfo.samples = VK_SAMPLE_COUNT_1_BIT;
+	imageCreateInfo.tiling = VK_IMAGE_TILING_OPTIMAL;
+	imageCreateInfo.sharingMode = VK_SHARING_MODE_EXCLUSIVE;
+	imageCreateInfo.initialLayout = VK_IMAGE_LAYOUT_UNDEFINED;
+
+	// sss intermediate images: diffuse1 and linear depth at full resolution and diffuse0, diffuse1 and linear depth at half resolution.
+	// a frame only uses one of the two sets and none of them outlives the frame, so the sets alias each other in one allocation.
+	// they are only accessed by the compute part of the frame, which runs on the same queue for all frames in order. a single copy
+	// is shared by all frames in flight; the frame graph makes each frame wait for the accesses of the previous one
 	{
-		VkImageCreateInfo imageCreateInfo{ VK_STRUCTURE_TYPE_IMAGE_CREATE_INFO };
-		imageCreateInfo.imageType = VK_IMAGE_TYPE_2D;
-		imageCreateInfo.extent.width = width;
-		imageCreateInfo.extent.height = height;
-		imageCreateInfo.extent.depth = 1;
-		imageCreateInfo.mipLevels = 1;
-		imageCreateInfo.arrayLayers = 1;
-		imageCreateInfo.samples = VK_SAMPLE_COUNT_1_BIT;
-		imageCreateInfo.tiling = VK_IMAGE_TILING_OPTIMAL;
-		imageCreateInfo.sharingMode = VK_SHARING_MODE_EXCLUSIVE;
-		imageCreateInfo.initialLayout = VK_IMAGE_LAYOUT_UNDEFINED;
+		VkImageCreateInfo createInfos[5] = { imageCreateInfo, imageCreateInfo, imageCreateInfo, imageCreateInfo, imageCreateInfo };
+		const uint32_t aliasSets[5] = { 0, 0, 1, 1, 1 };
+
+		// full res diffuse1
+		createInfos[0].format = VK_FORMAT_R16G16B16A16_SFLOAT;
+		createInfos[0].usage = VK_IMAGE_USAGE_STORAGE_BIT | VK_IMAGE_USAGE_SAMPLED_BIT | VK_IMAGE_USAGE_TRANSFER_DST_BIT;
+
+		// full res linear depth; R16_SFLOAT would suffice, but storage image support for it is optional
+		createInfos[1].format = VK_FORMAT_R32_SFLOAT;
+		createInfos[1].usage = VK_IMAGE_USAGE_STORAGE_BIT | VK_IMAGE_USAGE_SAMPLED_BIT;
 
+		// half res diffuse0, diffuse1 and linear depth
+		for (size_t j = 2; j < 5; ++j)
+		{
+			createInfos[j].extent.width = (width + 1) / 2;
+			createInfos[j].extent.height = (height + 1) / 2;
+			createInfos[j].format = j < 4 ? VK_FORMAT_R16G16B16A16_SFLOAT : VK_FORMAT_R32_SFLOAT;
+			createInfos[j].usage = VK_IMAGE_USAGE_STORAGE_BIT | VK_IMAGE_USAGE_SAMPLED_BIT | (j < 4 ? VK_IMAGE_USAGE_TRANSFER_DST_BIT : 0);
+		}
+
+		VkImage images[5];
+		if (vkutil::createAliasedImages(m_memoryAllocator, 5, createInfos, aliasSets, VK_MEMORY_PROPERTY_DEVICE_LOCAL_BIT, 0, MEMORY_POOL_LINEAR, images, m_sssImageMemory) != VK_SUCCESS)
+		{
+			util::fatalExit("Failed to create image!", EXIT_FAILURE);
+		}
+
+		const VkImageSubresourceRange subresourceRange = { VK_IMAGE_ASPECT_COLOR_BIT, 0, 1, 0, 1 };
+		m_diffuse1Image = std::make_unique<Image>(m_device, images[0], createInfos[0].format, VK_IMAGE_VIEW_TYPE_2D, subresourceRange);
+		m_linearDepthImage = std::make_unique<Image>(m_device, images[1], createInfos[1].format, VK_IMAGE_VIEW_TYPE_2D, subresourceRange);
+		m_halfResDiffuse0Image = std::make_unique<Image>(m_device, images[2], createInfos[2].format, VK_IMAGE_VIEW_TYPE_2D, subresourceRange);
+		m_halfResDiffuse1Image = std::make_unique<Image>(m_device, images[3], createInfos[3].format, VK_IMAGE_VIEW_TYPE_2D, subresourceRange);
+		m_halfResLinearDepthImage = std::make_unique<Image>(m_device, images[4], createInfos[4].format, VK_IMAGE_VIEW_TYPE_2D, subresourceRange);
+	}
+
+	for (size_t i = 0; i < FRAMES_IN_FLIGHT; ++i)
+	{
 		// depth
 		{
 			imageCreateInfo.format = VK_FORMAT_D32_SFLOAT_S8_UINT;
 			imageCreateInfo.usage = VK_IMAGE_USAGE_DEPTH_STENCIL_ATTACHMENT_BIT | VK_IMAGE_USAGE_SAMPLED_BIT;
 
-			m_depthStencilImage[i] = std::make_unique<Image>(m_physicalDevice, m_device, imageCreateInfo, VK_MEMORY_PROPERTY_DEVICE_LOCAL_BIT,
-				0, VK_IMAGE_VIEW_TYPE_2D, VkImageSubresourceRange{ VK_IMAGE_ASPECT_DEPTH_BIT | VK_IMAGE_ASPECT_STENCIL_BIT, 0, 1, 0, 1 });
+			m_depthStencilImage[i] = std::make_unique<Image>(m_memoryAllocator, imageCreateInfo, VK_MEMORY_PROPERTY_DEVICE_LOCAL_BIT,
+				0, VK_IMAGE_VIEW_TYPE_2D, VkImageSubresourceRange{ VK_IMAGE_ASPECT_DEPTH_BIT | VK_IMAGE_ASPECT_STENCIL_BIT, 0, 1, 0, 1 }, MEMORY_POOL_LINEAR);
 
 			VkImageViewCreateInfo viewCreateInfo{ VK_STRUCTURE_TYPE_IMAGE_VIEW_CREATE_INFO };
 			viewCreateInfo.viewType = VK_IMAGE_VIEW_TYPE_2D;
@@ -678,20 +894,17 @@ void sss::vulkan::RenderResources::createResizableResources(uint32_t width, uint
 			imageCreateInfo.format = VK_FORMAT_R16G16B16A16_SFLOAT;
 			imageCreateInfo.usage = VK_IMAGE_USAGE_COLOR_ATTACHMENT_BIT | VK_IMAGE_USAGE_SAMPLED_BIT;
 
-			m_colorImage[i] = std::make_unique<Image>(m_physicalDevice, m_device, imageCreateInfo, VK_MEMORY_PROPERTY_DEVICE_LOCAL_BIT,
-				0, VK_IMAGE_VIEW_TYPE_2D, VkImageSubresourceRange{ VK_IMAGE_ASPECT_COLOR_BIT, 0, 1, 0, 1 });
+			m_colorImage[i] = std::make_unique<Image>(m_memoryAllocator, imageCreateInfo, VK_MEMORY_PROPERTY_DEVICE_LOCAL_BIT,
+				0, VK_IMAGE_VIEW_TYPE_2D, VkImageSubresourceRange{ VK_IMAGE_ASPECT_COLOR_BIT, 0, 1, 0, 1 }, MEMORY_POOL_LINEAR);
 		}
 
 		// diffuse
 		{
 			imageCreateInfo.format = VK_FORMAT_R16G16B16A16_SFLOAT;
-			imageCreateInfo.usage = VK_IMAGE_USAGE_STORAGE_BIT | VK_IMAGE_USAGE_COLOR_ATTACHMENT_BIT | VK_IMAGE_USAGE_SAMPLED_BIT;
-
-			m_diffuse0Image[i] = std::make_unique<Image>(m_physicalDevice, m_device, imageCreateInfo, VK_MEMORY_PROPERTY_DEVICE_LOCAL_BIT,
-				0, VK_IMAGE_VIEW_TYPE_2D, VkImageSubresourceRange{ VK_IMAGE_ASPECT_COLOR_BIT, 0, 1, 0, 1 });
+			imageCreateInfo.usage = VK_IMAGE_USAGE_STORAGE_BIT | VK_IMAGE_USAGE_COLOR_ATTACHMENT_BIT | VK_IMAGE_USAGE_SAMPLED_BIT | VK_IMAGE_USAGE_TRANSFER_DST_BIT;
 
-			m_diffuse1Image[i] = std::make_unique<Image>(m_physicalDevice, m_device, imageCreateInfo, VK_MEMORY_PROPERTY_DEVICE_LOCAL_BIT,
-				0, VK_IMAGE_VIEW_TYPE_2D, VkImageSubresourceRange{ VK_IMAGE_ASPECT_COLOR_BIT, 0, 1, 0, 1 });
+			m_diffuse0Image[i] = std::make_unique<Image>(m_memoryAllocator, imageCreateInfo, VK_MEMORY_PROPERTY_DEVICE_LOCAL_BIT,
+				0, VK_IMAGE_VIEW_TYPE_2D, VkImageSubresourceRange{ VK_IMAGE_ASPECT_COLOR_BIT, 0, 1, 0, 1 }, MEMORY_POOL_LINEAR);
 		}
 
 		// tonemap result
@@ -699,8 +912,20 @@ void sss::vulkan::RenderResources::createResizableResources(uint32_t width, uint
 			imageCreateInfo.format = VK_FORMAT_R8G8B8A8_UNORM;
 			imageCreateInfo.usage = VK_IMAGE_USAGE_STORAGE_BIT | VK_IMAGE_USAGE_TRANSFER_SRC_BIT | VK_IMAGE_USAGE_COLOR_ATTACHMENT_BIT | VK_IMAGE_USAGE_SAMPLED_BIT;
 
-			m_tonemappedImage[i] = std::make_unique<Image>(m_physicalDevice, m_device, imageCreateInfo, VK_MEMORY_PROPERTY_DEVICE_LOCAL_BIT,
-				0, VK_IMAGE_VIEW_TYPE_2D, VkImageSubresourceRange{ VK_IMAGE_ASPECT_COLOR_BIT, 0, 1, 0, 1 });
+			m_tonemappedImage[i] = std::make_unique<Image>(m_memoryAllocator, imageCreateInfo, VK_MEMORY_PROPERTY_DEVICE_LOCAL_BIT,
+				0, VK_IMAGE_VIEW_TYPE_2D, VkImageSubresourceRange{ VK_IMAGE_ASPECT_COLOR_BIT, 0, 1, 0, 1 }, MEMORY_POOL_LINEAR);
+		}
+
+		// sss tile buffer
+		{
+			const uint32_t tileCount = ((width + 15) / 16) * ((height + 15) / 16);
+
+			VkBufferCreateInfo createInfo{ VK_STRUCTURE_TYPE_BUFFER_CREATE_INFO };
+			createInfo.size = sizeof(VkDispatchIndirectCommand) + sizeof(uint32_t) * tileCount;
+			createInfo.usage = VK_BUFFER_USAGE_STORAGE_BUFFER_BIT | VK_BUFFER_USAGE_INDIRECT_BUFFER_BIT | VK_BUFFER_USAGE_TRANSFER_DST_BIT;
+			createInfo.sharingMode = VK_SHARING_MODE_EXCLUSIVE;
+
+			m_sssTileBuffer[i] = std::make_unique<Buffer>(m_memoryAllocator, createInfo, VK_MEMORY_PROPERTY_DEVICE_LOCAL_BIT, 0, MEMORY_POOL_LINEAR);
 		}
 
 		// shadow framebuffer
@@ -744,9 +969,9 @@ void sss::vulkan::RenderResources::createResizableResources(uint32_t width, uint
 	// update descriptor sets
 	for (size_t i = 0; i < FRAMES_IN_FLIGHT; ++i)
 	{
-		VkDescriptorBufferInfo bufferInfos[1];
-		VkDescriptorImageInfo imageInfos[12];
-		VkWriteDescriptorSet descriptorWrites[13];
+		VkDescriptorBufferInfo bufferInfos[3];
+		VkDescriptorImageInfo imageInfos[32];
+		VkWriteDescriptorSet descriptorWrites[44];
 		size_t bufferInfoCount = 0;
 		size_t imageInfoCount = 0;
 		size_t writeCount = 0;
@@ -782,23 +1007,41 @@ void sss::vulkan::RenderResources::createResizableResources(uint32_t width, uint
 			shadowMapWrite.pImageInfo = &shadowImageInfo;
 		}
 
-		// blur set
+		// sss tile buffer is shared by classification and all blur sets
+		auto &tileBufferInfo = bufferInfos[bufferInfoCount++];
+		tileBufferInfo.buffer = m_sssTileBuffer[i]->getBuffer();
+		tileBufferInfo.offset = 0;
+		tileBufferInfo.range = m_sssTileBuffer[i]->getSize();
+
+		// classification sets; the half res variant also downsamples diffuse0 into its own images
 		for (size_t j = 0; j < 2; ++j)
 		{
+			const bool halfRes = j == 1;
+			const VkDescriptorSet set = halfRes ? m_sssClassifyHalfResDescriptorSet[i] : m_sssClassifyDescriptorSet[i];
+
 			// input
 			auto &inputImageInfo = imageInfos[imageInfoCount++];
 			inputImageInfo.sampler = VK_NULL_HANDLE;
-			inputImageInfo.imageView = (j == 0) ? m_diffuse0Image[i]->getView() : m_diffuse1Image[i]->getView();
+			inputImageInfo.imageView = m_diffuse0Image[i]->getView();
 			inputImageInfo.imageLayout = VK_IMAGE_LAYOUT_SHADER_READ_ONLY_OPTIMAL;
 
 			auto &inputWrite = descriptorWrites[writeCount++];
 			inputWrite = { VK_STRUCTURE_TYPE_WRITE_DESCRIPTOR_SET };
-			inputWrite.dstSet = m_sssBlurDescriptorSet[i * 2 + j];
+			inputWrite.dstSet = set;
 			inputWrite.dstBinding = 0;
 			inputWrite.descriptorCount = 1;
 			inputWrite.descriptorType = VK_DESCRIPTOR_TYPE_COMBINED_IMAGE_SAMPLER;
 			inputWrite.pImageInfo = &inputImageInfo;
 
+			// tile list
+			auto &tileWrite = descriptorWrites[writeCount++];
+			tileWrite = { VK_STRUCTURE_TYPE_WRITE_DESCRIPTOR_SET };
+			tileWrite.dstSet = set;
+			tileWrite.dstBinding = 1;
+			tileWrite.descriptorCount = 1;
+			tileWrite.descriptorType = VK_DESCRIPTOR_TYPE_STORAGE_BUFFER;
+			tileWrite.pBufferInfo = &tileBufferInfo;
+
 			// depth
 			auto &depthImageInfo = imageInfos[imageInfoCount++];
 			depthImageInfo.sampler = VK_NULL_HANDLE;
@@ -807,7 +1050,82 @@ void sss::vulkan::RenderResources::createResizableResources(uint32_t width, uint
 
 			auto &depthWrite = descriptorWrites[writeCount++];
 			depthWrite = { VK_STRUCTURE_TYPE_WRITE_DESCRIPTOR_SET };
-			depthWrite.dstSet = m_sssBlurDescriptorSet[i * 2 + j];
+			depthWrite.dstSet = set;
+			depthWrite.dstBinding = 2;
+			depthWrite.descriptorCount = 1;
+			depthWrite.descriptorType = VK_DESCRIPTOR_TYPE_COMBINED_IMAGE_SAMPLER;
+			depthWrite.pImageInfo = &depthImageInfo;
+
+			// linear depth
+			auto &linearDepthImageInfo = imageInfos[imageInfoCount++];
+			linearDepthImageInfo.sampler = VK_NULL_HANDLE;
+			linearDepthImageInfo.imageView = halfRes ? m_halfResLinearDepthImage->getView() : m_linearDepthImage->getView();
+			linearDepthImageInfo.imageLayout = VK_IMAGE_LAYOUT_GENERAL;
+
+			auto &linearDepthWrite = descriptorWrites[writeCount++];
+			linearDepthWrite = { VK_STRUCTURE_TYPE_WRITE_DESCRIPTOR_SET };
+			linearDepthWrite.dstSet = set;
+			linearDepthWrite.dstBinding = 3;
+			linearDepthWrite.descriptorCount = 1;
+			linearDepthWrite.descriptorType = VK_DESCRIPTOR_TYPE_STORAGE_IMAGE;
+			linearDepthWrite.pImageInfo = &linearDepthImageInfo;
+
+			// half res diffuse
+			if (halfRes)
+			{
+				auto &halfResDiffuseImageInfo = imageInfos[imageInfoCount++];
+				halfResDiffuseImageInfo.sampler = VK_NULL_HANDLE;
+				halfResDiffuseImageInfo.imageView = m_halfResDiffuse0Image->getView();
+				halfResDiffuseImageInfo.imageLayout = VK_IMAGE_LAYOUT_GENERAL;
+
+				auto &halfResDiffuseWrite = descriptorWrites[writeCount++];
+				halfResDiffuseWrite = { VK_STRUCTURE_TYPE_WRITE_DESCRIPTOR_SET };
+				halfResDiffuseWrite.dstSet = set;
+				halfResDiffuseWrite.dstBinding = 4;
+				halfResDiffuseWrite.descriptorCount = 1;
+				halfResDiffuseWrite.descriptorType = VK_DESCRIPTOR_TYPE_STORAGE_IMAGE;
+				halfResDiffuseWrite.pImageInfo = &halfResDiffuseImageInfo;
+			}
+		}
+
+		// sss kernel buffer is shared by all blur sets
+		auto &kernelBufferInfo = bufferInfos[bufferInfoCount++];
+		kernelBufferInfo.buffer = m_sssKernelBuffer[i]->getBuffer();
+		kernelBufferInfo.offset = 0;
+		kernelBufferInfo.range = m_sssKernelBuffer[i]->getSize();
+
+		// blur sets: 2 full res passes followed by 2 half res passes
+		for (size_t j = 0; j < 4; ++j)
+		{
+			const bool halfRes = j >= 2;
+			const bool firstPass = (j & 1) == 0;
+			const VkDescriptorSet set = halfRes ? m_sssBlurHalfResDescriptorSet[i * 2 + (j & 1)] : m_sssBlurDescriptorSet[i * 2 + j];
+			Image &diffuse0Image = halfRes ? *m_halfResDiffuse0Image : *m_diffuse0Image[i];
+			Image &diffuse1Image = halfRes ? *m_halfResDiffuse1Image : *m_diffuse1Image;
+
+			// input
+			auto &inputImageInfo = imageInfos[imageInfoCount++];
+			inputImageInfo.sampler = VK_NULL_HANDLE;
+			inputImageInfo.imageView = firstPass ? diffuse0Image.getView() : diffuse1Image.getView();
+			inputImageInfo.imageLayout = VK_IMAGE_LAYOUT_SHADER_READ_ONLY_OPTIMAL;
+
+			auto &inputWrite = descriptorWrites[writeCount++];
+			inputWrite = { VK_STRUCTURE_TYPE_WRITE_DESCRIPTOR_SET };
+			inputWrite.dstSet = set;
+			inputWrite.dstBinding = 0;
+			inputWrite.descriptorCount = 1;
+			inputWrite.descriptorType = VK_DESCRIPTOR_TYPE_COMBINED_IMAGE_SAMPLER;
+			inputWrite.pImageInfo = &inputImageInfo;
+
+			// linear depth
+			auto &depthImageInfo = imageInfos[imageInfoCount++];
+			depthImageInfo.sampler = VK_NULL_HANDLE;
+			depthImageInfo.imageView = halfRes ? m_halfResLinearDepthImage->getView() : m_linearDepthImage->getView();
+			depthImageInfo.imageLayout = VK_IMAGE_LAYOUT_SHADER_READ_ONLY_OPTIMAL;
+
+			auto &depthWrite = descriptorWrites[writeCount++];
+			depthWrite = { VK_STRUCTURE_TYPE_WRITE_DESCRIPTOR_SET };
+			depthWrite.dstSet = set;
 			depthWrite.dstBinding = 1;
 			depthWrite.descriptorCount = 1;
 			depthWrite.descriptorType = VK_DESCRIPTOR_TYPE_COMBINED_IMAGE_SAMPLER;
@@ -816,16 +1134,107 @@ void sss::vulkan::RenderResources::createResizableResources(uint32_t width, uint
 			// result
 			auto &resultImageInfo = imageInfos[imageInfoCount++];
 			resultImageInfo.sampler = VK_NULL_HANDLE;
-			resultImageInfo.imageView = (j == 0) ? m_diffuse1Image[i]->getView() : m_diffuse0Image[i]->getView();
+			resultImageInfo.imageView = firstPass ? diffuse1Image.getView() : diffuse0Image.getView();
 			resultImageInfo.imageLayout = VK_IMAGE_LAYOUT_GENERAL;
 
 			auto &resultWrite = descriptorWrites[writeCount++];
 			resultWrite = { VK_STRUCTURE_TYPE_WRITE_DESCRIPTOR_SET };
-			resultWrite.dstSet = m_sssBlurDescriptorSet[i * 2 + j];
+			resultWrite.dstSet = set;
 			resultWrite.dstBinding = 2;
 			resultWrite.descriptorCount = 1;
 			resultWrite.descriptorType = VK_DESCRIPTOR_TYPE_STORAGE_IMAGE;
 			resultWrite.pImageInfo = &resultImageInfo;
+
+			// kernel
+			auto &kernelWrite = descriptorWrites[writeCount++];
+			kernelWrite = { VK_STRUCTURE_TYPE_WRITE_DESCRIPTOR_SET };
+			kernelWrite.dstSet = set;
+			kernelWrite.dstBinding = 3;
+			kernelWrite.descriptorCount = 1;
+			kernelWrite.descriptorType = VK_DESCRIPTOR_TYPE_UNIFORM_BUFFER;
+			kernelWrite.pBufferInfo = &kernelBufferInfo;
+
+			// tile list
+			auto &tileWrite = descriptorWrites[writeCount++];
+			tileWrite = { VK_STRUCTURE_TYPE_WRITE_DESCRIPTOR_SET };
+			tileWrite.dstSet = set;
+			tileWrite.dstBinding = 4;
+			tileWrite.descriptorCount = 1;
+			tileWrite.descriptorType = VK_DESCRIPTOR_TYPE_STORAGE_BUFFER;
+			tileWrite.pBufferInfo = &tileBufferInfo;
+		}
+
+		// upsample set
+		{
+			// half res diffuse
+			auto &halfResDiffuseImageInfo = imageInfos[imageInfoCount++];
+			halfResDiffuseImageInfo.sampler = VK_NULL_HANDLE;
+			halfResDiffuseImageInfo.imageView = m_halfResDiffuse0Image->getView();
+			halfResDiffuseImageInfo.imageLayout = VK_IMAGE_LAYOUT_SHADER_READ_ONLY_OPTIMAL;
+
+			auto &halfResDiffuseWrite = descriptorWrites[writeCount++];
+			halfResDiffuseWrite = { VK_STRUCTURE_TYPE_WRITE_DESCRIPTOR_SET };
+			halfResDiffuseWrite.dstSet = m_sssUpsampleDescriptorSet[i];
+			halfResDiffuseWrite.dstBinding = 0;
+			halfResDiffuseWrite.descriptorCount = 1;
+			halfResDiffuseWrite.descriptorType = VK_DESCRIPTOR_TYPE_COMBINED_IMAGE_SAMPLER;
+			halfResDiffuseWrite.pImageInfo = &halfResDiffuseImageInfo;
+
+			// half res linear depth
+			auto &halfResDepthImageInfo = imageInfos[imageInfoCount++];
+			halfResDepthImageInfo.sampler = VK_NULL_HANDLE;
+			halfResDepthImageInfo.imageView = m_halfResLinearDepthImage->getView();
+			halfResDepthImageInfo.imageLayout = VK_IMAGE_LAYOUT_SHADER_READ_ONLY_OPTIMAL;
+
+			auto &halfResDepthWrite = descriptorWrites[writeCount++];
+			halfResDepthWrite = { VK_STRUCTURE_TYPE_WRITE_DESCRIPTOR_SET };
+			halfResDepthWrite.dstSet = m_sssUpsampleDescriptorSet[i];
+			halfResDepthWrite.dstBinding = 1;
+			halfResDepthWrite.descriptorCount = 1;
+			halfResDepthWrite.descriptorType = VK_DESCRIPTOR_TYPE_COMBINED_IMAGE_SAMPLER;
+			halfResDepthWrite.pImageInfo = &halfResDepthImageInfo;
+
+			// depth
+			auto &depthImageInfo = imageInfos[imageInfoCount++];
+			depthImageInfo.sampler = VK_NULL_HANDLE;
+			depthImageInfo.imageView = m_depthImageView[i];
+			depthImageInfo.imageLayout = VK_IMAGE_LAYOUT_SHADER_READ_ONLY_OPTIMAL;
+
+			auto &depthWrite = descriptorWrites[writeCount++];
+			depthWrite = { VK_STRUCTURE_TYPE_WRITE_DESCRIPTOR_SET };
+			depthWrite.dstSet = m_sssUpsampleDescriptorSet[i];
+			depthWrite.dstBinding = 2;
+			depthWrite.descriptorCount = 1;
+			depthWrite.descriptorType = VK_DESCRIPTOR_TYPE_COMBINED_IMAGE_SAMPLER;
+			depthWrite.pImageInfo = &depthImageInfo;
+
+			// result
+			auto &resultImageInfo = imageInfos[imageInfoCount++];
+			resultImageInfo.sampler = VK_NULL_HANDLE;
+			resultImageInfo.imageView = m_diffuse0Image[i]->getView();
+			resultImageInfo.imageLayout = VK_IMAGE_LAYOUT_GENERAL;
+
+			auto &resultWrite = descriptorWrites[writeCount++];
+			resultWrite = { VK_STRUCTURE_TYPE_WRITE_DESCRIPTOR_SET };
+			resultWrite.dstSet = m_sssUpsampleDescriptorSet[i];
+			resultWrite.dstBinding = 3;
+			resultWrite.descriptorCount = 1;
+			resultWrite.descriptorType = VK_DESCRIPTOR_TYPE_STORAGE_IMAGE;
+			resultWrite.pImageInfo = &resultImageInfo;
+
+			// half res burley diffuse
+			auto &halfResBurleyImageInfo = imageInfos[imageInfoCount++];
+			halfResBurleyImageInfo.sampler = VK_NULL_HANDLE;
+			halfResBurleyImageInfo.imageView = m_halfResDiffuse1Image->getView();
+			halfResBurleyImageInfo.imageLayout = VK_IMAGE_LAYOUT_SHADER_READ_ONLY_OPTIMAL;
+
+			auto &halfResBurleyWrite = descriptorWrites[writeCount++];
+			halfResBurleyWrite = { VK_STRUCTURE_TYPE_WRITE_DESCRIPTOR_SET };
+			halfResBurleyWrite.dstSet = m_sssUpsampleDescriptorSet[i];
+			halfResBurleyWrite.dstBinding = 4;
+			halfResBurleyWrite.descriptorCount = 1;
+			halfResBurleyWrite.descriptorType = VK_DESCRIPTOR_TYPE_COMBINED_IMAGE_SAMPLER;
+			halfResBurleyWrite.pImageInfo = &halfResBurleyImageInfo;
 		}
 
 		// postprocessing set
@@ -899,14 +1308,51 @@ void sss::vulkan::RenderResources::createResizableResources(uint32_t width, uint
 			historyWrite.descriptorCount = 1;
 			historyWrite.descriptorType = VK_DESCRIPTOR_TYPE_COMBINED_IMAGE_SAMPLER;
 			historyWrite.pImageInfo = &historyImageInfo;
+
+			// diffuse1
+			auto &diffuse1ImageInfo = imageInfos[imageInfoCount++];
+			diffuse1ImageInfo.sampler = VK_NULL_HANDLE;
+			diffuse1ImageInfo.imageView = m_diffuse1Image->getView();
+			diffuse1ImageInfo.imageLayout = VK_IMAGE_LAYOUT_SHADER_READ_ONLY_OPTIMAL;
+
+			auto &diffuse1Write = descriptorWrites[writeCount++];
+			diffuse1Write = { VK_STRUCTURE_TYPE_WRITE_DESCRIPTOR_SET };
+			diffuse1Write.dstSet = m_postprocessingDescriptorSet[i];
+			diffuse1Write.dstBinding = 5;
+			diffuse1Write.descriptorCount = 1;
+			diffuse1Write.descriptorType = VK_DESCRIPTOR_TYPE_COMBINED_IMAGE_SAMPLER;
+			diffuse1Write.pImageInfo = &diffuse1ImageInfo;
+
+			// linear depth for the fused vertical sss blur
+			auto &linearDepthImageInfo = imageInfos[imageInfoCount++];
+			linearDepthImageInfo.sampler = VK_NULL_HANDLE;
+			linearDepthImageInfo.imageView = m_linearDepthImage->getView();
+			linearDepthImageInfo.imageLayout = VK_IMAGE_LAYOUT_SHADER_READ_ONLY_OPTIMAL;
+
+			auto &linearDepthWrite = descriptorWrites[writeCount++];
+			linearDepthWrite = { VK_STRUCTURE_TYPE_WRITE_DESCRIPTOR_SET };
+			linearDepthWrite.dstSet = m_postprocessingDescriptorSet[i];
+			linearDepthWrite.dstBinding = 6;
+			linearDepthWrite.descriptorCount = 1;
+			linearDepthWrite.descriptorType = VK_DESCRIPTOR_TYPE_COMBINED_IMAGE_SAMPLER;
+			linearDepthWrite.pImageInfo = &linearDepthImageInfo;
+
+			// sss kernel for the fused vertical sss blur
+			auto &kernelWrite = descriptorWrites[writeCount++];
+			kernelWrite = { VK_STRUCTURE_TYPE_WRITE_DESCRIPTOR_SET };
+			kernelWrite.dstSet = m_postprocessingDescriptorSet[i];
+			kernelWrite.dstBinding = 7;
+			kernelWrite.descriptorCount = 1;
+			kernelWrite.descriptorType = VK_DESCRIPTOR_TYPE_UNIFORM_BUFFER;
+			kernelWrite.pBufferInfo = &kernelBufferInfo;
 		}
 
 		vkUpdateDescriptorSets(m_device, static_cast<uint32_t>(sizeof(descriptorWrites) / sizeof(descriptorWrites[0])), descriptorWrites, 0, nullptr);
 	}
 
 	// gui framebuffer
-	m_guiFramebuffers.resize(m_swapChain->getImageCount());
-	for (size_t i = 0; i < m_swapChain->getImageCount(); ++i)
+	m_guiFramebuffers.resize(m_swapChain ? m_swapChain->getImageCount() : 0);
+	for (size_t i = 0; i < m_guiFramebuffers.size(); ++i)
 	{
 		VkImageView framebufferAttachment = m_swapChain->getImageView(i);
 
@@ -927,13 +1373,20 @@ void sss::vulkan::RenderResources::createResizableResources(uint32_t width, uint
 
 void sss::vulkan::RenderResources::destroyResizeableResources()
 {
+	m_diffuse1Image = nullptr;
+	m_linearDepthImage = nullptr;
+	m_halfResDiffuse0Image = nullptr;
+	m_halfResDiffuse1Image = nullptr;
+	m_halfResLinearDepthImage = nullptr;
+	m_memoryAllocator.free(m_sssImageMemory);
+
 	for (size_t i = 0; i < FRAMES_IN_FLIGHT; ++i)
 	{
 		m_depthStencilImage[i] = nullptr;
 		m_colorImage[i] = nullptr;
 		m_diffuse0Image[i] = nullptr;
-		m_diffuse1Image[i] = nullptr;
 		m_tonemappedImage[i] = nullptr;
+		m_sssTileBuffer[i] = nullptr;
 
 		vkDestroyImageView(m_device, m_depthImageView[i], nullptr);
 
@@ -941,8 +1394,9 @@ void sss::vulkan::RenderResources::destroyResizeableResources()
 		vkDestroyFramebuffer(m_device, m_mainFramebuffers[i], nullptr);
 	}
 
-	for (size_t i = 0; i < m_swapChain->getImageCount(); ++i)
+	for (size_t i = 0; i < m_guiFramebuffers.size(); ++i)
 	{
 		vkDestroyFramebuffer(m_device, m_guiFramebuffers[i], nullptr);
 	}
+	m_guiFramebuffers.clear();
 }
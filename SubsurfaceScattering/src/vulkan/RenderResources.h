@@ -15,20 +15,40 @@ namespace sss
 			SHADOW_RESOLUTION = 2048,
 		};
 
+		// per frame gpu timestamp query slots
+		enum TimestampQuery
+		{
+			TIMESTAMP_FRAME_BEGIN,
+			TIMESTAMP_SHADOW_END,
+			TIMESTAMP_MAIN_END,
+			TIMESTAMP_SSS_BEGIN,
+			TIMESTAMP_SSS_CLASSIFY_END,
+			TIMESTAMP_SSS_BURLEY_END,
+			TIMESTAMP_SSS_SEPARABLE_END,
+			TIMESTAMP_SSS_END,
+			TIMESTAMP_POSTPROCESS_END,
+			TIMESTAMP_COUNT
+		};
+
 		class SwapChain;
 
 		struct RenderResources
 		{
 		public:
 			
-			VkPhysicalDevice m_physicalDevice;
+			MemoryAllocator &m_memoryAllocator;
 			VkDevice m_device;
 			VkCommandPool m_commandPool;
-			SwapChain *m_swapChain;
+			VkCommandPool m_computeCommandPool; // same as m_commandPool without a dedicated compute queue
+			SwapChain *m_swapChain; // nullptr when rendering headless
 			VkSemaphore m_swapChainImageAvailableSemaphores[FRAMES_IN_FLIGHT];
 			VkSemaphore m_renderFinishedSemaphores[FRAMES_IN_FLIGHT];
+			VkSemaphore m_mainPassFinishedSemaphores[FRAMES_IN_FLIGHT]; // graphics -> compute queue
+			VkSemaphore m_computeFinishedSemaphores[FRAMES_IN_FLIGHT]; // compute -> graphics queue
+			VkSemaphore m_historyReleasedSemaphores[FRAMES_IN_FLIGHT]; // graphics -> compute queue of the next frame
 			VkFence m_frameFinishedFence[FRAMES_IN_FLIGHT];
 			VkCommandBuffer m_commandBuffers[FRAMES_IN_FLIGHT * 2];
+			VkCommandBuffer m_computeCommandBuffers[FRAMES_IN_FLIGHT];
 			VkRenderPass m_shadowRenderPass;
 			VkRenderPass m_mainRenderPass;
 			VkRenderPass m_guiRenderPass;
@@ -39,25 +59,46 @@ namespace sss
 			std::unique_ptr<Image> m_depthStencilImage[FRAMES_IN_FLIGHT];
 			std::unique_ptr<Image> m_colorImage[FRAMES_IN_FLIGHT];
 			std::unique_ptr<Image> m_diffuse0Image[FRAMES_IN_FLIGHT];
-			std::unique_ptr<Image> m_diffuse1Image[FRAMES_IN_FLIGHT];
+			// the sss intermediates are only used by the compute part of a frame and shared by all frames in flight
+			std::unique_ptr<Image> m_diffuse1Image;
+			std::unique_ptr<Image> m_linearDepthImage;
+			std::unique_ptr<Image> m_halfResDiffuse0Image;
+			std::unique_ptr<Image> m_halfResDiffuse1Image;
+			std::unique_ptr<Image> m_halfResLinearDepthImage;
 			std::unique_ptr<Image> m_tonemappedImage[FRAMES_IN_FLIGHT];
+			MemoryAllocator::Allocation m_sssImageMemory; // shared by diffuse1 and linear depth and the aliased half res sss images
 			std::unique_ptr<Buffer> m_constantBuffer[FRAMES_IN_FLIGHT];
+			std::unique_ptr<Buffer> m_sssKernelBuffer[FRAMES_IN_FLIGHT];
+			std::unique_ptr<Buffer> m_sssTileBuffer[FRAMES_IN_FLIGHT]; // VkDispatchIndirectCommand + list of tiles containing sss pixels
 			VkImageView m_depthImageView[FRAMES_IN_FLIGHT];
 			std::pair<VkPipeline, VkPipelineLayout> m_shadowPipeline;
 			std::pair<VkPipeline, VkPipelineLayout> m_lightingPipeline;
 			std::pair<VkPipeline, VkPipelineLayout> m_sssLightingPipeline;
 			std::pair<VkPipeline, VkPipelineLayout> m_skyboxPipeline;
+			std::pair<VkPipeline, VkPipelineLayout> m_sssClassifyPipeline;
+			std::pair<VkPipeline, VkPipelineLayout> m_sssClassifyHalfResPipeline;
 			std::pair<VkPipeline, VkPipelineLayout> m_sssBlurPipeline0;
 			std::pair<VkPipeline, VkPipelineLayout> m_sssBlurPipeline1;
+			std::pair<VkPipeline, VkPipelineLayout> m_sssBlurTiledPipeline0;
+			std::pair<VkPipeline, VkPipelineLayout> m_sssBlurTiledPipeline1;
+			std::pair<VkPipeline, VkPipelineLayout> m_sssBurleyPipeline;
+			std::pair<VkPipeline, VkPipelineLayout> m_sssUpsamplePipeline;
 			std::pair<VkPipeline, VkPipelineLayout> m_posprocessingPipeline;
+			std::pair<VkPipeline, VkPipelineLayout> m_posprocessingFusedSSSBlurPipeline;
 			VkDescriptorPool m_descriptorPool;
 			VkDescriptorSetLayout m_textureDescriptorSetLayout;
 			VkDescriptorSetLayout m_lightingDescriptorSetLayout;
+			VkDescriptorSetLayout m_sssClassifyDescriptorSetLayout;
 			VkDescriptorSetLayout m_sssBlurDescriptorSetLayout;
+			VkDescriptorSetLayout m_sssUpsampleDescriptorSetLayout;
 			VkDescriptorSetLayout m_postprocessingDescriptorSetLayout;
 			VkDescriptorSet m_textureDescriptorSet;
 			VkDescriptorSet m_lightingDescriptorSet[FRAMES_IN_FLIGHT];
+			VkDescriptorSet m_sssClassifyDescriptorSet[FRAMES_IN_FLIGHT];
+			VkDescriptorSet m_sssClassifyHalfResDescriptorSet[FRAMES_IN_FLIGHT];
 			VkDescriptorSet m_sssBlurDescriptorSet[FRAMES_IN_FLIGHT * 2]; // 2 blur passes
+			VkDescriptorSet m_sssBlurHalfResDescriptorSet[FRAMES_IN_FLIGHT * 2]; // 2 blur passes
+			VkDescriptorSet m_sssUpsampleDescriptorSet[FRAMES_IN_FLIGHT];
 			VkDescriptorSet m_postprocessingDescriptorSet[FRAMES_IN_FLIGHT];
 			VkSampler m_shadowSampler;
 			VkSampler m_linearSamplerClamp;
@@ -65,8 +106,9 @@ namespace sss
 			VkSampler m_pointSamplerClamp;
 			VkSampler m_pointSamplerRepeat;
 			VkQueryPool m_queryPool;
+			float m_pipelineCreationTime; // in ms
 
-			explicit RenderResources(VkPhysicalDevice physicalDevice, VkDevice device, VkCommandPool cmdPool, uint32_t width, uint32_t height, SwapChain *swapChain);
+			explicit RenderResources(MemoryAllocator &memoryAllocator, VkDevice device, VkPipelineCache pipelineCache, VkCommandPool cmdPool, VkCommandPool computeCmdPool, uint32_t width, uint32_t height, SwapChain *swapChain);
 			RenderResources(const RenderResources &) = delete;
 			RenderResources(const RenderResources &&) = delete;
 			RenderResources &operator= (const RenderResources &) = delete;
@@ -3,12 +3,18 @@
 #include <glm/packing.hpp>
 #include "utility/Utility.h"
 #include "VKUtility.h"
+#include "FrameGraph.h"
 #include "vulkan/Mesh.h"
 #include "vulkan/Texture.h"
+#include "pipelines/LightingPipeline.h"
 #include "imgui/imgui.h"
 #include "imgui/imgui_impl_glfw.h"
 #include "imgui/imgui_impl_vulkan.h"
 #include <glm/ext.hpp>
+#include <fstream>
+#include <cstring>
+#include <cassert>
+#include <future>
 
 static void check_vk_result(VkResult err)
 {
@@ -19,182 +25,122 @@ static void check_vk_result(VkResult err)
 		abort();
 }
 
-sss::vulkan::Renderer::Renderer(void *windowHandle, uint32_t width, uint32_t height)
-	:m_width(width),
-	m_height(height),
-	m_context(windowHandle),
-	m_swapChain(m_context.getPhysicalDevice(), m_context.getDevice(), m_context.getSurface(), m_width, m_height),
-	m_renderResources(m_context.getPhysicalDevice(), m_context.getDevice(), m_context.getGraphicsCommandPool(), m_width, m_height, &m_swapChain)
+namespace
 {
-	const char *texturePaths[] =
-	{
-		"resources/textures/head_albedo.dds",
-		"resources/textures/head_normal.dds",
-		"resources/textures/head_gloss.dds",
-		"resources/textures/head_specular.dds",
-		"resources/textures/head_cavity.dds",
-		"resources/textures/head_detail_normal.dds",
-		"resources/textures/jacket_albedo.dds",
-		"resources/textures/jacket_normal.dds",
-		"resources/textures/jacket_gloss.dds",
-		"resources/textures/jacket_specular.dds",
-	};
-
-	for (const auto &path : texturePaths)
+	// assets are decoded on worker threads, which hand their data to the upload manager. the copies are batched and
+	// overlap with decoding of the remaining files. path must stay valid until the returned future is ready
+	std::future<std::shared_ptr<sss::vulkan::Texture>> loadTextureAsync(sss::vulkan::MemoryAllocator &allocator, VkDevice device, sss::vulkan::UploadManager &uploadManager, const char *path, bool cube)
 	{
-		m_textures.push_back(Texture::load(m_context.getPhysicalDevice(), m_context.getDevice(), m_context.getGraphicsQueue(), m_context.getGraphicsCommandPool(), path));
+		return std::async(std::launch::async, [&allocator, device, &uploadManager, path, cube]() { return sss::vulkan::Texture::load(allocator, device, uploadManager, path, cube); });
 	}
+}
 
-	m_skyboxTexture = Texture::load(m_context.getPhysicalDevice(), m_context.getDevice(), m_context.getGraphicsQueue(), m_context.getGraphicsCommandPool(), "resources/textures/skybox.dds", true);
-	m_radianceTexture = Texture::load(m_context.getPhysicalDevice(), m_context.getDevice(), m_context.getGraphicsQueue(), m_context.getGraphicsCommandPool(), "resources/textures/prefilterMap.dds", true);
-	m_irradianceTexture = Texture::load(m_context.getPhysicalDevice(), m_context.getDevice(), m_context.getGraphicsQueue(), m_context.getGraphicsCommandPool(), "resources/textures/irradianceMap.dds", true);
-	m_brdfLUT = Texture::load(m_context.getPhysicalDevice(), m_context.getDevice(), m_context.getGraphicsQueue(), m_context.getGraphicsCommandPool(), "resources/textures/brdfLut.dds");
+sss::vulkan::Renderer::Renderer(void *windowHandle, uint32_t width, uint32_t height, bool asyncCompute, const scene::Scene &scene)
+	:m_shadowPassTime(),
+	m_mainPassTime(),
+	m_sssTime(),
+	m_sssSeparableTime(),
+	m_sssBurleyTime(),
+	m_postprocessTime(),
+	m_width(width),
+	m_height(height),
+	m_context(windowHandle),
+	m_asyncCompute(asyncCompute && m_context.hasDedicatedComputeQueue()),
+	m_swapChain(m_context.isHeadless() ? nullptr : std::make_unique<SwapChain>(m_context.getPhysicalDevice(), m_context.getDevice(), m_context.getSurface(), m_width, m_height)),
+	m_renderResources(m_context.getMemoryAllocator(), m_context.getDevice(), m_context.getPipelineCache().get(), m_context.getGraphicsCommandPool(), m_context.getComputeCommandPool(), m_width, m_height, m_swapChain.get()),
+	m_uploadManager(m_context.getMemoryAllocator(), m_context.getDevice(), m_context.getTransferQueue(), m_context.getTransferQueueFamilyIndex(),
+		m_context.getGraphicsQueue(), m_context.getGraphicsQueueFamilyIndex(), m_context.getGraphicsCommandPool())
+{
+	auto skyboxTextureLoad = loadTextureAsync(m_context.getMemoryAllocator(), m_context.getDevice(), m_uploadManager, "resources/textures/skybox.dds", true);
+	auto radianceTextureLoad = loadTextureAsync(m_context.getMemoryAllocator(), m_context.getDevice(), m_uploadManager, "resources/textures/prefilterMap.dds", true);
+	auto irradianceTextureLoad = loadTextureAsync(m_context.getMemoryAllocator(), m_context.getDevice(), m_uploadManager, "resources/textures/irradianceMap.dds", true);
+	auto brdfLUTLoad = loadTextureAsync(m_context.getMemoryAllocator(), m_context.getDevice(), m_uploadManager, "resources/textures/brdfLut.dds", false);
 
-	// load meshes
-	{
-		Material headMaterial;
-		headMaterial.gloss = 0.638f;
-		headMaterial.specular = 0.097f;
-		headMaterial.detailNormalScale = 130.0f;
-		headMaterial.albedo = 0xFFFFFFFF;
-		headMaterial.albedoTexture = 1;
-		headMaterial.normalTexture = 2;
-		headMaterial.glossTexture = 3;
-		headMaterial.specularTexture = 4;
-		headMaterial.cavityTexture = 5;
-		headMaterial.detailNormalTexture = 6;
-
-		Material jacketMaterial;
-		jacketMaterial.gloss = 0.376f;
-		jacketMaterial.specular = 0.162f;
-		jacketMaterial.detailNormalScale = 0.0f;
-		jacketMaterial.albedo = 0xFFFFFFFF;
-		jacketMaterial.albedoTexture = 7;
-		jacketMaterial.normalTexture = 8;
-		jacketMaterial.glossTexture = 9;
-		jacketMaterial.specularTexture = 10;
-		jacketMaterial.cavityTexture = 0;
-		jacketMaterial.detailNormalTexture = 0;
-
-		Material browsMaterial;
-		browsMaterial.gloss = 0.0f;
-		browsMaterial.specular = 0.007f;
-		browsMaterial.detailNormalScale = 0.0f;
-		browsMaterial.albedo = glm::packUnorm4x8(glm::vec4(50.0f, 36.0f, 26.0f, 255.0f) / 255.0f);
-		browsMaterial.albedoTexture = 0;
-		browsMaterial.normalTexture = 0;
-		browsMaterial.glossTexture = 0;
-		browsMaterial.specularTexture = 0;
-		browsMaterial.cavityTexture = 0;
-		browsMaterial.detailNormalTexture = 0;
-
-		Material eyelashesMaterial;
-		eyelashesMaterial.gloss = 0.43f;
-		eyelashesMaterial.specular = 0.162f;
-		eyelashesMaterial.detailNormalScale = 0.0f;
-		eyelashesMaterial.albedo = glm::packUnorm4x8(glm::vec4(4.0f, 4.0f, 4.0f, 255.0f) / 255.0f);
-		eyelashesMaterial.albedoTexture = 0;
-		eyelashesMaterial.normalTexture = 0;
-		eyelashesMaterial.glossTexture = 0;
-		eyelashesMaterial.specularTexture = 0;
-		eyelashesMaterial.cavityTexture = 0;
-		eyelashesMaterial.detailNormalTexture = 0;
-
-		std::pair<Material, bool> materials[] = { {headMaterial, true}, {jacketMaterial, false}, { browsMaterial, false }, { eyelashesMaterial, false } };
-		const char *meshPaths[] = { "resources/meshes/head.mesh", "resources/meshes/jacket.mesh", "resources/meshes/brows.mesh", "resources/meshes/eyelashes.mesh" };
-
-		for (size_t i = 0; i < sizeof(meshPaths) / sizeof(meshPaths[0]); ++i)
-		{
-			m_meshes.push_back(Mesh::load(m_context.getPhysicalDevice(), m_context.getDevice(), m_context.getGraphicsQueue(), m_context.getGraphicsCommandPool(), meshPaths[i]));
-			m_materials.push_back(materials[i]);
-		}
-	}
+	loadSceneAssets(scene);
+
+	m_skyboxTexture = skyboxTextureLoad.get();
+	m_radianceTexture = radianceTextureLoad.get();
+	m_irradianceTexture = irradianceTextureLoad.get();
+	m_brdfLUT = brdfLUTLoad.get();
 
-	const size_t textureCount = sizeof(texturePaths) / sizeof(texturePaths[0]);
+	// wait for all copies and hand the resources over to the graphics queue
+	m_uploadManager.flush();
 
-	// update texture descriptor set
+	// update descriptors of the environment maps; the scene textures are written by updateSceneDescriptors()
 	{
-		VkDescriptorImageInfo textureImageInfos[textureCount + 4];
+		VkDescriptorImageInfo textureImageInfos[4];
 		{
-			for (size_t i = 0; i < textureCount; ++i)
-			{
-				auto &textureImageInfo = textureImageInfos[i];
-				textureImageInfo.sampler = m_renderResources.m_linearSamplerRepeat;
-				textureImageInfo.imageView = m_textures[i]->getView();
-				textureImageInfo.imageLayout = VK_IMAGE_LAYOUT_SHADER_READ_ONLY_OPTIMAL;
-			}
-
-			auto &brdfLutImageInfo = textureImageInfos[textureCount];
+			auto &brdfLutImageInfo = textureImageInfos[0];
 			brdfLutImageInfo.sampler = VK_NULL_HANDLE;
 			brdfLutImageInfo.imageView = m_brdfLUT->getView();
 			brdfLutImageInfo.imageLayout = VK_IMAGE_LAYOUT_SHADER_READ_ONLY_OPTIMAL;
 
-			auto &radianceTexImageInfo = textureImageInfos[textureCount + 1];
+			auto &radianceTexImageInfo = textureImageInfos[1];
 			radianceTexImageInfo.sampler = VK_NULL_HANDLE;
 			radianceTexImageInfo.imageView = m_radianceTexture->getView();
 			radianceTexImageInfo.imageLayout = VK_IMAGE_LAYOUT_SHADER_READ_ONLY_OPTIMAL;
 
-			auto &irradianceTexImageInfo = textureImageInfos[textureCount + 2];
+			auto &irradianceTexImageInfo = textureImageInfos[2];
 			irradianceTexImageInfo.sampler = VK_NULL_HANDLE;
 			irradianceTexImageInfo.imageView = m_irradianceTexture->getView();
 			irradianceTexImageInfo.imageLayout = VK_IMAGE_LAYOUT_SHADER_READ_ONLY_OPTIMAL;
 
-			auto &skyboxTexImageInfo = textureImageInfos[textureCount + 3];
+			auto &skyboxTexImageInfo = textureImageInfos[3];
 			skyboxTexImageInfo.sampler = VK_NULL_HANDLE;
 			skyboxTexImageInfo.imageView = m_skyboxTexture->getView();
 			skyboxTexImageInfo.imageLayout = VK_IMAGE_LAYOUT_SHADER_READ_ONLY_OPTIMAL;
 		}
 
-		VkWriteDescriptorSet descriptorWrites[5];
+		VkWriteDescriptorSet descriptorWrites[4];
 		{
-			auto &textureWrite = descriptorWrites[0];
-			textureWrite = { VK_STRUCTURE_TYPE_WRITE_DESCRIPTOR_SET };
-			textureWrite.dstSet = m_renderResources.m_textureDescriptorSet;
-			textureWrite.dstBinding = 0;
-			textureWrite.descriptorCount = textureCount;
-			textureWrite.descriptorType = VK_DESCRIPTOR_TYPE_COMBINED_IMAGE_SAMPLER;
-			textureWrite.pImageInfo = textureImageInfos;
-
-			auto &brdfLutWrite = descriptorWrites[1];
+			auto &brdfLutWrite = descriptorWrites[0];
 			brdfLutWrite = { VK_STRUCTURE_TYPE_WRITE_DESCRIPTOR_SET };
 			brdfLutWrite.dstSet = m_renderResources.m_textureDescriptorSet;
 			brdfLutWrite.dstBinding = 1;
 			brdfLutWrite.descriptorCount = 1;
 			brdfLutWrite.descriptorType = VK_DESCRIPTOR_TYPE_COMBINED_IMAGE_SAMPLER;
-			brdfLutWrite.pImageInfo = &textureImageInfos[textureCount];
+			brdfLutWrite.pImageInfo = &textureImageInfos[0];
 
-			auto &radianceTexWrite = descriptorWrites[2];
+			auto &radianceTexWrite = descriptorWrites[1];
 			radianceTexWrite = { VK_STRUCTURE_TYPE_WRITE_DESCRIPTOR_SET };
 			radianceTexWrite.dstSet = m_renderResources.m_textureDescriptorSet;
 			radianceTexWrite.dstBinding = 2;
 			radianceTexWrite.descriptorCount = 1;
 			radianceTexWrite.descriptorType = VK_DESCRIPTOR_TYPE_COMBINED_IMAGE_SAMPLER;
-			radianceTexWrite.pImageInfo = &textureImageInfos[textureCount + 1];
+			radianceTexWrite.pImageInfo = &textureImageInfos[1];
 
-			auto &irradianceTexWrite = descriptorWrites[3];
+			auto &irradianceTexWrite = descriptorWrites[2];
 			irradianceTexWrite = { VK_STRUCTURE_TYPE_WRITE_DESCRIPTOR_SET };
 			irradianceTexWrite.dstSet = m_renderResources.m_textureDescriptorSet;
 			irradianceTexWrite.dstBinding = 3;
 			irradianceTexWrite.descriptorCount = 1;
 			irradianceTexWrite.descriptorType = VK_DESCRIPTOR_TYPE_COMBINED_IMAGE_SAMPLER;
-			irradianceTexWrite.pImageInfo = &textureImageInfos[textureCount + 2];
+			irradianceTexWrite.pImageInfo = &textureImageInfos[2];
 
-			auto &skyboxTexWrite = descriptorWrites[4];
+			auto &skyboxTexWrite = descriptorWrites[3];
 			skyboxTexWrite = { VK_STRUCTURE_TYPE_WRITE_DESCRIPTOR_SET };
 			skyboxTexWrite.dstSet = m_renderResources.m_textureDescriptorSet;
 			skyboxTexWrite.dstBinding = 4;
 			skyboxTexWrite.descriptorCount = 1;
 			skyboxTexWrite.descriptorType = VK_DESCRIPTOR_TYPE_COMBINED_IMAGE_SAMPLER;
-			skyboxTexWrite.pImageInfo = &textureImageInfos[textureCount + 3];
+			skyboxTexWrite.pImageInfo = &textureImageInfos[3];
 		}
 
 		vkUpdateDescriptorSets(m_context.getDevice(), static_cast<uint32_t>(sizeof(descriptorWrites) / sizeof(descriptorWrites[0])), descriptorWrites, 0, nullptr);
 	}
 
+	updateSceneDescriptors();
+
 	// transition tonemapped output image to VK_IMAGE_LAYOUT_SHADER_READ_ONLY_OPTIMAL to be used as taa input
 	transitionHistoryImages();
 
+	for (uint32_t i = 0; i < SSSKernel::MAX_PROFILE_COUNT; ++i)
+	{
+		setSSSProfile(i, SSSKernel::MAX_SAMPLE_COUNT, 0.01f, glm::vec3(0.48f, 0.41f, 0.28f), glm::vec3(1.0f, 0.37f, 0.3f));
+	}
+
 	// imgui
+	if (!m_context.isHeadless())
 	{
 		// Setup Dear ImGui context
 		IMGUI_CHECKVERSION();
@@ -215,11 +161,11 @@ sss::vulkan::Renderer::Renderer(void *windowHandle, uint32_t width, uint32_t hei
 		init_info.Device = m_context.getDevice();
 		init_info.QueueFamily = m_context.getGraphicsQueueFamilyIndex();
 		init_info.Queue = m_context.getGraphicsQueue();
-		init_info.PipelineCache = VK_NULL_HANDLE;
+		init_info.PipelineCache = m_context.getPipelineCache().get();
 		init_info.DescriptorPool = m_renderResources.m_descriptorPool;
 		init_info.Allocator = nullptr;
-		init_info.MinImageCount = static_cast<uint32_t>(m_swapChain.getImageCount());
-		init_info.ImageCount = static_cast<uint32_t>(m_swapChain.getImageCount());
+		init_info.MinImageCount = static_cast<uint32_t>(m_swapChain->getImageCount());
+		init_info.ImageCount = static_cast<uint32_t>(m_swapChain->getImageCount());
 		init_info.CheckVkResultFn = check_vk_result;
 		ImGui_ImplVulkan_Init(&init_info, m_renderResources.m_guiRenderPass);
 
@@ -255,10 +201,32 @@ sss::vulkan::Renderer::Renderer(void *windowHandle, uint32_t width, uint32_t hei
 
 sss::vulkan::Renderer::~Renderer()
 {
+	retirePendingPresent();
 	vkDeviceWaitIdle(m_context.getDevice());
-	ImGui_ImplVulkan_Shutdown();
-	ImGui_ImplGlfw_Shutdown();
-	ImGui::DestroyContext();
+	if (!m_context.isHeadless())
+	{
+		ImGui_ImplVulkan_Shutdown();
+		ImGui_ImplGlfw_Shutdown();
+		ImGui::DestroyContext();
+	}
+}
+
+void sss::vulkan::Renderer::loadScene(const scene::Scene &scene)
+{
+	retirePendingPresent();
+	vkDeviceWaitIdle(m_context.getDevice());
+
+	// with async compute, the retired present leaves the taa history released by the compute queue but never acquired
+	transitionHistoryImages();
+
+	// release the previous assets first, so that their memory can be reused
+	m_textures.clear();
+	m_mesh.reset();
+	m_materials.clear();
+
+	loadSceneAssets(scene);
+	m_uploadManager.flush();
+	updateSceneDescriptors();
 }
 
 void sss::vulkan::Renderer::render(const glm::mat4 &viewProjection, 
@@ -267,9 +235,15 @@ void sss::vulkan::Renderer::render(const glm::mat4 &viewProjection,
 	const glm::vec4 &lightColorInvSqrAttRadius, 
 	const glm::vec4 &cameraPosition, 
 	bool subsurfaceScatteringEnabled,
-	float sssWidth,
+	bool sssHalfResolution,
+	SSSMode sssMode,
+	uint32_t burleySampleCount,
+	bool tiledBlur,
+	bool fusedSSSBlur,
 	bool taaEnabled,
-	float fovy)
+	float fovy,
+	float nearPlane,
+	float farPlane)
 {
 	RenderResources &rr = m_renderResources;
 	uint32_t resourceIndex = m_frameIndex % FRAMES_IN_FLIGHT;
@@ -281,15 +255,21 @@ void sss::vulkan::Renderer::render(const glm::mat4 &viewProjection,
 	vkWaitForFences(m_context.getDevice(), 1, &rr.m_frameFinishedFence[resourceIndex], VK_TRUE, std::numeric_limits<uint64_t>::max());
 	vkResetFences(m_context.getDevice(), 1, &rr.m_frameFinishedFence[resourceIndex]);
 
-	// retrieve gpu timestamp queries of sss passes
+	// retrieve gpu timestamp queries of all passes
 	if (m_frameIndex >= FRAMES_IN_FLIGHT)
 	{
-		uint64_t data[2];
-		if (vkGetQueryPoolResults(m_context.getDevice(), rr.m_queryPool, resourceIndex, 2, sizeof(data), data, sizeof(data[0]), VK_QUERY_RESULT_64_BIT | VK_QUERY_RESULT_WAIT_BIT) != VK_SUCCESS)
+		uint64_t data[TIMESTAMP_COUNT];
+		if (vkGetQueryPoolResults(m_context.getDevice(), rr.m_queryPool, resourceIndex * TIMESTAMP_COUNT, TIMESTAMP_COUNT, sizeof(data), data, sizeof(data[0]), VK_QUERY_RESULT_64_BIT | VK_QUERY_RESULT_WAIT_BIT) != VK_SUCCESS)
 		{
 			util::fatalExit("Failed to rerieve gpu timestamp queries!", EXIT_FAILURE);
 		}
-		m_sssTime = static_cast<float>((data[1] - data[0]) * (m_context.getDeviceProperties().limits.timestampPeriod * (1.0 / 1e6)));
+		const double period = m_context.getDeviceProperties().limits.timestampPeriod * (1.0 / 1e6);
+		m_shadowPassTime = static_cast<float>((data[TIMESTAMP_SHADOW_END] - data[TIMESTAMP_FRAME_BEGIN]) * period);
+		m_mainPassTime = static_cast<float>((data[TIMESTAMP_MAIN_END] - data[TIMESTAMP_SHADOW_END]) * period);
+		m_sssTime = static_cast<float>((data[TIMESTAMP_SSS_END] - data[TIMESTAMP_SSS_BEGIN]) * period);
+		m_sssBurleyTime = static_cast<float>((data[TIMESTAMP_SSS_BURLEY_END] - data[TIMESTAMP_SSS_CLASSIFY_END]) * period);
+		m_sssSeparableTime = static_cast<float>((data[TIMESTAMP_SSS_SEPARABLE_END] - data[TIMESTAMP_SSS_BURLEY_END]) * period);
+		m_postprocessTime = static_cast<float>((data[TIMESTAMP_POSTPROCESS_END] - data[TIMESTAMP_SSS_END]) * period);
 	}
 
 	// update constant buffer content
@@ -300,19 +280,28 @@ void sss::vulkan::Renderer::render(const glm::mat4 &viewProjection,
 	((glm::vec4 *)mappedPtr)[9] = lightColorInvSqrAttRadius;
 	((glm::vec4 *)mappedPtr)[10] = cameraPosition;
 
+	// update sss profile buffer content
+	memcpy(rr.m_sssKernelBuffer[resourceIndex]->map(), m_sssProfiles, sizeof(m_sssProfiles));
+
 	// command buffer for the first half of the frame...
 	vkResetCommandBuffer(rr.m_commandBuffers[resourceIndex * 2], 0);
 	// ... and for the second half
 	vkResetCommandBuffer(rr.m_commandBuffers[resourceIndex * 2 + 1], 0);
+	// ... and for the part running on the compute queue
+	vkResetCommandBuffer(rr.m_computeCommandBuffers[resourceIndex], 0);
 
 	VkCommandBufferBeginInfo beginInfo{ VK_STRUCTURE_TYPE_COMMAND_BUFFER_BEGIN_INFO };
 	beginInfo.flags = VK_COMMAND_BUFFER_USAGE_ONE_TIME_SUBMIT_BIT;
 
 	VkCommandBuffer curCmdBuf = rr.m_commandBuffers[resourceIndex * 2];
+	const uint32_t queryOffset = resourceIndex * TIMESTAMP_COUNT;
 
 	// swapchain image independent part of the frame
 	vkBeginCommandBuffer(curCmdBuf, &beginInfo);
 	{
+		vkCmdResetQueryPool(curCmdBuf, rr.m_queryPool, queryOffset, TIMESTAMP_COUNT);
+		vkCmdWriteTimestamp(curCmdBuf, VK_PIPELINE_STAGE_TOP_OF_PIPE_BIT, rr.m_queryPool, queryOffset + TIMESTAMP_FRAME_BEGIN);
+
 		// shadow renderpass
 		{
 			VkClearValue clearValue;
@@ -342,23 +331,37 @@ void sss::vulkan::Renderer::render(const glm::mat4 &viewProjection,
 				vkCmdSetViewport(curCmdBuf, 0, 1, &viewport);
 				vkCmdSetScissor(curCmdBuf, 0, 1, &scissor);
 
-				for (const auto &submesh : m_meshes)
+				// the shadow pass does not care about materials, so all submeshes are drawn at once
 				{
-					vkCmdBindIndexBuffer(curCmdBuf, submesh->getIndexBuffer(), 0, VK_INDEX_TYPE_UINT32);
+					vkCmdBindIndexBuffer(curCmdBuf, m_mesh->getIndexBuffer(), 0, m_mesh->getIndexType());
 
-					VkBuffer vertexBuffer = submesh->getVertexBuffer();
+					VkBuffer vertexBuffer = m_mesh->getVertexBuffer();
 					VkDeviceSize vertexBufferOffset = 0;
 
 					vkCmdBindVertexBuffers(curCmdBuf, 0, 1, &vertexBuffer, &vertexBufferOffset);
 
-					vkCmdPushConstants(curCmdBuf, rr.m_shadowPipeline.second, VK_SHADER_STAGE_VERTEX_BIT, 0, sizeof(shadowMatrix), &shadowMatrix);
+					struct PushConsts
+					{
+						glm::mat4 shadowMatrix;
+						glm::vec4 positionScale;
+						glm::vec4 positionBias;
+					};
+
+					PushConsts pushConsts;
+					pushConsts.shadowMatrix = shadowMatrix;
+					pushConsts.positionScale = glm::vec4(m_mesh->getPositionScale(), 0.0f);
+					pushConsts.positionBias = glm::vec4(m_mesh->getPositionBias(), 0.0f);
 
-					vkCmdDrawIndexed(curCmdBuf, submesh->getIndexCount(), 1, 0, 0, 0);
+					vkCmdPushConstants(curCmdBuf, rr.m_shadowPipeline.second, VK_SHADER_STAGE_VERTEX_BIT, 0, sizeof(pushConsts), &pushConsts);
+
+					vkCmdDrawIndexed(curCmdBuf, m_mesh->getIndexCount(), 1, 0, 0, 0);
 				}
 			}
 			vkCmdEndRenderPass(curCmdBuf);
 		}
 
+		vkCmdWriteTimestamp(curCmdBuf, VK_PIPELINE_STAGE_BOTTOM_OF_PIPE_BIT, rr.m_queryPool, queryOffset + TIMESTAMP_SHADOW_END);
+
 		// main renderpass
 		{
 			VkClearValue clearValues[3];
@@ -403,29 +406,33 @@ void sss::vulkan::Renderer::render(const glm::mat4 &viewProjection,
 				vkCmdSetScissor(curCmdBuf, 0, 1, &scissor);
 
 
-				for (size_t i = 0; i < m_meshes.size(); ++i)
+				vkCmdBindIndexBuffer(curCmdBuf, m_mesh->getIndexBuffer(), 0, m_mesh->getIndexType());
+
+				VkBuffer vertexBuffer = m_mesh->getVertexBuffer();
+				VkBuffer vertexBuffers[] = { vertexBuffer, vertexBuffer, vertexBuffer, vertexBuffer };
+				VkDeviceSize vertexBufferOffsets[Mesh::VERTEX_STREAM_COUNT];
+				m_mesh->getVertexBufferOffsets(vertexBufferOffsets);
+
+				vkCmdBindVertexBuffers(curCmdBuf, 0, Mesh::VERTEX_STREAM_COUNT, vertexBuffers, vertexBufferOffsets);
+
+				const glm::vec4 positionDequantization[] = { glm::vec4(m_mesh->getPositionScale(), 0.0f), glm::vec4(m_mesh->getPositionBias(), 0.0f) };
+				vkCmdPushConstants(curCmdBuf, rr.m_lightingPipeline.second, VK_SHADER_STAGE_VERTEX_BIT, LightingPipeline::VERTEX_PUSH_CONSTANT_OFFSET, sizeof(positionDequantization), positionDequantization);
+
+				const auto &submeshes = m_mesh->getSubmeshes();
+				for (size_t i = 0; i < submeshes.size(); ++i)
 				{
-					const auto &submesh = m_meshes[i];
+					const auto &submesh = submeshes[i];
 					const auto &material = m_materials[i];
 
-					// test if mesh is supposed to be rendered without SSS
+					// test if submesh is supposed to be rendered without SSS
 					if (material.second)
 					{
 						continue;
 					}
 
-					vkCmdBindIndexBuffer(curCmdBuf, submesh->getIndexBuffer(), 0, VK_INDEX_TYPE_UINT32);
-
-					VkBuffer vertexBuffer = submesh->getVertexBuffer();
-					uint32_t vertexCount = submesh->getVertexCount();
-					VkBuffer vertexBuffers[] = { vertexBuffer, vertexBuffer, vertexBuffer };
-					VkDeviceSize vertexBufferOffsets[] = { 0, vertexCount * sizeof(float) * 3, vertexCount * sizeof(float) * 6 };
-
-					vkCmdBindVertexBuffers(curCmdBuf, 0, 3, vertexBuffers, vertexBufferOffsets);
-
 					vkCmdPushConstants(curCmdBuf, rr.m_lightingPipeline.second, VK_SHADER_STAGE_FRAGMENT_BIT, 0, sizeof(material.first), &material.first);
 
-					vkCmdDrawIndexed(curCmdBuf, submesh->getIndexCount(), 1, 0, 0, 0);
+					vkCmdDrawIndexed(curCmdBuf, submesh.indexCount, 1, submesh.firstIndex, 0, 0);
 				}
 			}
 
@@ -445,29 +452,33 @@ void sss::vulkan::Renderer::render(const glm::mat4 &viewProjection,
 				vkCmdSetScissor(curCmdBuf, 0, 1, &scissor);
 
 
-				for (size_t i = 0; i < m_meshes.size(); ++i)
+				vkCmdBindIndexBuffer(curCmdBuf, m_mesh->getIndexBuffer(), 0, m_mesh->getIndexType());
+
+				VkBuffer vertexBuffer = m_mesh->getVertexBuffer();
+				VkBuffer vertexBuffers[] = { vertexBuffer, vertexBuffer, vertexBuffer, vertexBuffer };
+				VkDeviceSize vertexBufferOffsets[Mesh::VERTEX_STREAM_COUNT];
+				m_mesh->getVertexBufferOffsets(vertexBufferOffsets);
+
+				vkCmdBindVertexBuffers(curCmdBuf, 0, Mesh::VERTEX_STREAM_COUNT, vertexBuffers, vertexBufferOffsets);
+
+				const glm::vec4 positionDequantization[] = { glm::vec4(m_mesh->getPositionScale(), 0.0f), glm::vec4(m_mesh->getPositionBias(), 0.0f) };
+				vkCmdPushConstants(curCmdBuf, rr.m_sssLightingPipeline.second, VK_SHADER_STAGE_VERTEX_BIT, LightingPipeline::VERTEX_PUSH_CONSTANT_OFFSET, sizeof(positionDequantization), positionDequantization);
+
+				const auto &submeshes = m_mesh->getSubmeshes();
+				for (size_t i = 0; i < submeshes.size(); ++i)
 				{
-					const auto &submesh = m_meshes[i];
+					const auto &submesh = submeshes[i];
 					const auto &material = m_materials[i];
 
-					// test if mesh is supposed to be rendered with SSS
+					// test if submesh is supposed to be rendered with SSS
 					if (!material.second)
 					{
 						continue;
 					}
 
-					vkCmdBindIndexBuffer(curCmdBuf, submesh->getIndexBuffer(), 0, VK_INDEX_TYPE_UINT32);
-
-					VkBuffer vertexBuffer = submesh->getVertexBuffer();
-					uint32_t vertexCount = submesh->getVertexCount();
-					VkBuffer vertexBuffers[] = { vertexBuffer, vertexBuffer, vertexBuffer };
-					VkDeviceSize vertexBufferOffsets[] = { 0, vertexCount * sizeof(float) * 3, vertexCount * sizeof(float) * 6 };
-
-					vkCmdBindVertexBuffers(curCmdBuf, 0, 3, vertexBuffers, vertexBufferOffsets);
-
 					vkCmdPushConstants(curCmdBuf, rr.m_sssLightingPipeline.second, VK_SHADER_STAGE_FRAGMENT_BIT, 0, sizeof(material.first), &material.first);
 
-					vkCmdDrawIndexed(curCmdBuf, submesh->getIndexCount(), 1, 0, 0, 0);
+					vkCmdDrawIndexed(curCmdBuf, submesh.indexCount, 1, submesh.firstIndex, 0, 0);
 				}
 			}
 
@@ -494,140 +505,345 @@ void sss::vulkan::Renderer::render(const glm::mat4 &viewProjection,
 			vkCmdEndRenderPass(curCmdBuf);
 		}
 
-		vkCmdResetQueryPool(curCmdBuf, rr.m_queryPool, resourceIndex, 2);
-		vkCmdWriteTimestamp(curCmdBuf, VK_PIPELINE_STAGE_BOTTOM_OF_PIPE_BIT, rr.m_queryPool, resourceIndex);
+		vkCmdWriteTimestamp(curCmdBuf, VK_PIPELINE_STAGE_BOTTOM_OF_PIPE_BIT, rr.m_queryPool, queryOffset + TIMESTAMP_MAIN_END);
+
+		// with async compute the rest of the frame runs on the compute queue, overlapping with the shadow and main passes of the
+		// next frame on this queue. the main pass results change ownership and recording continues in the compute command buffer
+		if (m_asyncCompute)
+		{
+			const VkImage images[] = { rr.m_depthStencilImage[resourceIndex]->getImage(), rr.m_colorImage[resourceIndex]->getImage(), rr.m_diffuse0Image[resourceIndex]->getImage() };
+
+			VkImageMemoryBarrier imageBarriers[4];
+			for (size_t i = 0; i < 3; ++i)
+			{
+				imageBarriers[i] = { VK_STRUCTURE_TYPE_IMAGE_MEMORY_BARRIER };
+				imageBarriers[i].srcAccessMask = i == 0 ? VK_ACCESS_DEPTH_STENCIL_ATTACHMENT_WRITE_BIT : VK_ACCESS_COLOR_ATTACHMENT_WRITE_BIT;
+				imageBarriers[i].dstAccessMask = 0;
+				imageBarriers[i].oldLayout = VK_IMAGE_LAYOUT_SHADER_READ_ONLY_OPTIMAL;
+				imageBarriers[i].newLayout = VK_IMAGE_LAYOUT_SHADER_READ_ONLY_OPTIMAL;
+				imageBarriers[i].srcQueueFamilyIndex = m_context.getGraphicsQueueFamilyIndex();
+				imageBarriers[i].dstQueueFamilyIndex = m_context.getComputeQueueFamilyIndex();
+				imageBarriers[i].image = images[i];
+				imageBarriers[i].subresourceRange = { i == 0 ? VkImageAspectFlags(VK_IMAGE_ASPECT_DEPTH_BIT | VK_IMAGE_ASPECT_STENCIL_BIT) : VkImageAspectFlags(VK_IMAGE_ASPECT_COLOR_BIT), 0, 1, 0, 1 };
+			}
+
+			// release to the compute queue
+			vkCmdPipelineBarrier(curCmdBuf, VK_PIPELINE_STAGE_COLOR_ATTACHMENT_OUTPUT_BIT | VK_PIPELINE_STAGE_LATE_FRAGMENT_TESTS_BIT, VK_PIPELINE_STAGE_BOTTOM_OF_PIPE_BIT, 0, 0, nullptr, 0, nullptr, 3, imageBarriers);
+
+			vkEndCommandBuffer(curCmdBuf);
+
+			VkSubmitInfo submitInfo{ VK_STRUCTURE_TYPE_SUBMIT_INFO };
+			submitInfo.commandBufferCount = 1;
+			submitInfo.pCommandBuffers = &curCmdBuf;
+			submitInfo.signalSemaphoreCount = 1;
+			submitInfo.pSignalSemaphores = &rr.m_mainPassFinishedSemaphores[resourceIndex];
+
+			if (vkQueueSubmit(m_context.getGraphicsQueue(), 1, &submitInfo, VK_NULL_HANDLE) != VK_SUCCESS)
+			{
+				util::fatalExit("Failed to submit to queue!", EXIT_FAILURE);
+			}
+
+			curCmdBuf = rr.m_computeCommandBuffers[resourceIndex];
+			vkBeginCommandBuffer(curCmdBuf, &beginInfo);
+
+			// acquire on the compute queue
+			for (size_t i = 0; i < 3; ++i)
+			{
+				imageBarriers[i].srcAccessMask = 0;
+				imageBarriers[i].dstAccessMask = VK_ACCESS_SHADER_READ_BIT;
+			}
+
+			// the taa history was handed to the graphics queue for presenting the previous frame and is released back by it
+			imageBarriers[3] = { VK_STRUCTURE_TYPE_IMAGE_MEMORY_BARRIER };
+			imageBarriers[3].srcAccessMask = 0;
+			imageBarriers[3].dstAccessMask = VK_ACCESS_SHADER_READ_BIT;
+			imageBarriers[3].oldLayout = VK_IMAGE_LAYOUT_TRANSFER_SRC_OPTIMAL;
+			imageBarriers[3].newLayout = VK_IMAGE_LAYOUT_SHADER_READ_ONLY_OPTIMAL;
+			imageBarriers[3].srcQueueFamilyIndex = m_context.getGraphicsQueueFamilyIndex();
+			imageBarriers[3].dstQueueFamilyIndex = m_context.getComputeQueueFamilyIndex();
+			imageBarriers[3].image = rr.m_tonemappedImage[(resourceIndex + FRAMES_IN_FLIGHT - 1) % FRAMES_IN_FLIGHT]->getImage();
+			imageBarriers[3].subresourceRange = { VK_IMAGE_ASPECT_COLOR_BIT, 0, 1, 0, 1 };
+
+			vkCmdPipelineBarrier(curCmdBuf, VK_PIPELINE_STAGE_COMPUTE_SHADER_BIT, VK_PIPELINE_STAGE_COMPUTE_SHADER_BIT, 0, 0, nullptr, 0, nullptr, m_presentPending ? 4 : 3, imageBarriers);
+		}
+
+		// with async compute all following timestamps are written on the compute queue. both sss timestamps have to be taken on
+		// the same queue to be comparable
+		vkCmdWriteTimestamp(curCmdBuf, VK_PIPELINE_STAGE_TOP_OF_PIPE_BIT, rr.m_queryPool, queryOffset + TIMESTAMP_SSS_BEGIN);
+
+		// the barriers of the compute passes are derived from the resources they declare. the main pass outputs and both
+		// tonemapped images are readable by compute shaders at this point, either through the render pass dependency or the
+		// ownership transfer above. the tonemapped image of this frame was the taa history of the previous one
+		FrameGraph frameGraph;
+		frameGraph.importImage(rr.m_depthStencilImage[resourceIndex]->getImage(), RESOURCE_STATE_COMPUTE_READ, VK_IMAGE_ASPECT_DEPTH_BIT | VK_IMAGE_ASPECT_STENCIL_BIT);
+		frameGraph.importImage(rr.m_colorImage[resourceIndex]->getImage(), RESOURCE_STATE_COMPUTE_READ);
+		frameGraph.importImage(rr.m_diffuse0Image[resourceIndex]->getImage(), RESOURCE_STATE_COMPUTE_READ);
+		for (size_t i = 0; i < FRAMES_IN_FLIGHT; ++i)
+		{
+			frameGraph.importImage(rr.m_tonemappedImage[i]->getImage(), RESOURCE_STATE_COMPUTE_READ);
+		}
+
+		// the sss intermediates are shared with the compute passes of the previous frame, which ran earlier on this queue
+		for (const auto &image : { rr.m_diffuse1Image.get(), rr.m_linearDepthImage.get(), rr.m_halfResDiffuse0Image.get(), rr.m_halfResDiffuse1Image.get(), rr.m_halfResLinearDepthImage.get() })
+		{
+			frameGraph.importDiscardedImage(image->getImage(), RESOURCE_STATE_COMPUTE_READ_WRITE);
+		}
+
+		// tiles left of this column are blurred by the separable passes, the others by burley's normalized diffusion.
+		// aligned to the tiles of both blur resolutions
+		const int32_t sssSplitColumn = sssMode == SSS_MODE_SEPARABLE ? std::numeric_limits<int32_t>::max() : sssMode == SSS_MODE_BURLEY ? 0 : static_cast<int32_t>(m_width / 2) & ~31;
+
+		// the vertical separable blur pass can run inside the postprocessing pass, saving a write and read of diffuse0.
+		// not possible at half resolution, where the upsample pass needs the blurred image
+		const bool fuseVerticalBlur = fusedSSSBlur && subsurfaceScatteringEnabled && !sssHalfResolution;
 
 		if (subsurfaceScatteringEnabled)
 		{
-			// sss blur 0
+			// in half resolution mode the classification pass downsamples diffuse0 and linear depth, both blur passes run on
+			// the half resolution images and the result is bilaterally upsampled back into diffuse0
+			Image &blurImage0 = sssHalfResolution ? *rr.m_halfResDiffuse0Image : *rr.m_diffuse0Image[resourceIndex];
+			Image &blurImage1 = sssHalfResolution ? *rr.m_halfResDiffuse1Image : *rr.m_diffuse1Image;
+			Image &linearDepthImage = sssHalfResolution ? *rr.m_halfResLinearDepthImage : *rr.m_linearDepthImage;
+			const uint32_t blurWidth = sssHalfResolution ? (m_width + 1) / 2 : m_width;
+			const uint32_t blurHeight = sssHalfResolution ? (m_height + 1) / 2 : m_height;
+			const int32_t blurSplitColumn = sssHalfResolution ? sssSplitColumn / 2 : sssSplitColumn;
+
+			const VkBuffer tileBuffer = rr.m_sssTileBuffer[resourceIndex]->getBuffer();
+
+			// sss tile classification
 			{
-				// transition diffuse1 image layout to VK_IMAGE_LAYOUT_GENERAL
+				// reset tile list to an empty dispatch. tiles skipped by the blur passes contain no sss pixels and thus only zero diffuse
+				// lighting (diffuse0 is cleared to zero and only written by the sss lighting subpass). clearing blur image 1 makes the second
+				// pass read the same values there as if the first pass had run on all tiles.
 				{
-					VkImageMemoryBarrier imageBarrier{ VK_STRUCTURE_TYPE_IMAGE_MEMORY_BARRIER };
-					imageBarrier.srcAccessMask = 0;
-					imageBarrier.dstAccessMask = VK_ACCESS_TRANSFER_WRITE_BIT;
-					imageBarrier.oldLayout = VK_IMAGE_LAYOUT_UNDEFINED;
-					imageBarrier.newLayout = VK_IMAGE_LAYOUT_GENERAL;
-					imageBarrier.srcQueueFamilyIndex = VK_QUEUE_FAMILY_IGNORED;
-					imageBarrier.dstQueueFamilyIndex = VK_QUEUE_FAMILY_IGNORED;
-					imageBarrier.image = rr.m_diffuse1Image[resourceIndex]->getImage();
-					imageBarrier.subresourceRange = { VK_IMAGE_ASPECT_COLOR_BIT, 0, 1, 0, 1 };
-
-					vkCmdPipelineBarrier(curCmdBuf, VK_PIPELINE_STAGE_TOP_OF_PIPE_BIT, VK_PIPELINE_STAGE_TRANSFER_BIT, 0, 0, nullptr, 0, nullptr, 1, &imageBarrier);
+					frameGraph.beginPass(curCmdBuf, { { blurImage1.getImage(), RESOURCE_STATE_TRANSFER_WRITE, true } }, { { tileBuffer, RESOURCE_STATE_TRANSFER_WRITE } });
+
+					const VkDispatchIndirectCommand emptyDispatch = { 0, 1, 1 };
+					vkCmdUpdateBuffer(curCmdBuf, tileBuffer, 0, sizeof(emptyDispatch), &emptyDispatch);
+
+					VkClearColorValue clearColor{};
+					VkImageSubresourceRange range = { VK_IMAGE_ASPECT_COLOR_BIT, 0, 1, 0, 1 };
+					vkCmdClearColorImage(curCmdBuf, blurImage1.getImage(), VK_IMAGE_LAYOUT_TRANSFER_DST_OPTIMAL, &clearColor, 1, &range);
 				}
 
-				vkCmdBindPipeline(curCmdBuf, VK_PIPELINE_BIND_POINT_COMPUTE, rr.m_sssBlurPipeline0.first);
+				frameGraph.beginPass(curCmdBuf,
+					{
+						{ rr.m_diffuse0Image[resourceIndex]->getImage(), RESOURCE_STATE_COMPUTE_READ },
+						{ rr.m_depthStencilImage[resourceIndex]->getImage(), RESOURCE_STATE_COMPUTE_READ },
+						{ linearDepthImage.getImage(), RESOURCE_STATE_COMPUTE_WRITE, true },
+						{ sssHalfResolution ? rr.m_halfResDiffuse0Image->getImage() : VK_NULL_HANDLE, RESOURCE_STATE_COMPUTE_WRITE, true },
+					},
+					{ { tileBuffer, RESOURCE_STATE_COMPUTE_READ_WRITE } });
+
+				const auto &pipeline = sssHalfResolution ? rr.m_sssClassifyHalfResPipeline : rr.m_sssClassifyPipeline;
+				const VkDescriptorSet descriptorSet = sssHalfResolution ? rr.m_sssClassifyHalfResDescriptorSet[resourceIndex] : rr.m_sssClassifyDescriptorSet[resourceIndex];
+
+				vkCmdBindPipeline(curCmdBuf, VK_PIPELINE_BIND_POINT_COMPUTE, pipeline.first);
 
-				vkCmdBindDescriptorSets(curCmdBuf, VK_PIPELINE_BIND_POINT_COMPUTE, rr.m_sssBlurPipeline0.second, 0, 1, &rr.m_sssBlurDescriptorSet[resourceIndex * 2], 0, nullptr);
+				vkCmdBindDescriptorSets(curCmdBuf, VK_PIPELINE_BIND_POINT_COMPUTE, pipeline.second, 0, 1, &descriptorSet, 0, nullptr);
+
+				struct PushConsts
+				{
+					float nearPlane;
+					float farPlane;
+				};
+
+				PushConsts pushConsts;
+				pushConsts.nearPlane = nearPlane;
+				pushConsts.farPlane = farPlane;
+
+				vkCmdPushConstants(curCmdBuf, pipeline.second, VK_SHADER_STAGE_COMPUTE_BIT, 0, sizeof(pushConsts), &pushConsts);
+
+				vkCmdDispatch(curCmdBuf, (blurWidth + 15) / 16, (blurHeight + 15) / 16, 1);
+			}
+
+			vkCmdWriteTimestamp(curCmdBuf, VK_PIPELINE_STAGE_BOTTOM_OF_PIPE_BIT, rr.m_queryPool, queryOffset + TIMESTAMP_SSS_CLASSIFY_END);
+
+			// sss burley
+			if (sssMode != SSS_MODE_SEPARABLE)
+			{
+				const VkDescriptorSet descriptorSet = sssHalfResolution ? rr.m_sssBlurHalfResDescriptorSet[resourceIndex * 2] : rr.m_sssBlurDescriptorSet[resourceIndex * 2];
+
+				frameGraph.beginPass(curCmdBuf,
+					{
+						{ blurImage0.getImage(), RESOURCE_STATE_COMPUTE_READ },
+						{ linearDepthImage.getImage(), RESOURCE_STATE_COMPUTE_READ },
+						{ blurImage1.getImage(), RESOURCE_STATE_COMPUTE_WRITE },
+					},
+					{ { tileBuffer, RESOURCE_STATE_INDIRECT_READ }, { tileBuffer, RESOURCE_STATE_COMPUTE_READ } });
+
+				vkCmdBindPipeline(curCmdBuf, VK_PIPELINE_BIND_POINT_COMPUTE, rr.m_sssBurleyPipeline.first);
+
+				vkCmdBindDescriptorSets(curCmdBuf, VK_PIPELINE_BIND_POINT_COMPUTE, rr.m_sssBurleyPipeline.second, 0, 1, &descriptorSet, 0, nullptr);
+
+				using namespace glm;
+				struct PushConsts
+				{
+					vec2 texelSize;
+					float projectionScale;
+					uint32_t sampleCount;
+					uint32_t frame;
+					int32_t splitColumn;
+				};
+
+				PushConsts pushConsts;
+				pushConsts.texelSize = 1.0f / glm::vec2(blurWidth, blurHeight);
+				pushConsts.projectionScale = 1.0f / tanf(fovy * 0.5f) * (m_height / static_cast<float>(m_width));
+				pushConsts.sampleCount = burleySampleCount;
+				pushConsts.frame = static_cast<uint32_t>(m_frameIndex);
+				pushConsts.splitColumn = blurSplitColumn;
+
+				vkCmdPushConstants(curCmdBuf, rr.m_sssBurleyPipeline.second, VK_SHADER_STAGE_COMPUTE_BIT, 0, sizeof(pushConsts), &pushConsts);
+
+				vkCmdDispatchIndirect(curCmdBuf, rr.m_sssTileBuffer[resourceIndex]->getBuffer(), 0);
+			}
+
+			vkCmdWriteTimestamp(curCmdBuf, VK_PIPELINE_STAGE_BOTTOM_OF_PIPE_BIT, rr.m_queryPool, queryOffset + TIMESTAMP_SSS_BURLEY_END);
+
+			// sss blur 0
+			if (sssMode != SSS_MODE_BURLEY)
+			{
+				// in split screen mode the burley pass writes the right half of blur image 1. the passes touch disjoint tiles, but the
+				// write after write serializes them anyway, so that the timestamps measure each technique on its own
+				frameGraph.beginPass(curCmdBuf,
+					{
+						{ blurImage0.getImage(), RESOURCE_STATE_COMPUTE_READ },
+						{ linearDepthImage.getImage(), RESOURCE_STATE_COMPUTE_READ },
+						{ blurImage1.getImage(), RESOURCE_STATE_COMPUTE_WRITE },
+					},
+					{ { tileBuffer, RESOURCE_STATE_INDIRECT_READ }, { tileBuffer, RESOURCE_STATE_COMPUTE_READ } });
+
+				const auto &pipeline = tiledBlur ? rr.m_sssBlurTiledPipeline0 : rr.m_sssBlurPipeline0;
+				const VkDescriptorSet descriptorSet = sssHalfResolution ? rr.m_sssBlurHalfResDescriptorSet[resourceIndex * 2] : rr.m_sssBlurDescriptorSet[resourceIndex * 2];
+
+				vkCmdBindPipeline(curCmdBuf, VK_PIPELINE_BIND_POINT_COMPUTE, pipeline.first);
+
+				vkCmdBindDescriptorSets(curCmdBuf, VK_PIPELINE_BIND_POINT_COMPUTE, pipeline.second, 0, 1, &descriptorSet, 0, nullptr);
 
 				using namespace glm;
 				struct PushConsts
 				{
 					vec2 texelSize;
 					vec2 dir;
-					float sssWidth;
+					float projectionScale;
+					int32_t splitColumn;
 				};
 
 				PushConsts pushConsts;
-				pushConsts.texelSize = 1.0f / glm::vec2(m_width, m_height);
+				pushConsts.texelSize = 1.0f / glm::vec2(blurWidth, blurHeight);
 				pushConsts.dir = glm::vec2(1.0f, 0.0f);
-				pushConsts.sssWidth = sssWidth * 1.0f / tanf(fovy * 0.5f) * (m_height / static_cast<float>(m_width));
+				pushConsts.projectionScale = 1.0f / tanf(fovy * 0.5f) * (m_height / static_cast<float>(m_width));
+				pushConsts.splitColumn = blurSplitColumn;
 
-				vkCmdPushConstants(curCmdBuf, rr.m_sssBlurPipeline0.second, VK_SHADER_STAGE_COMPUTE_BIT, 0, sizeof(pushConsts), &pushConsts);
+				vkCmdPushConstants(curCmdBuf, pipeline.second, VK_SHADER_STAGE_COMPUTE_BIT, 0, sizeof(pushConsts), &pushConsts);
 
-				vkCmdDispatch(curCmdBuf, (m_width + 15) / 16, (m_height + 15) / 16, 1);
+				vkCmdDispatchIndirect(curCmdBuf, rr.m_sssTileBuffer[resourceIndex]->getBuffer(), 0);
 			}
 
 			// sss blur 1
+			if (!fuseVerticalBlur && sssMode != SSS_MODE_BURLEY)
 			{
-				// barriers
-				{
-					VkImageMemoryBarrier imageBarriers[2];
-
-					// transition diffuse1 image layout to VK_IMAGE_LAYOUT_SHADER_READ_ONLY_OPTIMAL
-					imageBarriers[0] = { VK_STRUCTURE_TYPE_IMAGE_MEMORY_BARRIER };
-					imageBarriers[0].srcAccessMask = VK_ACCESS_SHADER_WRITE_BIT;
-					imageBarriers[0].dstAccessMask = VK_ACCESS_SHADER_READ_BIT;
-					imageBarriers[0].oldLayout = VK_IMAGE_LAYOUT_GENERAL;
-					imageBarriers[0].newLayout = VK_IMAGE_LAYOUT_SHADER_READ_ONLY_OPTIMAL;
-					imageBarriers[0].srcQueueFamilyIndex = VK_QUEUE_FAMILY_IGNORED;
-					imageBarriers[0].dstQueueFamilyIndex = VK_QUEUE_FAMILY_IGNORED;
-					imageBarriers[0].image = rr.m_diffuse1Image[resourceIndex]->getImage();
-					imageBarriers[0].subresourceRange = { VK_IMAGE_ASPECT_COLOR_BIT, 0, 1, 0, 1 };
-
-					// transition diffuse0 image layout to VK_IMAGE_LAYOUT_GENERAL
-					imageBarriers[1] = { VK_STRUCTURE_TYPE_IMAGE_MEMORY_BARRIER };
-					imageBarriers[1].srcAccessMask = VK_ACCESS_SHADER_READ_BIT;
-					imageBarriers[1].dstAccessMask = VK_ACCESS_SHADER_WRITE_BIT;
-					imageBarriers[1].oldLayout = VK_IMAGE_LAYOUT_SHADER_READ_ONLY_OPTIMAL;
-					imageBarriers[1].newLayout = VK_IMAGE_LAYOUT_GENERAL;
-					imageBarriers[1].srcQueueFamilyIndex = VK_QUEUE_FAMILY_IGNORED;
-					imageBarriers[1].dstQueueFamilyIndex = VK_QUEUE_FAMILY_IGNORED;
-					imageBarriers[1].image = rr.m_diffuse0Image[resourceIndex]->getImage();
-					imageBarriers[1].subresourceRange = { VK_IMAGE_ASPECT_COLOR_BIT, 0, 1, 0, 1 };
-
-					vkCmdPipelineBarrier(curCmdBuf, VK_PIPELINE_STAGE_COMPUTE_SHADER_BIT, VK_PIPELINE_STAGE_COMPUTE_SHADER_BIT, 0, 0, nullptr, 0, nullptr, 2, imageBarriers);
-				}
+				frameGraph.beginPass(curCmdBuf,
+					{
+						{ blurImage1.getImage(), RESOURCE_STATE_COMPUTE_READ },
+						{ linearDepthImage.getImage(), RESOURCE_STATE_COMPUTE_READ },
+						{ blurImage0.getImage(), RESOURCE_STATE_COMPUTE_WRITE },
+					},
+					{ { tileBuffer, RESOURCE_STATE_INDIRECT_READ }, { tileBuffer, RESOURCE_STATE_COMPUTE_READ } });
+
+				const auto &pipeline = tiledBlur ? rr.m_sssBlurTiledPipeline1 : rr.m_sssBlurPipeline1;
+				const VkDescriptorSet descriptorSet = sssHalfResolution ? rr.m_sssBlurHalfResDescriptorSet[resourceIndex * 2 + 1] : rr.m_sssBlurDescriptorSet[resourceIndex * 2 + 1];
 
-				vkCmdBindPipeline(curCmdBuf, VK_PIPELINE_BIND_POINT_COMPUTE, rr.m_sssBlurPipeline1.first);
+				vkCmdBindPipeline(curCmdBuf, VK_PIPELINE_BIND_POINT_COMPUTE, pipeline.first);
 
-				vkCmdBindDescriptorSets(curCmdBuf, VK_PIPELINE_BIND_POINT_COMPUTE, rr.m_sssBlurPipeline1.second, 0, 1, &rr.m_sssBlurDescriptorSet[resourceIndex * 2 + 1], 0, nullptr);
+				vkCmdBindDescriptorSets(curCmdBuf, VK_PIPELINE_BIND_POINT_COMPUTE, pipeline.second, 0, 1, &descriptorSet, 0, nullptr);
 
 				using namespace glm;
 				struct PushConsts
 				{
 					vec2 texelSize;
 					vec2 dir;
-					float sssWidth;
+					float projectionScale;
+					int32_t splitColumn;
 				};
 
 				PushConsts pushConsts;
-				pushConsts.texelSize = 1.0f / glm::vec2(m_width, m_height);
+				pushConsts.texelSize = 1.0f / glm::vec2(blurWidth, blurHeight);
 				pushConsts.dir = glm::vec2(0.0f, 1.0f);
-				pushConsts.sssWidth = sssWidth * 1.0f / tanf(fovy * 0.5f) * (m_height / static_cast<float>(m_width));
+				pushConsts.projectionScale = 1.0f / tanf(fovy * 0.5f) * (m_height / static_cast<float>(m_width));
+				pushConsts.splitColumn = blurSplitColumn;
 
-				vkCmdPushConstants(curCmdBuf, rr.m_sssBlurPipeline1.second, VK_SHADER_STAGE_COMPUTE_BIT, 0, sizeof(pushConsts), &pushConsts);
+				vkCmdPushConstants(curCmdBuf, pipeline.second, VK_SHADER_STAGE_COMPUTE_BIT, 0, sizeof(pushConsts), &pushConsts);
+
+				vkCmdDispatchIndirect(curCmdBuf, rr.m_sssTileBuffer[resourceIndex]->getBuffer(), 0);
+			}
+
+			vkCmdWriteTimestamp(curCmdBuf, VK_PIPELINE_STAGE_BOTTOM_OF_PIPE_BIT, rr.m_queryPool, queryOffset + TIMESTAMP_SSS_SEPARABLE_END);
+
+			// sss bilateral upsample
+			if (sssHalfResolution)
+			{
+				// diffuse0 is read and written in place
+				frameGraph.beginPass(curCmdBuf,
+					{
+						{ rr.m_halfResDiffuse0Image->getImage(), RESOURCE_STATE_COMPUTE_READ },
+						{ rr.m_halfResDiffuse1Image->getImage(), RESOURCE_STATE_COMPUTE_READ },
+						{ rr.m_halfResLinearDepthImage->getImage(), RESOURCE_STATE_COMPUTE_READ },
+						{ rr.m_depthStencilImage[resourceIndex]->getImage(), RESOURCE_STATE_COMPUTE_READ },
+						{ rr.m_diffuse0Image[resourceIndex]->getImage(), RESOURCE_STATE_COMPUTE_READ_WRITE },
+					});
+
+				vkCmdBindPipeline(curCmdBuf, VK_PIPELINE_BIND_POINT_COMPUTE, rr.m_sssUpsamplePipeline.first);
+
+				vkCmdBindDescriptorSets(curCmdBuf, VK_PIPELINE_BIND_POINT_COMPUTE, rr.m_sssUpsamplePipeline.second, 0, 1, &rr.m_sssUpsampleDescriptorSet[resourceIndex], 0, nullptr);
+
+				struct PushConsts
+				{
+					float nearPlane;
+					float farPlane;
+					int32_t splitColumn;
+				};
+
+				PushConsts pushConsts;
+				pushConsts.nearPlane = nearPlane;
+				pushConsts.farPlane = farPlane;
+				pushConsts.splitColumn = sssSplitColumn;
+
+				vkCmdPushConstants(curCmdBuf, rr.m_sssUpsamplePipeline.second, VK_SHADER_STAGE_COMPUTE_BIT, 0, sizeof(pushConsts), &pushConsts);
 
 				vkCmdDispatch(curCmdBuf, (m_width + 15) / 16, (m_height + 15) / 16, 1);
 			}
 		}
+		else
+		{
+			// the timings read back at the beginning of the frame expect all timestamps to be written
+			vkCmdWriteTimestamp(curCmdBuf, VK_PIPELINE_STAGE_BOTTOM_OF_PIPE_BIT, rr.m_queryPool, queryOffset + TIMESTAMP_SSS_CLASSIFY_END);
+			vkCmdWriteTimestamp(curCmdBuf, VK_PIPELINE_STAGE_BOTTOM_OF_PIPE_BIT, rr.m_queryPool, queryOffset + TIMESTAMP_SSS_BURLEY_END);
+			vkCmdWriteTimestamp(curCmdBuf, VK_PIPELINE_STAGE_BOTTOM_OF_PIPE_BIT, rr.m_queryPool, queryOffset + TIMESTAMP_SSS_SEPARABLE_END);
+		}
 
-		vkCmdWriteTimestamp(curCmdBuf, VK_PIPELINE_STAGE_BOTTOM_OF_PIPE_BIT, rr.m_queryPool, resourceIndex + 1);
+		vkCmdWriteTimestamp(curCmdBuf, VK_PIPELINE_STAGE_BOTTOM_OF_PIPE_BIT, rr.m_queryPool, queryOffset + TIMESTAMP_SSS_END);
 
 		// postprocessing
 		{
-			// barriers
-			{
-				VkImageMemoryBarrier imageBarriers[2];
-
-				// transition tonemapped image layout to VK_IMAGE_LAYOUT_GENERAL
-				imageBarriers[0] = { VK_STRUCTURE_TYPE_IMAGE_MEMORY_BARRIER };
-				imageBarriers[0].srcAccessMask = 0;
-				imageBarriers[0].dstAccessMask = VK_ACCESS_SHADER_WRITE_BIT;
-				imageBarriers[0].oldLayout = VK_IMAGE_LAYOUT_UNDEFINED;
-				imageBarriers[0].newLayout = VK_IMAGE_LAYOUT_GENERAL;
-				imageBarriers[0].srcQueueFamilyIndex = VK_QUEUE_FAMILY_IGNORED;
-				imageBarriers[0].dstQueueFamilyIndex = VK_QUEUE_FAMILY_IGNORED;
-				imageBarriers[0].image = rr.m_tonemappedImage[resourceIndex]->getImage();
-				imageBarriers[0].subresourceRange = { VK_IMAGE_ASPECT_COLOR_BIT, 0, 1, 0, 1 };
-
-				// transition diffuse0 image layout to VK_IMAGE_LAYOUT_SHADER_READ_ONLY_OPTIMAL
-				imageBarriers[1] = { VK_STRUCTURE_TYPE_IMAGE_MEMORY_BARRIER };
-				imageBarriers[1].srcAccessMask = VK_ACCESS_SHADER_WRITE_BIT;
-				imageBarriers[1].dstAccessMask = VK_ACCESS_SHADER_READ_BIT;
-				imageBarriers[1].oldLayout = VK_IMAGE_LAYOUT_GENERAL;
-				imageBarriers[1].newLayout = VK_IMAGE_LAYOUT_SHADER_READ_ONLY_OPTIMAL;
-				imageBarriers[1].srcQueueFamilyIndex = VK_QUEUE_FAMILY_IGNORED;
-				imageBarriers[1].dstQueueFamilyIndex = VK_QUEUE_FAMILY_IGNORED;
-				imageBarriers[1].image = rr.m_diffuse0Image[resourceIndex]->getImage();
-				imageBarriers[1].subresourceRange = { VK_IMAGE_ASPECT_COLOR_BIT, 0, 1, 0, 1 };
-
-				vkCmdPipelineBarrier(curCmdBuf, subsurfaceScatteringEnabled ? VK_PIPELINE_STAGE_COMPUTE_SHADER_BIT : VK_PIPELINE_STAGE_BOTTOM_OF_PIPE_BIT, VK_PIPELINE_STAGE_COMPUTE_SHADER_BIT, 0, 0, nullptr, 0, nullptr, subsurfaceScatteringEnabled ? 2 : 1, imageBarriers);
-			}
+			// diffuse1 holds the burley result of the full resolution sss or, if the vertical blur is fused into this pass, the output
+			// of the first blur pass
+			frameGraph.beginPass(curCmdBuf,
+				{
+					{ rr.m_tonemappedImage[resourceIndex]->getImage(), RESOURCE_STATE_COMPUTE_WRITE, true },
+					{ rr.m_colorImage[resourceIndex]->getImage(), RESOURCE_STATE_COMPUTE_READ },
+					{ rr.m_depthStencilImage[resourceIndex]->getImage(), RESOURCE_STATE_COMPUTE_READ },
+					{ rr.m_diffuse0Image[resourceIndex]->getImage(), RESOURCE_STATE_COMPUTE_READ },
+					{ rr.m_tonemappedImage[(resourceIndex + FRAMES_IN_FLIGHT - 1) % FRAMES_IN_FLIGHT]->getImage(), RESOURCE_STATE_COMPUTE_READ },
+					{ subsurfaceScatteringEnabled && !sssHalfResolution ? rr.m_diffuse1Image->getImage() : VK_NULL_HANDLE, RESOURCE_STATE_COMPUTE_READ },
+					{ fuseVerticalBlur ? rr.m_linearDepthImage->getImage() : VK_NULL_HANDLE, RESOURCE_STATE_COMPUTE_READ },
+				});
+
+			const auto &pipeline = fuseVerticalBlur ? rr.m_posprocessingFusedSSSBlurPipeline : rr.m_posprocessingPipeline;
 
-			vkCmdBindPipeline(curCmdBuf, VK_PIPELINE_BIND_POINT_COMPUTE, rr.m_posprocessingPipeline.first);
+			vkCmdBindPipeline(curCmdBuf, VK_PIPELINE_BIND_POINT_COMPUTE, pipeline.first);
 
-			vkCmdBindDescriptorSets(curCmdBuf, VK_PIPELINE_BIND_POINT_COMPUTE, rr.m_posprocessingPipeline.second, 0, 1, &rr.m_postprocessingDescriptorSet[resourceIndex], 0, nullptr);
+			vkCmdBindDescriptorSets(curCmdBuf, VK_PIPELINE_BIND_POINT_COMPUTE, pipeline.second, 0, 1, &rr.m_postprocessingDescriptorSet[resourceIndex], 0, nullptr);
 
 			using namespace glm;
 			struct PushConsts
@@ -636,6 +852,8 @@ void sss::vulkan::Renderer::render(const glm::mat4 &viewProjection,
 				vec2 texelSize;
 				float exposure;
 				uint taa;
+				int32_t sssSplitColumn;
+				float sssProjectionScale;
 			};
 
 			PushConsts pushConsts;
@@ -643,44 +861,275 @@ void sss::vulkan::Renderer::render(const glm::mat4 &viewProjection,
 			pushConsts.texelSize = 1.0f / glm::vec2(m_width, m_height);
 			pushConsts.exposure = 1.0f;
 			pushConsts.taa = taaEnabled ? 1 : 0;
+			// in half resolution mode the upsample pass already merged both techniques into diffuse0
+			pushConsts.sssSplitColumn = subsurfaceScatteringEnabled && !sssHalfResolution ? sssSplitColumn : std::numeric_limits<int32_t>::max();
+			pushConsts.sssProjectionScale = 1.0f / tanf(fovy * 0.5f) * (m_height / static_cast<float>(m_width));
 
-			vkCmdPushConstants(curCmdBuf, rr.m_posprocessingPipeline.second, VK_SHADER_STAGE_COMPUTE_BIT, 0, sizeof(pushConsts), &pushConsts);
+			vkCmdPushConstants(curCmdBuf, pipeline.second, VK_SHADER_STAGE_COMPUTE_BIT, 0, sizeof(pushConsts), &pushConsts);
 
 			vkCmdDispatch(curCmdBuf, (m_width + 15) / 16, (m_height + 15) / 16, 1);
 		}
+
+		vkCmdWriteTimestamp(curCmdBuf, VK_PIPELINE_STAGE_BOTTOM_OF_PIPE_BIT, rr.m_queryPool, queryOffset + TIMESTAMP_POSTPROCESS_END);
+
+		// without a swapchain the tonemapped image is the final output: only make it available as taa history for the next frame
+		if (m_context.isHeadless())
+		{
+			frameGraph.beginPass(curCmdBuf, { { rr.m_tonemappedImage[resourceIndex]->getImage(), RESOURCE_STATE_COMPUTE_READ } });
+		}
+		// with async compute it is released to the graphics queue for presenting. the layout transition has to match the
+		// one of the acquire barrier in presentFrame()
+		else if (m_asyncCompute)
+		{
+			VkImageMemoryBarrier imageBarrier{ VK_STRUCTURE_TYPE_IMAGE_MEMORY_BARRIER };
+			imageBarrier.srcAccessMask = VK_ACCESS_SHADER_WRITE_BIT;
+			imageBarrier.dstAccessMask = 0;
+			imageBarrier.oldLayout = VK_IMAGE_LAYOUT_GENERAL;
+			imageBarrier.newLayout = VK_IMAGE_LAYOUT_TRANSFER_SRC_OPTIMAL;
+			imageBarrier.srcQueueFamilyIndex = m_context.getComputeQueueFamilyIndex();
+			imageBarrier.dstQueueFamilyIndex = m_context.getGraphicsQueueFamilyIndex();
+			imageBarrier.image = rr.m_tonemappedImage[resourceIndex]->getImage();
+			imageBarrier.subresourceRange = { VK_IMAGE_ASPECT_COLOR_BIT, 0, 1, 0, 1 };
+
+			vkCmdPipelineBarrier(curCmdBuf, VK_PIPELINE_STAGE_COMPUTE_SHADER_BIT, VK_PIPELINE_STAGE_BOTTOM_OF_PIPE_BIT, 0, 0, nullptr, 0, nullptr, 1, &imageBarrier);
+		}
 	}
 	vkEndCommandBuffer(curCmdBuf);
 
+	// submit the compute queue part of the frame
+	if (m_asyncCompute)
+	{
+		// the swapchain dependent part of the previous frame was held back so that this queue could start on the shadow and main
+		// passes of this frame while the previous frame was still busy on the compute queue. it has to be submitted before this
+		// frame's compute work, which waits for it to release the taa history
+		const bool historyReleased = m_presentPending;
+		if (m_presentPending)
+		{
+			presentFrame((resourceIndex + FRAMES_IN_FLIGHT - 1) % FRAMES_IN_FLIGHT);
+			m_presentPending = false;
+		}
+
+		VkSemaphore waitSemaphores[] = { rr.m_mainPassFinishedSemaphores[resourceIndex], rr.m_historyReleasedSemaphores[(resourceIndex + FRAMES_IN_FLIGHT - 1) % FRAMES_IN_FLIGHT] };
+		VkPipelineStageFlags waitStageFlags[] = { VK_PIPELINE_STAGE_COMPUTE_SHADER_BIT, VK_PIPELINE_STAGE_COMPUTE_SHADER_BIT };
+
+		VkSubmitInfo submitInfo{ VK_STRUCTURE_TYPE_SUBMIT_INFO };
+		submitInfo.waitSemaphoreCount = historyReleased ? 2 : 1;
+		submitInfo.pWaitSemaphores = waitSemaphores;
+		submitInfo.pWaitDstStageMask = waitStageFlags;
+		submitInfo.commandBufferCount = 1;
+		submitInfo.pCommandBuffers = &curCmdBuf;
+		// without a swapchain this is the last submission of the frame
+		submitInfo.signalSemaphoreCount = m_context.isHeadless() ? 0 : 1;
+		submitInfo.pSignalSemaphores = &rr.m_computeFinishedSemaphores[resourceIndex];
+
+		if (vkQueueSubmit(m_context.getComputeQueue(), 1, &submitInfo, m_context.isHeadless() ? rr.m_frameFinishedFence[resourceIndex] : VK_NULL_HANDLE) != VK_SUCCESS)
+		{
+			util::fatalExit("Failed to submit to queue!", EXIT_FAILURE);
+		}
+
+		m_presentPending = !m_context.isHeadless();
+		++m_frameIndex;
+		m_previousViewProjection = viewProjection;
+		return;
+	}
+
 	// submit swapchain image independent work to queue
 	{
 		VkSubmitInfo submitInfo{ VK_STRUCTURE_TYPE_SUBMIT_INFO };
 		submitInfo.commandBufferCount = 1;
 		submitInfo.pCommandBuffers = &curCmdBuf;
 
-		if (vkQueueSubmit(m_context.getGraphicsQueue(), 1, &submitInfo, VK_NULL_HANDLE) != VK_SUCCESS)
+		// without a swapchain this is the last submission of the frame
+		if (vkQueueSubmit(m_context.getGraphicsQueue(), 1, &submitInfo, m_context.isHeadless() ? rr.m_frameFinishedFence[resourceIndex] : VK_NULL_HANDLE) != VK_SUCCESS)
 		{
 			util::fatalExit("Failed to submit to queue!", EXIT_FAILURE);
 		}
 	}
 
-	// acquire swapchain image
+	if (m_context.isHeadless())
+	{
+		++m_frameIndex;
+		m_previousViewProjection = viewProjection;
+		return;
+	}
+
+	presentFrame(resourceIndex);
+
+	++m_frameIndex;
+	m_previousViewProjection = viewProjection;
+}
+
+void sss::vulkan::Renderer::setSSSProfile(uint32_t profileIndex, uint32_t sampleCount, float width, const glm::vec3 &strength, const glm::vec3 &falloff)
+{
+	assert(profileIndex < SSSKernel::MAX_PROFILE_COUNT);
+	SSSKernel::calculate(sampleCount, strength, falloff, m_sssProfiles[profileIndex]);
+	SSSKernel::calculateBurley(width, strength, falloff, m_sssProfiles[profileIndex]);
+	m_sssProfiles[profileIndex].width = width;
+}
+
+void sss::vulkan::Renderer::setSSSMaterialProfile(uint32_t profileIndex)
+{
+	assert(profileIndex < SSSKernel::MAX_PROFILE_COUNT);
+	for (auto &material : m_materials)
+	{
+		if (material.second)
+		{
+			material.first.sssProfileIndex = profileIndex;
+		}
+	}
+}
+
+float sss::vulkan::Renderer::getShadowPassTiming() const
+{
+	return m_shadowPassTime;
+}
+
+float sss::vulkan::Renderer::getMainPassTiming() const
+{
+	return m_mainPassTime;
+}
+
+float sss::vulkan::Renderer::getSSSEffectTiming() const
+{
+	return m_sssTime;
+}
+
+float sss::vulkan::Renderer::getSSSSeparableTiming() const
+{
+	return m_sssSeparableTime;
+}
+
+float sss::vulkan::Renderer::getSSSBurleyTiming() const
+{
+	return m_sssBurleyTime;
+}
+
+float sss::vulkan::Renderer::getPostprocessTiming() const
+{
+	return m_postprocessTime;
+}
+
+bool sss::vulkan::Renderer::isAsyncComputeEnabled() const
+{
+	return m_asyncCompute;
+}
+
+std::vector<sss::vulkan::MemoryAllocator::Statistics> sss::vulkan::Renderer::getMemoryStatistics() const
+{
+	return m_context.getMemoryAllocator().getStatistics();
+}
+
+float sss::vulkan::Renderer::getPipelineCreationTiming() const
+{
+	return m_renderResources.m_pipelineCreationTime;
+}
+
+bool sss::vulkan::Renderer::isPipelineCacheWarm() const
+{
+	return m_context.getPipelineCache().isWarm();
+}
+
+void sss::vulkan::Renderer::loadSceneAssets(const scene::Scene &scene)
+{
+	std::vector<std::future<std::shared_ptr<Texture>>> textureLoads;
+	for (const auto &texture : scene.textures)
+	{
+		textureLoads.push_back(loadTextureAsync(m_context.getMemoryAllocator(), m_context.getDevice(), m_uploadManager, texture.path, false));
+	}
+
+	// the whole scene is a single mesh, its submeshes are matched to the scene materials by the obj material name
+	m_mesh = Mesh::load(m_context.getMemoryAllocator(), m_context.getDevice(), m_uploadManager, scene.meshPath);
+
+	// used for submeshes with a material name that is not in the scene
+	Material defaultMaterial{};
+	defaultMaterial.gloss = 0.376f;
+	defaultMaterial.specular = 0.162f;
+	defaultMaterial.albedo = glm::packUnorm4x8(glm::vec4(0.5f, 0.5f, 0.5f, 1.0f));
+
+	for (const auto &submesh : m_mesh->getSubmeshes())
+	{
+		std::pair<Material, bool> material = { defaultMaterial, false };
+		for (const auto &sceneMaterial : scene.materials)
+		{
+			if (submesh.materialName == sceneMaterial.name)
+			{
+				material = { sceneMaterial.material, sceneMaterial.sss != 0 };
+			}
+		}
+		assert(!material.second || material.first.sssProfileIndex < SSSKernel::MAX_PROFILE_COUNT);
+		m_materials.push_back(material);
+	}
+
+	for (auto &textureLoad : textureLoads)
+	{
+		m_textures.push_back(textureLoad.get());
+	}
+}
+
+void sss::vulkan::Renderer::updateSceneDescriptors()
+{
+	// every element of the array has to be valid, so unused elements point to the brdf lut
+	VkDescriptorImageInfo textureImageInfos[scene::MAX_TEXTURE_COUNT];
+	for (size_t i = 0; i < scene::MAX_TEXTURE_COUNT; ++i)
+	{
+		auto &textureImageInfo = textureImageInfos[i];
+		textureImageInfo.sampler = m_renderResources.m_linearSamplerRepeat;
+		textureImageInfo.imageView = i < m_textures.size() ? m_textures[i]->getView() : m_brdfLUT->getView();
+		textureImageInfo.imageLayout = VK_IMAGE_LAYOUT_SHADER_READ_ONLY_OPTIMAL;
+	}
+
+	VkWriteDescriptorSet textureWrite{ VK_STRUCTURE_TYPE_WRITE_DESCRIPTOR_SET };
+	textureWrite.dstSet = m_renderResources.m_textureDescriptorSet;
+	textureWrite.dstBinding = 0;
+	textureWrite.descriptorCount = scene::MAX_TEXTURE_COUNT;
+	textureWrite.descriptorType = VK_DESCRIPTOR_TYPE_COMBINED_IMAGE_SAMPLER;
+	textureWrite.pImageInfo = textureImageInfos;
+
+	vkUpdateDescriptorSets(m_context.getDevice(), 1, &textureWrite, 0, nullptr);
+}
+
+void sss::vulkan::Renderer::resize(uint32_t width, uint32_t height)
+{
+	retirePendingPresent();
+	if (m_swapChain)
+	{
+		m_swapChain->recreate(width, height);
+	}
+	m_renderResources.resize(width, height);
+	m_width = width;
+	m_height = height;
+	transitionHistoryImages();
+}
+
+void sss::vulkan::Renderer::presentFrame(uint32_t resourceIndex)
+{
+	RenderResources &rr = m_renderResources;
+
+	// with async compute the tonemapped image is written on the compute queue and its ownership is transferred to this queue and back
+	const uint32_t computeQueueFamily = m_asyncCompute ? m_context.getComputeQueueFamilyIndex() : VK_QUEUE_FAMILY_IGNORED;
+	const uint32_t graphicsQueueFamily = m_asyncCompute ? m_context.getGraphicsQueueFamilyIndex() : VK_QUEUE_FAMILY_IGNORED;
+
+	// acquire swapchain image. if this fails, the tonemapped image still needs its transitions for taa in the next frame
 	uint32_t swapChainImageIndex = 0;
+	bool swapChainImageAcquired = true;
 	{
-		VkResult result = vkAcquireNextImageKHR(m_context.getDevice(), m_swapChain, std::numeric_limits<uint64_t>::max(), rr.m_swapChainImageAvailableSemaphores[resourceIndex], VK_NULL_HANDLE, &swapChainImageIndex);
+		VkResult result = vkAcquireNextImageKHR(m_context.getDevice(), *m_swapChain, std::numeric_limits<uint64_t>::max(), rr.m_swapChainImageAvailableSemaphores[resourceIndex], VK_NULL_HANDLE, &swapChainImageIndex);
 
-		if (result == VK_ERROR_OUT_OF_DATE_KHR || result == VK_SUBOPTIMAL_KHR)
+		if (result == VK_ERROR_OUT_OF_DATE_KHR)
 		{
-			m_swapChain.recreate(m_width, m_height);
-			return;
+			m_swapChain->recreate(m_width, m_height);
+			swapChainImageAcquired = false;
 		}
-		else if (result != VK_SUCCESS)
+		else if (result != VK_SUCCESS && result != VK_SUBOPTIMAL_KHR)
 		{
 			util::fatalExit("Failed to acquire swap chain image!", EXIT_FAILURE);
 		}
 	}
 
+	VkCommandBufferBeginInfo beginInfo{ VK_STRUCTURE_TYPE_COMMAND_BUFFER_BEGIN_INFO };
+	beginInfo.flags = VK_COMMAND_BUFFER_USAGE_ONE_TIME_SUBMIT_BIT;
 
-	curCmdBuf = rr.m_commandBuffers[resourceIndex * 2 + 1];
+	VkCommandBuffer curCmdBuf = rr.m_commandBuffers[resourceIndex * 2 + 1];
 
 	// swapchain image dependent part of the frame
 	vkBeginCommandBuffer(curCmdBuf, &beginInfo);
@@ -688,92 +1137,113 @@ void sss::vulkan::Renderer::render(const glm::mat4 &viewProjection,
 		// barriers
 		{
 			VkImageMemoryBarrier imageBarriers[2];
-			// transition backbuffer image layout to VK_IMAGE_LAYOUT_TRANSFER_DST_OPTIMAL
+
+			// transition tonemapped image layout to VK_IMAGE_LAYOUT_TRANSFER_SRC_OPTIMAL
 			imageBarriers[0] = { VK_STRUCTURE_TYPE_IMAGE_MEMORY_BARRIER };
-			imageBarriers[0].srcAccessMask = 0;
-			imageBarriers[0].dstAccessMask = VK_ACCESS_TRANSFER_WRITE_BIT;
-			imageBarriers[0].oldLayout = VK_IMAGE_LAYOUT_UNDEFINED;
-			imageBarriers[0].newLayout = VK_IMAGE_LAYOUT_TRANSFER_DST_OPTIMAL;
-			imageBarriers[0].srcQueueFamilyIndex = VK_QUEUE_FAMILY_IGNORED;
-			imageBarriers[0].dstQueueFamilyIndex = VK_QUEUE_FAMILY_IGNORED;
-			imageBarriers[0].image = m_swapChain.getImage(swapChainImageIndex);
+			imageBarriers[0].srcAccessMask = m_asyncCompute ? 0 : VK_ACCESS_SHADER_WRITE_BIT;
+			imageBarriers[0].dstAccessMask = VK_ACCESS_TRANSFER_READ_BIT;
+			imageBarriers[0].oldLayout = VK_IMAGE_LAYOUT_GENERAL;
+			imageBarriers[0].newLayout = VK_IMAGE_LAYOUT_TRANSFER_SRC_OPTIMAL;
+			imageBarriers[0].srcQueueFamilyIndex = computeQueueFamily;
+			imageBarriers[0].dstQueueFamilyIndex = graphicsQueueFamily;
+			imageBarriers[0].image = rr.m_tonemappedImage[resourceIndex]->getImage();
 			imageBarriers[0].subresourceRange = { VK_IMAGE_ASPECT_COLOR_BIT, 0, 1, 0, 1 };
 
-			// transition tonemapped image layout to VK_IMAGE_LAYOUT_TRANSFER_SRC_OPTIMAL
+			// transition backbuffer image layout to VK_IMAGE_LAYOUT_TRANSFER_DST_OPTIMAL
 			imageBarriers[1] = { VK_STRUCTURE_TYPE_IMAGE_MEMORY_BARRIER };
-			imageBarriers[1].srcAccessMask = VK_ACCESS_SHADER_WRITE_BIT;
-			imageBarriers[1].dstAccessMask = VK_ACCESS_TRANSFER_READ_BIT;
-			imageBarriers[1].oldLayout = VK_IMAGE_LAYOUT_GENERAL;
-			imageBarriers[1].newLayout = VK_IMAGE_LAYOUT_TRANSFER_SRC_OPTIMAL;
+			imageBarriers[1].srcAccessMask = 0;
+			imageBarriers[1].dstAccessMask = VK_ACCESS_TRANSFER_WRITE_BIT;
+			imageBarriers[1].oldLayout = VK_IMAGE_LAYOUT_UNDEFINED;
+			imageBarriers[1].newLayout = VK_IMAGE_LAYOUT_TRANSFER_DST_OPTIMAL;
 			imageBarriers[1].srcQueueFamilyIndex = VK_QUEUE_FAMILY_IGNORED;
 			imageBarriers[1].dstQueueFamilyIndex = VK_QUEUE_FAMILY_IGNORED;
-			imageBarriers[1].image = rr.m_tonemappedImage[resourceIndex]->getImage();
+			imageBarriers[1].image = m_swapChain->getImage(swapChainImageIndex);
 			imageBarriers[1].subresourceRange = { VK_IMAGE_ASPECT_COLOR_BIT, 0, 1, 0, 1 };
 
-			vkCmdPipelineBarrier(curCmdBuf, VK_PIPELINE_STAGE_COMPUTE_SHADER_BIT, VK_PIPELINE_STAGE_TRANSFER_BIT, 0, 0, nullptr, 0, nullptr, 2, imageBarriers);
+			// the async compute work is waited on by a semaphore at the transfer stage
+			vkCmdPipelineBarrier(curCmdBuf, m_asyncCompute ? VK_PIPELINE_STAGE_TRANSFER_BIT : VK_PIPELINE_STAGE_COMPUTE_SHADER_BIT, VK_PIPELINE_STAGE_TRANSFER_BIT, 0, 0, nullptr, 0, nullptr, swapChainImageAcquired ? 2 : 1, imageBarriers);
 		}
 
-		// blit color image to backbuffer
+		if (swapChainImageAcquired)
 		{
-			VkImageBlit region{};
-			region.srcSubresource = { VK_IMAGE_ASPECT_COLOR_BIT, 0, 0, 1 };
-			region.srcOffsets[1] = { static_cast<int32_t>(m_width), static_cast<int32_t>(m_height), 1 };
-			region.dstSubresource = { VK_IMAGE_ASPECT_COLOR_BIT, 0, 0, 1 };
-			region.dstOffsets[1] = { static_cast<int32_t>(m_width), static_cast<int32_t>(m_height), 1 };
+			// blit color image to backbuffer
+			{
+				VkImageBlit region{};
+				region.srcSubresource = { VK_IMAGE_ASPECT_COLOR_BIT, 0, 0, 1 };
+				region.srcOffsets[1] = { static_cast<int32_t>(m_width), static_cast<int32_t>(m_height), 1 };
+				region.dstSubresource = { VK_IMAGE_ASPECT_COLOR_BIT, 0, 0, 1 };
+				region.dstOffsets[1] = { static_cast<int32_t>(m_width), static_cast<int32_t>(m_height), 1 };
 
-			vkCmdBlitImage(curCmdBuf, rr.m_tonemappedImage[resourceIndex]->getImage(), VK_IMAGE_LAYOUT_TRANSFER_SRC_OPTIMAL, m_swapChain.getImage(swapChainImageIndex), VK_IMAGE_LAYOUT_TRANSFER_DST_OPTIMAL, 1, &region, VK_FILTER_NEAREST);
-		}
+				vkCmdBlitImage(curCmdBuf, rr.m_tonemappedImage[resourceIndex]->getImage(), VK_IMAGE_LAYOUT_TRANSFER_SRC_OPTIMAL, m_swapChain->getImage(swapChainImageIndex), VK_IMAGE_LAYOUT_TRANSFER_DST_OPTIMAL, 1, &region, VK_FILTER_NEAREST);
+			}
 
-		// gui renderpass
-		{
-			VkClearValue clearValue;
+			// gui renderpass
+			{
+				VkClearValue clearValue;
 
-			VkRenderPassBeginInfo renderPassInfo = { VK_STRUCTURE_TYPE_RENDER_PASS_BEGIN_INFO };
-			renderPassInfo.renderPass = rr.m_guiRenderPass;
-			renderPassInfo.framebuffer = rr.m_guiFramebuffers[swapChainImageIndex];
-			renderPassInfo.renderArea.offset = { 0, 0 };
-			renderPassInfo.renderArea.extent = { m_width, m_height };
-			renderPassInfo.clearValueCount = 1;
-			renderPassInfo.pClearValues = &clearValue;
+				VkRenderPassBeginInfo renderPassInfo = { VK_STRUCTURE_TYPE_RENDER_PASS_BEGIN_INFO };
+				renderPassInfo.renderPass = rr.m_guiRenderPass;
+				renderPassInfo.framebuffer = rr.m_guiFramebuffers[swapChainImageIndex];
+				renderPassInfo.renderArea.offset = { 0, 0 };
+				renderPassInfo.renderArea.extent = { m_width, m_height };
+				renderPassInfo.clearValueCount = 1;
+				renderPassInfo.pClearValues = &clearValue;
 
-			vkCmdBeginRenderPass(curCmdBuf, &renderPassInfo, VK_SUBPASS_CONTENTS_INLINE);
+				vkCmdBeginRenderPass(curCmdBuf, &renderPassInfo, VK_SUBPASS_CONTENTS_INLINE);
 
-			ImGui_ImplVulkan_RenderDrawData(ImGui::GetDrawData(), curCmdBuf);
+				ImGui_ImplVulkan_RenderDrawData(ImGui::GetDrawData(), curCmdBuf);
 
-			vkCmdEndRenderPass(curCmdBuf);
+				vkCmdEndRenderPass(curCmdBuf);
+			}
 		}
 
 		// transition tonemapped image layout to VK_IMAGE_LAYOUT_SHADER_READ_ONLY_OPTIMAL for taa in next frame
+		// and, with async compute, release it to the compute queue
 		{
 			VkImageMemoryBarrier imageBarriers[1];
 			imageBarriers[0] = { VK_STRUCTURE_TYPE_IMAGE_MEMORY_BARRIER };
 			imageBarriers[0].srcAccessMask = VK_ACCESS_TRANSFER_READ_BIT;
-			imageBarriers[0].dstAccessMask = VK_ACCESS_SHADER_READ_BIT;
+			imageBarriers[0].dstAccessMask = m_asyncCompute ? 0 : VK_ACCESS_SHADER_READ_BIT;
 			imageBarriers[0].oldLayout = VK_IMAGE_LAYOUT_TRANSFER_SRC_OPTIMAL;
 			imageBarriers[0].newLayout = VK_IMAGE_LAYOUT_SHADER_READ_ONLY_OPTIMAL;
-			imageBarriers[0].srcQueueFamilyIndex = VK_QUEUE_FAMILY_IGNORED;
-			imageBarriers[0].dstQueueFamilyIndex = VK_QUEUE_FAMILY_IGNORED;
+			imageBarriers[0].srcQueueFamilyIndex = graphicsQueueFamily;
+			imageBarriers[0].dstQueueFamilyIndex = computeQueueFamily;
 			imageBarriers[0].image = rr.m_tonemappedImage[resourceIndex]->getImage();
 			imageBarriers[0].subresourceRange = { VK_IMAGE_ASPECT_COLOR_BIT, 0, 1, 0, 1 };
 
-			vkCmdPipelineBarrier(curCmdBuf, VK_PIPELINE_STAGE_TRANSFER_BIT, VK_PIPELINE_STAGE_COMPUTE_SHADER_BIT, 0, 0, nullptr, 0, nullptr, 1, imageBarriers);
+			vkCmdPipelineBarrier(curCmdBuf, VK_PIPELINE_STAGE_TRANSFER_BIT, m_asyncCompute ? VK_PIPELINE_STAGE_BOTTOM_OF_PIPE_BIT : VK_PIPELINE_STAGE_COMPUTE_SHADER_BIT, 0, 0, nullptr, 0, nullptr, 1, imageBarriers);
 		}
-		
 	}
 	vkEndCommandBuffer(curCmdBuf);
 
 	// submit swapchain image dependent work to queue
 	{
-		VkPipelineStageFlags waitStageFlags = VK_PIPELINE_STAGE_TRANSFER_BIT;
+		VkSemaphore waitSemaphores[2];
+		VkPipelineStageFlags waitStageFlags[2] = { VK_PIPELINE_STAGE_TRANSFER_BIT, VK_PIPELINE_STAGE_TRANSFER_BIT };
+		VkSemaphore signalSemaphores[2];
+		uint32_t waitSemaphoreCount = 0;
+		uint32_t signalSemaphoreCount = 0;
+
+		if (swapChainImageAcquired)
+		{
+			waitSemaphores[waitSemaphoreCount++] = rr.m_swapChainImageAvailableSemaphores[resourceIndex];
+			signalSemaphores[signalSemaphoreCount++] = rr.m_renderFinishedSemaphores[resourceIndex];
+		}
+
+		if (m_asyncCompute)
+		{
+			waitSemaphores[waitSemaphoreCount++] = rr.m_computeFinishedSemaphores[resourceIndex];
+			signalSemaphores[signalSemaphoreCount++] = rr.m_historyReleasedSemaphores[resourceIndex];
+		}
 
 		VkSubmitInfo submitInfo{ VK_STRUCTURE_TYPE_SUBMIT_INFO };
-		submitInfo.waitSemaphoreCount = 1;
-		submitInfo.pWaitSemaphores = &rr.m_swapChainImageAvailableSemaphores[resourceIndex];
-		submitInfo.pWaitDstStageMask = &waitStageFlags;
+		submitInfo.waitSemaphoreCount = waitSemaphoreCount;
+		submitInfo.pWaitSemaphores = waitSemaphores;
+		submitInfo.pWaitDstStageMask = waitStageFlags;
 		submitInfo.commandBufferCount = 1;
 		submitInfo.pCommandBuffers = &curCmdBuf;
-		submitInfo.signalSemaphoreCount = 1;
-		submitInfo.pSignalSemaphores = &rr.m_renderFinishedSemaphores[resourceIndex];
+		submitInfo.signalSemaphoreCount = signalSemaphoreCount;
+		submitInfo.pSignalSemaphores = signalSemaphores;
 
 		if (vkQueueSubmit(m_context.getGraphicsQueue(), 1, &submitInfo, rr.m_frameFinishedFence[resourceIndex]) != VK_SUCCESS)
 		{
@@ -782,8 +1252,9 @@ void sss::vulkan::Renderer::render(const glm::mat4 &viewProjection,
 	}
 
 	// present swapchain image
+	if (swapChainImageAcquired)
 	{
-		VkSwapchainKHR swapChain = m_swapChain;
+		VkSwapchainKHR swapChain = *m_swapChain;
 
 		VkPresentInfoKHR presentInfo{ VK_STRUCTURE_TYPE_PRESENT_INFO_KHR };
 		presentInfo.waitSemaphoreCount = 1;
@@ -796,38 +1267,49 @@ void sss::vulkan::Renderer::render(const glm::mat4 &viewProjection,
 
 		if (result == VK_ERROR_OUT_OF_DATE_KHR || result == VK_SUBOPTIMAL_KHR)
 		{
-			m_swapChain.recreate(m_width, m_height);
-			return;
+			m_swapChain->recreate(m_width, m_height);
 		}
 		else if (result != VK_SUCCESS)
 		{
 			util::fatalExit("Failed to present swap chain image!", EXIT_FAILURE);
 		}
 	}
-
-	++m_frameIndex;
-	m_previousViewProjection = viewProjection;
 }
 
-float sss::vulkan::Renderer::getSSSEffectTiming() const
+void sss::vulkan::Renderer::retirePendingPresent()
 {
-	return m_sssTime;
-}
+	if (!m_presentPending)
+	{
+		return;
+	}
 
-void sss::vulkan::Renderer::resize(uint32_t width, uint32_t height)
-{
-	m_swapChain.recreate(width, height);
-	m_renderResources.resize(width, height);
-	m_width = width;
-	m_height = height;
-	transitionHistoryImages();
+	// drop the deferred swapchain dependent part of the previous frame. an empty submission still consumes the
+	// semaphore signaled by its compute work and signals its fence
+	const uint32_t resourceIndex = (m_frameIndex + FRAMES_IN_FLIGHT - 1) % FRAMES_IN_FLIGHT;
+	const VkPipelineStageFlags waitStageFlags = VK_PIPELINE_STAGE_ALL_COMMANDS_BIT;
+
+	VkSubmitInfo submitInfo{ VK_STRUCTURE_TYPE_SUBMIT_INFO };
+	submitInfo.waitSemaphoreCount = 1;
+	submitInfo.pWaitSemaphores = &m_renderResources.m_computeFinishedSemaphores[resourceIndex];
+	submitInfo.pWaitDstStageMask = &waitStageFlags;
+
+	if (vkQueueSubmit(m_context.getGraphicsQueue(), 1, &submitInfo, m_renderResources.m_frameFinishedFence[resourceIndex]) != VK_SUCCESS)
+	{
+		util::fatalExit("Failed to submit to queue!", EXIT_FAILURE);
+	}
+
+	m_presentPending = false;
 }
 
 void sss::vulkan::Renderer::transitionHistoryImages()
 {
-	// transition tonemapped output image to VK_IMAGE_LAYOUT_SHADER_READ_ONLY_OPTIMAL to be used as taa input
+	// transition tonemapped output image to VK_IMAGE_LAYOUT_SHADER_READ_ONLY_OPTIMAL to be used as taa input.
+	// with async compute, the image is first used on the compute queue
 	{
-		auto cmdBuf = vkutil::beginSingleTimeCommands(m_context.getDevice(), m_context.getGraphicsCommandPool());
+		const VkQueue queue = m_asyncCompute ? m_context.getComputeQueue() : m_context.getGraphicsQueue();
+		const VkCommandPool cmdPool = m_asyncCompute ? m_context.getComputeCommandPool() : m_context.getGraphicsCommandPool();
+
+		auto cmdBuf = vkutil::beginSingleTimeCommands(m_context.getDevice(), cmdPool);
 		{
 			VkImageMemoryBarrier imageBarriers[FRAMES_IN_FLIGHT];
 			for (size_t i = 0; i < FRAMES_IN_FLIGHT; ++i)
@@ -845,6 +1327,121 @@ void sss::vulkan::Renderer::transitionHistoryImages()
 
 			vkCmdPipelineBarrier(cmdBuf, VK_PIPELINE_STAGE_TOP_OF_PIPE_BIT, VK_PIPELINE_STAGE_COMPUTE_SHADER_BIT, 0, 0, nullptr, 0, nullptr, FRAMES_IN_FLIGHT, imageBarriers);
 		}
-		vkutil::endSingleTimeCommands(m_context.getDevice(), m_context.getGraphicsQueue(), m_context.getGraphicsCommandPool(), cmdBuf);
+		vkutil::endSingleTimeCommands(m_context.getDevice(), queue, cmdPool, cmdBuf);
+	}
+}
+
+bool sss::vulkan::Renderer::writeOutputImage(const char *filepath)
+{
+	if (m_frameIndex == 0)
+	{
+		return false;
+	}
+
+	const uint32_t resourceIndex = (m_frameIndex - 1) % FRAMES_IN_FLIGHT;
+	const VkImage image = m_renderResources.m_tonemappedImage[resourceIndex]->getImage();
+
+	// with async compute the last frame is not presented yet. presenting it now hands the tonemapped image back to the compute
+	// queue, where the readback waits for the release and acquires it. the next render() call then finds no pending present
+	const bool historyReleased = m_presentPending;
+	if (m_presentPending)
+	{
+		presentFrame(resourceIndex);
+		m_presentPending = false;
+	}
+
+	vkDeviceWaitIdle(m_context.getDevice());
+
+	// the tonemapped image of the last frame is in VK_IMAGE_LAYOUT_SHADER_READ_ONLY_OPTIMAL after render() finished
+
+	VkBufferCreateInfo bufferCreateInfo{ VK_STRUCTURE_TYPE_BUFFER_CREATE_INFO };
+	bufferCreateInfo.size = m_width * m_height * 4;
+	bufferCreateInfo.usage = VK_BUFFER_USAGE_TRANSFER_DST_BIT;
+	bufferCreateInfo.sharingMode = VK_SHARING_MODE_EXCLUSIVE;
+
+	Buffer readbackBuffer(m_context.getMemoryAllocator(), bufferCreateInfo, VK_MEMORY_PROPERTY_HOST_VISIBLE_BIT | VK_MEMORY_PROPERTY_HOST_COHERENT_BIT, VK_MEMORY_PROPERTY_HOST_CACHED_BIT);
+
+	const VkQueue queue = m_asyncCompute ? m_context.getComputeQueue() : m_context.getGraphicsQueue();
+	const VkCommandPool cmdPool = m_asyncCompute ? m_context.getComputeCommandPool() : m_context.getGraphicsCommandPool();
+
+	auto cmdBuf = vkutil::beginSingleTimeCommands(m_context.getDevice(), cmdPool);
+	{
+		// acquire the image released by presentFrame(). the layout transition has to match the one of its release barrier
+		if (historyReleased)
+		{
+			VkImageMemoryBarrier imageBarrier{ VK_STRUCTURE_TYPE_IMAGE_MEMORY_BARRIER };
+			imageBarrier.srcAccessMask = 0;
+			imageBarrier.dstAccessMask = VK_ACCESS_SHADER_READ_BIT;
+			imageBarrier.oldLayout = VK_IMAGE_LAYOUT_TRANSFER_SRC_OPTIMAL;
+			imageBarrier.newLayout = VK_IMAGE_LAYOUT_SHADER_READ_ONLY_OPTIMAL;
+			imageBarrier.srcQueueFamilyIndex = m_context.getGraphicsQueueFamilyIndex();
+			imageBarrier.dstQueueFamilyIndex = m_context.getComputeQueueFamilyIndex();
+			imageBarrier.image = image;
+			imageBarrier.subresourceRange = { VK_IMAGE_ASPECT_COLOR_BIT, 0, 1, 0, 1 };
+
+			vkCmdPipelineBarrier(cmdBuf, VK_PIPELINE_STAGE_COMPUTE_SHADER_BIT, VK_PIPELINE_STAGE_COMPUTE_SHADER_BIT, 0, 0, nullptr, 0, nullptr, 1, &imageBarrier);
+		}
+
+		// transition tonemapped image layout to VK_IMAGE_LAYOUT_TRANSFER_SRC_OPTIMAL
+		VkImageMemoryBarrier imageBarrier{ VK_STRUCTURE_TYPE_IMAGE_MEMORY_BARRIER };
+		imageBarrier.srcAccessMask = VK_ACCESS_SHADER_WRITE_BIT;
+		imageBarrier.dstAccessMask = VK_ACCESS_TRANSFER_READ_BIT;
+		imageBarrier.oldLayout = VK_IMAGE_LAYOUT_SHADER_READ_ONLY_OPTIMAL;
+		imageBarrier.newLayout = VK_IMAGE_LAYOUT_TRANSFER_SRC_OPTIMAL;
+		imageBarrier.srcQueueFamilyIndex = VK_QUEUE_FAMILY_IGNORED;
+		imageBarrier.dstQueueFamilyIndex = VK_QUEUE_FAMILY_IGNORED;
+		imageBarrier.image = image;
+		imageBarrier.subresourceRange = { VK_IMAGE_ASPECT_COLOR_BIT, 0, 1, 0, 1 };
+
+		vkCmdPipelineBarrier(cmdBuf, VK_PIPELINE_STAGE_COMPUTE_SHADER_BIT, VK_PIPELINE_STAGE_TRANSFER_BIT, 0, 0, nullptr, 0, nullptr, 1, &imageBarrier);
+
+		VkBufferImageCopy region{};
+		region.imageSubresource = { VK_IMAGE_ASPECT_COLOR_BIT, 0, 0, 1 };
+		region.imageExtent = { m_width, m_height, 1 };
+
+		vkCmdCopyImageToBuffer(cmdBuf, image, VK_IMAGE_LAYOUT_TRANSFER_SRC_OPTIMAL, readbackBuffer.getBuffer(), 1, &region);
+
+		// transition back to VK_IMAGE_LAYOUT_SHADER_READ_ONLY_OPTIMAL, the image is still needed as taa history
+		imageBarrier.srcAccessMask = VK_ACCESS_TRANSFER_READ_BIT;
+		imageBarrier.dstAccessMask = VK_ACCESS_SHADER_READ_BIT;
+		imageBarrier.oldLayout = VK_IMAGE_LAYOUT_TRANSFER_SRC_OPTIMAL;
+		imageBarrier.newLayout = VK_IMAGE_LAYOUT_SHADER_READ_ONLY_OPTIMAL;
+
+		VkBufferMemoryBarrier bufferBarrier{ VK_STRUCTURE_TYPE_BUFFER_MEMORY_BARRIER };
+		bufferBarrier.srcAccessMask = VK_ACCESS_TRANSFER_WRITE_BIT;
+		bufferBarrier.dstAccessMask = VK_ACCESS_HOST_READ_BIT;
+		bufferBarrier.srcQueueFamilyIndex = VK_QUEUE_FAMILY_IGNORED;
+		bufferBarrier.dstQueueFamilyIndex = VK_QUEUE_FAMILY_IGNORED;
+		bufferBarrier.buffer = readbackBuffer.getBuffer();
+		bufferBarrier.offset = 0;
+		bufferBarrier.size = VK_WHOLE_SIZE;
+
+		vkCmdPipelineBarrier(cmdBuf, VK_PIPELINE_STAGE_TRANSFER_BIT, VK_PIPELINE_STAGE_COMPUTE_SHADER_BIT | VK_PIPELINE_STAGE_HOST_BIT, 0, 0, nullptr, 1, &bufferBarrier, 1, &imageBarrier);
 	}
+	vkutil::endSingleTimeCommands(m_context.getDevice(), queue, cmdPool, cmdBuf, historyReleased ? m_renderResources.m_historyReleasedSemaphores[resourceIndex] : VK_NULL_HANDLE, VK_PIPELINE_STAGE_COMPUTE_SHADER_BIT);
+
+	std::ofstream file(filepath, std::ios::binary);
+	if (!file.is_open())
+	{
+		return false;
+	}
+
+	// binary ppm: header followed by tightly packed rgb triplets
+	file << "P6\n" << m_width << " " << m_height << "\n255\n";
+
+	const uint8_t *data = readbackBuffer.map();
+	std::vector<uint8_t> row(m_width * 3);
+	for (uint32_t y = 0; y < m_height; ++y)
+	{
+		for (uint32_t x = 0; x < m_width; ++x)
+		{
+			const uint8_t *texel = data + (y * m_width + x) * 4;
+			row[x * 3 + 0] = texel[0];
+			row[x * 3 + 1] = texel[1];
+			row[x * 3 + 2] = texel[2];
+		}
+		file.write(reinterpret_cast<const char *>(row.data()), row.size());
+	}
+
+	return file.good();
 }
@@ -5,6 +5,9 @@
 #include <memory>
 #include "Material.h"
 #include "RenderResources.h"
+#include "UploadManager.h"
+#include "SSSKernel.h"
+#include "scene/Scene.h"
 
 namespace sss
 {
@@ -13,43 +16,95 @@ namespace sss
 		class Texture;
 		class Mesh;
 
+		// screen space subsurface scattering technique. the split screen mode blurs the left half of the screen with the
+		// separable kernel and the right half with burley's normalized diffusion, timing both side by side
+		enum SSSMode
+		{
+			SSS_MODE_SEPARABLE,
+			SSS_MODE_BURLEY,
+			SSS_MODE_SPLIT_SCREEN,
+		};
+
 		class Renderer
 		{
 		public:
-			explicit Renderer(void *windowHandle, uint32_t width, uint32_t height);
+			// pass nullptr as windowHandle to render headless into an offscreen image.
+			// asyncCompute moves sss and postprocessing to a dedicated compute queue, if the device has one
+			explicit Renderer(void *windowHandle, uint32_t width, uint32_t height, bool asyncCompute, const scene::Scene &scene);
 			~Renderer();
+			// waits for the gpu and replaces the mesh, textures and materials with those of the given scene
+			void loadScene(const scene::Scene &scene);
 			void render(const glm::mat4 &viewProjection, 
 				const glm::mat4 &shadowMatrix, 
 				const glm::vec4 &lightPositionRadius, 
 				const glm::vec4 &lightColorInvSqrAttRadius, 
 				const glm::vec4 &cameraPosition, 
 				bool subsurfaceScatteringEnabled,
-				float sssWidth,
+				bool sssHalfResolution,
+				SSSMode sssMode,
+				uint32_t burleySampleCount,
+				bool tiledBlur,
+				bool fusedSSSBlur,
 				bool taaEnabled,
-				float fovy);
+				float fovy,
+				float nearPlane,
+				float farPlane);
+			// regenerates an entry of the sss profile table; width is the world space scattering width.
+			// takes effect with the next rendered frame
+			void setSSSProfile(uint32_t profileIndex, uint32_t sampleCount, float width, const glm::vec3 &strength, const glm::vec3 &falloff);
+			// assigns an entry of the sss profile table to all SSS materials of the scene
+			void setSSSMaterialProfile(uint32_t profileIndex);
+			float getShadowPassTiming() const;
+			float getMainPassTiming() const;
 			float getSSSEffectTiming() const;
+			// gpu time of the individual sss techniques, excluding tile classification and upsampling
+			float getSSSSeparableTiming() const;
+			float getSSSBurleyTiming() const;
+			float getPostprocessTiming() const;
+			bool isAsyncComputeEnabled() const;
+			// one entry per memory heap
+			std::vector<MemoryAllocator::Statistics> getMemoryStatistics() const;
+			// cpu time in ms spent creating the pipelines at startup
+			float getPipelineCreationTiming() const;
+			// true if the pipeline cache was loaded from disk
+			bool isPipelineCacheWarm() const;
 			void resize(uint32_t width, uint32_t height);
+			// waits for the gpu and writes the last rendered frame as binary ppm. presents a deferred frame first
+			bool writeOutputImage(const char *filepath);
 
 		private:
+			float m_shadowPassTime;
+			float m_mainPassTime;
 			float m_sssTime;
+			float m_sssSeparableTime;
+			float m_sssBurleyTime;
+			float m_postprocessTime;
 			uint32_t m_width;
 			uint32_t m_height;
 			uint64_t m_frameIndex = 0;
 			VKContext m_context;
-			SwapChain m_swapChain;
+			bool m_asyncCompute;
+			bool m_presentPending = false; // the swapchain dependent part of the previous frame is deferred to the next render() call
+			std::unique_ptr<SwapChain> m_swapChain; // nullptr when rendering headless
 			RenderResources m_renderResources;
+			UploadManager m_uploadManager;
 			std::shared_ptr<Texture> m_radianceTexture;
 			std::shared_ptr<Texture> m_irradianceTexture;
 			std::shared_ptr<Texture> m_brdfLUT;
 			std::shared_ptr<Texture> m_skyboxTexture;
 			std::vector<std::shared_ptr<Texture>> m_textures;
-			std::vector<std::shared_ptr<Mesh>> m_meshes;
-			std::vector<std::pair<Material, bool>> m_materials; // bool is true if SSS
+			std::shared_ptr<Mesh> m_mesh;
+			std::vector<std::pair<Material, bool>> m_materials; // one per submesh of m_mesh, bool is true if SSS
+			SSSKernel::Data m_sssProfiles[SSSKernel::MAX_PROFILE_COUNT];
 			glm::mat4 m_previousViewProjection;
 			float m_haltonX[8];
 			float m_haltonY[8];
 
+			void loadSceneAssets(const scene::Scene &scene);
+			void updateSceneDescriptors();
 			void transitionHistoryImages();
+			void presentFrame(uint32_t resourceIndex);
+			void retirePendingPresent();
 		};
 	}
 }
\ No newline at end of file
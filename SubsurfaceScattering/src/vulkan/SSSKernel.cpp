@@ -0,0 +1,119 @@
+#include "SSSKernel.h"
+#include <algorithm>
+#include <cassert>
+#include <cmath>
+#include <glm/geometric.hpp>
+
+namespace
+{
+	glm::vec3 gaussian(float variance, float r, const glm::vec3 &falloff)
+	{
+		// the falloff modulates the shape of the profile: big falloffs spread the shape, small falloffs make it narrower
+		glm::vec3 g;
+		for (int i = 0; i < 3; ++i)
+		{
+			const float rr = r / (0.001f + falloff[i]);
+			g[i] = expf(-(rr * rr) / (2.0f * variance)) / (2.0f * 3.14f * variance);
+		}
+		return g;
+	}
+
+	glm::vec3 profile(float r, const glm::vec3 &falloff)
+	{
+		// sum of gaussians fit of the red channel of the skin profile of [d'Eon07], used for all channels and scaled with the falloff.
+		// the narrowest gaussian (0.233 * gaussian(0.0064, r)) is directly bounced light and accounted for by the strength parameter
+		return 0.100f * gaussian(0.0484f, r, falloff) +
+			0.118f * gaussian(0.187f, r, falloff) +
+			0.113f * gaussian(0.567f, r, falloff) +
+			0.358f * gaussian(1.99f, r, falloff) +
+			0.078f * gaussian(7.41f, r, falloff);
+	}
+}
+
+void sss::vulkan::SSSKernel::calculate(uint32_t sampleCount, const glm::vec3 &strength, const glm::vec3 &falloff, Data &data)
+{
+	assert(sampleCount > 1 && sampleCount <= MAX_SAMPLE_COUNT && (sampleCount & 1) == 1);
+
+	const float EXPONENT = 2.0f; // used for importance sampling
+	const float RANGE = sampleCount > 20 ? 3.0f : 2.0f;
+
+	glm::vec4 *kernel = data.kernel;
+	data.sampleCount = sampleCount;
+
+	// calculate the offsets
+	const float step = 2.0f * RANGE / (sampleCount - 1);
+	for (uint32_t i = 0; i < sampleCount; ++i)
+	{
+		const float o = -RANGE + float(i) * step;
+		const float sign = o < 0.0f ? -1.0f : 1.0f;
+		kernel[i].w = RANGE * sign * fabsf(powf(o, EXPONENT)) / powf(RANGE, EXPONENT);
+	}
+
+	// calculate the weights
+	for (uint32_t i = 0; i < sampleCount; ++i)
+	{
+		const float w0 = i > 0 ? fabsf(kernel[i].w - kernel[i - 1].w) : 0.0f;
+		const float w1 = i < sampleCount - 1 ? fabsf(kernel[i].w - kernel[i + 1].w) : 0.0f;
+		const float area = (w0 + w1) * 0.5f;
+		const glm::vec3 t = area * profile(kernel[i].w, falloff);
+		kernel[i].x = t.x;
+		kernel[i].y = t.y;
+		kernel[i].z = t.z;
+	}
+
+	// the center sample (offset 0.0) comes first
+	{
+		const glm::vec4 t = kernel[sampleCount / 2];
+		for (uint32_t i = sampleCount / 2; i > 0; --i)
+		{
+			kernel[i] = kernel[i - 1];
+		}
+		kernel[0] = t;
+	}
+
+	// normalize the weights
+	glm::vec3 sum = glm::vec3(0.0f);
+	for (uint32_t i = 0; i < sampleCount; ++i)
+	{
+		sum += glm::vec3(kernel[i]);
+	}
+
+	for (uint32_t i = 0; i < sampleCount; ++i)
+	{
+		kernel[i].x /= sum.x;
+		kernel[i].y /= sum.y;
+		kernel[i].z /= sum.z;
+	}
+
+	// apply strength: lerp(1.0, kernel[0].rgb, strength) for the center sample and lerp(0.0, kernel[i].rgb, strength) for the others
+	kernel[0].x = (1.0f - strength.x) + strength.x * kernel[0].x;
+	kernel[0].y = (1.0f - strength.y) + strength.y * kernel[0].y;
+	kernel[0].z = (1.0f - strength.z) + strength.z * kernel[0].z;
+
+	for (uint32_t i = 1; i < sampleCount; ++i)
+	{
+		kernel[i].x *= strength.x;
+		kernel[i].y *= strength.y;
+		kernel[i].z *= strength.z;
+	}
+
+	// clear unused entries
+	for (uint32_t i = sampleCount; i < MAX_SAMPLE_COUNT; ++i)
+	{
+		kernel[i] = glm::vec4(0.0f);
+	}
+}
+
+void sss::vulkan::SSSKernel::calculateBurley(float width, const glm::vec3 &strength, const glm::vec3 &falloff, Data &data)
+{
+	// the separable kernel covers a radius of 0.5 * width. about 95% of the energy of the normalized diffusion profile
+	// lies within 8 * d, so the widest channel (falloff 1.0) is fit to that radius
+	const float SHAPE_SCALE = 0.5f / 8.0f;
+
+	for (int i = 0; i < 3; ++i)
+	{
+		data.burleyShape[i] = std::max(width * falloff[i] * SHAPE_SCALE, 1e-6f);
+	}
+	data.burleyShape.w = std::max(data.burleyShape.x, std::max(data.burleyShape.y, data.burleyShape.z));
+	data.burleyStrength = glm::vec4(strength, 0.0f);
+}
@@ -0,0 +1,36 @@
+#pragma once
+#include <cstdint>
+#include <glm/vec3.hpp>
+#include <glm/vec4.hpp>
+
+namespace sss
+{
+	namespace vulkan
+	{
+		namespace SSSKernel
+		{
+			enum
+			{
+				MAX_SAMPLE_COUNT = 25,
+				MAX_PROFILE_COUNT = 4,
+			};
+
+			// one entry of the diffusion profile table consumed by sssBlur_comp.comp and sssBurley_comp.comp
+			struct Data
+			{
+				glm::vec4 kernel[MAX_SAMPLE_COUNT]; // rgb: weight, a: offset in [-range, range]; the center sample comes first
+				float width; // world space scattering width; not touched by calculate()
+				uint32_t sampleCount;
+				uint32_t pad[2];
+				glm::vec4 burleyShape; // rgb: world space shape parameter d of the normalized diffusion profile, a: max of rgb
+				glm::vec4 burleyStrength; // rgb: strength, a: unused
+			};
+
+			// calculates a separable kernel from the skin profile of [Jimenez15] with the given per channel strength and falloff
+			void calculate(uint32_t sampleCount, const glm::vec3 &strength, const glm::vec3 &falloff, Data &data);
+
+			// fits the parameters of Burley's normalized diffusion profile to roughly cover the same radius as the separable kernel
+			void calculateBurley(float width, const glm::vec3 &strength, const glm::vec3 &falloff, Data &data);
+		}
+	}
+}
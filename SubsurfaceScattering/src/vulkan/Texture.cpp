@@ -1,33 +1,42 @@
 #include "Texture.h"
 #include "utility/ContainerUtility.h"
 #include "utility/Utility.h"
+#include "utility/AssetFile.h"
 #include "VKUtility.h"
-#include <gli/texture.hpp>
-#include <gli/load.hpp>
+#include "UploadManager.h"
+#include "TextureFile.h"
 
-std::shared_ptr<sss::vulkan::Texture> sss::vulkan::Texture::load(VkPhysicalDevice physicalDevice, VkDevice device, VkQueue queue, VkCommandPool cmdPool, const char *path, bool cube)
+std::shared_ptr<sss::vulkan::Texture> sss::vulkan::Texture::load(MemoryAllocator &allocator, VkDevice device, UploadManager &uploadManager, const char *path, bool cube)
 {
 	std::shared_ptr<Texture> texture = std::make_shared<Texture>();
 
 	// load texture
 	{
-		gli::texture gliTex(gli::load(path));
+		// the levels are copied from the mapped file straight into the staging ring, so they are copied only once
+		const util::AssetFile file(path);
+		TextureFileDesc desc;
 		{
-			if (gliTex.empty())
+			std::string error;
+			if (!parseTextureFile(file.getData(), file.getSize(), desc, error))
 			{
-				util::fatalExit(("Failed to load texture: " + std::string(path)).c_str(), EXIT_FAILURE);
+				util::fatalExit(("Failed to load texture: " + std::string(path) + "\n" + error).c_str(), EXIT_FAILURE);
+			}
+			if (desc.cube != cube)
+			{
+				util::fatalExit(("Failed to load texture: " + std::string(path) + (cube ? "\nExpected a cube map" : "\nUnexpected cube map")).c_str(), EXIT_FAILURE);
 			}
 		}
 
 		// fill out info values
+		texture->m_allocator = &allocator;
 		texture->m_device = device;
-		texture->m_imageType = VK_IMAGE_TYPE_2D;
-		texture->m_format = VkFormat(gliTex.format());
-		texture->m_width = static_cast<uint32_t>(gliTex.extent().x);
-		texture->m_height = static_cast<uint32_t>(gliTex.extent().y);
-		texture->m_depth = static_cast<uint32_t>(gliTex.extent().z);
-		texture->m_mipLevels = static_cast<uint32_t>(gliTex.levels());
-		texture->m_arrayLayers = cube ? static_cast<uint32_t>(gliTex.faces()) : static_cast<uint32_t>(gliTex.layers());
+		texture->m_imageType = desc.imageType;
+		texture->m_format = desc.format;
+		texture->m_width = desc.width;
+		texture->m_height = desc.height;
+		texture->m_depth = desc.depth;
+		texture->m_mipLevels = desc.levels;
+		texture->m_arrayLayers = desc.layers;
 
 		// load image
 		{
@@ -46,7 +55,7 @@ std::shared_ptr<sss::vulkan::Texture> sss::vulkan::Texture::load(VkPhysicalDevic
 			imageCreateInfo.sharingMode = VK_SHARING_MODE_EXCLUSIVE;
 			imageCreateInfo.initialLayout = VK_IMAGE_LAYOUT_UNDEFINED;
 
-			if (vkutil::createImage(physicalDevice, device, imageCreateInfo, VK_MEMORY_PROPERTY_DEVICE_LOCAL_BIT, 0, texture->m_image, texture->m_deviceMemory) != VK_SUCCESS)
+			if (vkutil::createImage(allocator, imageCreateInfo, VK_MEMORY_PROPERTY_DEVICE_LOCAL_BIT, 0, MEMORY_POOL_DEFAULT, texture->m_image, texture->m_allocation) != VK_SUCCESS)
 			{
 				util::fatalExit(("Failed to create texture: " + std::string(path)).c_str(), EXIT_FAILURE);
 			}
@@ -56,105 +65,34 @@ std::shared_ptr<sss::vulkan::Texture> sss::vulkan::Texture::load(VkPhysicalDevic
 
 		// load image view
 		{
-			VkImageViewCreateInfo viewInfo{ VK_STRUCTURE_TYPE_IMAGE_VIEW_CREATE_INFO };
-			viewInfo.image = texture->m_image;
-			viewInfo.viewType = cube ? VK_IMAGE_VIEW_TYPE_CUBE : VK_IMAGE_VIEW_TYPE_2D;
-			viewInfo.format = texture->m_format;
-			viewInfo.subresourceRange = subresourceRange;
-
-			if (vkCreateImageView(device, &viewInfo, nullptr, &texture->m_view) != VK_SUCCESS)
+			VkImageViewType viewType = VK_IMAGE_VIEW_TYPE_2D;
+			if (cube)
 			{
-				util::fatalExit("Failed to create image view!", EXIT_FAILURE);
+				viewType = texture->m_arrayLayers > 6 ? VK_IMAGE_VIEW_TYPE_CUBE_ARRAY : VK_IMAGE_VIEW_TYPE_CUBE;
 			}
-		}
-
-		// staging buffer
-		VkBuffer stagingBuffer;
-		VkDeviceMemory stagingBufferMemory;
-		{
-			VkBufferCreateInfo createInfo{ VK_STRUCTURE_TYPE_BUFFER_CREATE_INFO };
-			createInfo.size = gliTex.size();
-			createInfo.usage = VK_BUFFER_USAGE_TRANSFER_SRC_BIT;
-			createInfo.sharingMode = VK_SHARING_MODE_EXCLUSIVE;
-
-			if (vkutil::createBuffer(physicalDevice, device, createInfo, VK_MEMORY_PROPERTY_HOST_VISIBLE_BIT | VK_MEMORY_PROPERTY_HOST_COHERENT_BIT, 0, stagingBuffer, stagingBufferMemory) != VK_SUCCESS)
+			else if (texture->m_imageType == VK_IMAGE_TYPE_3D)
 			{
-				util::fatalExit("Failed to create staging buffer!", EXIT_FAILURE);
+				viewType = VK_IMAGE_VIEW_TYPE_3D;
 			}
-		}
-
-		// write data to staging buffer
-		{
-			uint8_t *ptr;
-			if (vkMapMemory(device, stagingBufferMemory, 0, gliTex.size(), 0, (void **)&ptr) != VK_SUCCESS)
+			else if (texture->m_arrayLayers > 1)
 			{
-				util::fatalExit("Failed to map staging buffer memory!", EXIT_FAILURE);
+				viewType = VK_IMAGE_VIEW_TYPE_2D_ARRAY;
 			}
 
-			memcpy(ptr, gliTex.data(), gliTex.size());
-
-			vkUnmapMemory(device, stagingBufferMemory);
-		}
-
-		// copy from staging buffer to image
-		{
-			std::vector<VkBufferImageCopy> bufferCopyRegions;
-			uint32_t offset = 0;
-
-			for (uint32_t layer = 0; layer < texture->m_arrayLayers; ++layer)
-			{
-				for (uint32_t level = 0; level < texture->m_mipLevels; ++level)
-				{
-					VkBufferImageCopy bufferCopyRegion = {};
-					bufferCopyRegion.imageSubresource.aspectMask = VK_IMAGE_ASPECT_COLOR_BIT;
-					bufferCopyRegion.imageSubresource.mipLevel = level;
-					bufferCopyRegion.imageSubresource.baseArrayLayer = layer;
-					bufferCopyRegion.imageSubresource.layerCount = 1;
-					bufferCopyRegion.imageExtent.width = gliTex.extent(level).x;
-					bufferCopyRegion.imageExtent.height = gliTex.extent(level).y;
-					bufferCopyRegion.imageExtent.depth = gliTex.extent(level).z;
-					bufferCopyRegion.bufferOffset = offset;
-
-					bufferCopyRegions.push_back(bufferCopyRegion);
-
-					// Increase offset into staging buffer for next level / face
-					offset += gliTex.size(level);
-				}
-			}
-			assert(offset == gliTex.size());
+			VkImageViewCreateInfo viewInfo{ VK_STRUCTURE_TYPE_IMAGE_VIEW_CREATE_INFO };
+			viewInfo.image = texture->m_image;
+			viewInfo.viewType = viewType;
+			viewInfo.format = texture->m_format;
+			viewInfo.subresourceRange = subresourceRange;
 
-			// execute copy from staging buffer to image
-			VkCommandBuffer copyCmd = vkutil::beginSingleTimeCommands(device, cmdPool);
+			if (vkCreateImageView(device, &viewInfo, nullptr, &texture->m_view) != VK_SUCCESS)
 			{
-				VkImageMemoryBarrier imageBarrier{ VK_STRUCTURE_TYPE_IMAGE_MEMORY_BARRIER };
-				imageBarrier.srcAccessMask = 0;
-				imageBarrier.dstAccessMask = VK_ACCESS_TRANSFER_WRITE_BIT;
-				imageBarrier.oldLayout = VK_IMAGE_LAYOUT_UNDEFINED;
-				imageBarrier.newLayout = VK_IMAGE_LAYOUT_TRANSFER_DST_OPTIMAL;
-				imageBarrier.srcQueueFamilyIndex = VK_QUEUE_FAMILY_IGNORED;
-				imageBarrier.dstQueueFamilyIndex = VK_QUEUE_FAMILY_IGNORED;
-				imageBarrier.image = texture->m_image;
-				imageBarrier.subresourceRange = subresourceRange;
-
-				vkCmdPipelineBarrier(copyCmd, VK_PIPELINE_STAGE_TOP_OF_PIPE_BIT, VK_PIPELINE_STAGE_TRANSFER_BIT, 0, 0, nullptr, 0, nullptr, 1, &imageBarrier);
-
-				vkCmdCopyBufferToImage(copyCmd, stagingBuffer, texture->m_image, VK_IMAGE_LAYOUT_TRANSFER_DST_OPTIMAL, static_cast<uint32_t>(bufferCopyRegions.size()), bufferCopyRegions.data());
-
-				imageBarrier.srcAccessMask = VK_ACCESS_TRANSFER_WRITE_BIT;
-				imageBarrier.dstAccessMask = 0;
-				imageBarrier.oldLayout = VK_IMAGE_LAYOUT_TRANSFER_DST_OPTIMAL;
-				imageBarrier.newLayout = VK_IMAGE_LAYOUT_SHADER_READ_ONLY_OPTIMAL;
-
-				vkCmdPipelineBarrier(copyCmd, VK_PIPELINE_STAGE_TRANSFER_BIT, VK_PIPELINE_STAGE_BOTTOM_OF_PIPE_BIT, 0, 0, nullptr, 0, nullptr, 1, &imageBarrier);
+				util::fatalExit("Failed to create image view!", EXIT_FAILURE);
 			}
-			vkutil::endSingleTimeCommands(device, queue, cmdPool, copyCmd);
 		}
 
-		// destroy staging buffer
-		{
-			vkDestroyBuffer(device, stagingBuffer, nullptr);
-			vkFreeMemory(device, stagingBufferMemory, nullptr);
-		}
+		// upload all levels and faces / layers
+		uploadManager.uploadImage(texture->m_image, subresourceRange, desc.texelBlockSize, desc.texelBlockExtent, static_cast<uint32_t>(desc.subresources.size()), desc.subresources.data());
 	}
 
 	return texture;
@@ -164,7 +102,7 @@ sss::vulkan::Texture::~Texture()
 {
 	vkDestroyImageView(m_device, m_view, nullptr);
 	vkDestroyImage(m_device, m_image, nullptr);
-	vkFreeMemory(m_device, m_deviceMemory, nullptr);
+	m_allocator->free(m_allocation);
 }
 
 VkImageView sss::vulkan::Texture::getView() const
@@ -1,15 +1,19 @@
 #pragma once
 #include "volk.h"
 #include <memory>
+#include "MemoryAllocator.h"
 
 namespace sss
 {
 	namespace vulkan
 	{
+		class UploadManager;
+
 		class Texture
 		{
 		public:
-			static std::shared_ptr<Texture> load(VkPhysicalDevice physicalDevice, VkDevice device, VkQueue queue, VkCommandPool cmdPool, const char *path, bool cube = false);
+			// the texture is usable once the upload manager is flushed
+			static std::shared_ptr<Texture> load(MemoryAllocator &allocator, VkDevice device, UploadManager &uploadManager, const char *path, bool cube = false);
 			explicit Texture() = default;
 			Texture(const Texture &) = delete;
 			Texture(const Texture &&) = delete;
@@ -27,10 +31,11 @@ namespace sss
 			uint32_t getLayers() const;
 
 		private:
+			MemoryAllocator *m_allocator;
 			VkDevice m_device;
 			VkImageView m_view;
 			VkImage m_image;
-			VkDeviceMemory m_deviceMemory;
+			MemoryAllocator::Allocation m_allocation;
 			VkImageType m_imageType;
 			VkFormat m_format;
 			uint32_t m_width;
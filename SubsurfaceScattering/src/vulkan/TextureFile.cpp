@@ -0,0 +1,400 @@
+#include "TextureFile.h"
+#include <cstring>
+#include <algorithm>
+
+namespace
+{
+	struct FormatInfo
+	{
+		VkFormat format;
+		uint32_t blockSize; // bytes
+		uint32_t blockExtent; // texels, in x and y
+	};
+
+	const FormatInfo FORMAT_INFOS[] =
+	{
+		{ VK_FORMAT_R8_UNORM, 1, 1 },
+		{ VK_FORMAT_R8G8_UNORM, 2, 1 },
+		{ VK_FORMAT_R8G8B8A8_UNORM, 4, 1 },
+		{ VK_FORMAT_R8G8B8A8_SRGB, 4, 1 },
+		{ VK_FORMAT_B8G8R8A8_UNORM, 4, 1 },
+		{ VK_FORMAT_B8G8R8A8_SRGB, 4, 1 },
+		{ VK_FORMAT_A2B10G10R10_UNORM_PACK32, 4, 1 },
+		{ VK_FORMAT_B10G11R11_UFLOAT_PACK32, 4, 1 },
+		{ VK_FORMAT_R16_SFLOAT, 2, 1 },
+		{ VK_FORMAT_R16G16_SFLOAT, 4, 1 },
+		{ VK_FORMAT_R16G16B16A16_UNORM, 8, 1 },
+		{ VK_FORMAT_R16G16B16A16_SFLOAT, 8, 1 },
+		{ VK_FORMAT_R32_SFLOAT, 4, 1 },
+		{ VK_FORMAT_R32G32_SFLOAT, 8, 1 },
+		{ VK_FORMAT_R32G32B32A32_SFLOAT, 16, 1 },
+		{ VK_FORMAT_BC1_RGB_UNORM_BLOCK, 8, 4 },
+		{ VK_FORMAT_BC1_RGB_SRGB_BLOCK, 8, 4 },
+		{ VK_FORMAT_BC1_RGBA_UNORM_BLOCK, 8, 4 },
+		{ VK_FORMAT_BC1_RGBA_SRGB_BLOCK, 8, 4 },
+		{ VK_FORMAT_BC2_UNORM_BLOCK, 16, 4 },
+		{ VK_FORMAT_BC2_SRGB_BLOCK, 16, 4 },
+		{ VK_FORMAT_BC3_UNORM_BLOCK, 16, 4 },
+		{ VK_FORMAT_BC3_SRGB_BLOCK, 16, 4 },
+		{ VK_FORMAT_BC4_UNORM_BLOCK, 8, 4 },
+		{ VK_FORMAT_BC4_SNORM_BLOCK, 8, 4 },
+		{ VK_FORMAT_BC5_UNORM_BLOCK, 16, 4 },
+		{ VK_FORMAT_BC5_SNORM_BLOCK, 16, 4 },
+		{ VK_FORMAT_BC6H_UFLOAT_BLOCK, 16, 4 },
+		{ VK_FORMAT_BC6H_SFLOAT_BLOCK, 16, 4 },
+		{ VK_FORMAT_BC7_UNORM_BLOCK, 16, 4 },
+		{ VK_FORMAT_BC7_SRGB_BLOCK, 16, 4 },
+	};
+
+	const FormatInfo *findFormatInfo(VkFormat format)
+	{
+		for (const auto &info : FORMAT_INFOS)
+		{
+			if (info.format == format)
+			{
+				return &info;
+			}
+		}
+		return nullptr;
+	}
+
+	constexpr uint32_t makeFourCC(char a, char b, char c, char d)
+	{
+		return uint32_t(uint8_t(a)) | (uint32_t(uint8_t(b)) << 8) | (uint32_t(uint8_t(c)) << 16) | (uint32_t(uint8_t(d)) << 24);
+	}
+
+	template<typename T>
+	T readValue(const uint8_t *data, size_t offset)
+	{
+		T value;
+		memcpy(&value, data + offset, sizeof(value));
+		return value;
+	}
+
+	// size of one mip level of a single layer or face
+	uint64_t getLevelSize(const FormatInfo &info, uint32_t width, uint32_t height, uint32_t depth)
+	{
+		const uint64_t blocksX = (width + info.blockExtent - 1) / info.blockExtent;
+		const uint64_t blocksY = (height + info.blockExtent - 1) / info.blockExtent;
+		return blocksX * blocksY * depth * info.blockSize;
+	}
+
+	VkExtent3D getLevelExtent(const sss::vulkan::TextureFileDesc &desc, uint32_t level)
+	{
+		return { std::max(1u, desc.width >> level), std::max(1u, desc.height >> level), std::max(1u, desc.depth >> level) };
+	}
+
+	// fills out the fields of desc that follow from the format and the extent
+	bool initDesc(sss::vulkan::TextureFileDesc &desc, const FormatInfo *&info, std::string &error)
+	{
+		info = findFormatInfo(desc.format);
+		if (!info)
+		{
+			error = "Unsupported format " + std::to_string(desc.format);
+			return false;
+		}
+
+		// 2048 is the smallest maxImageArrayLayers limit vulkan allows
+		if (desc.width == 0 || desc.height == 0 || desc.depth == 0 || desc.layers == 0 || desc.layers > 2048 || desc.levels == 0 || (desc.depth > 1 && desc.layers > 1))
+		{
+			error = "Invalid extent";
+			return false;
+		}
+
+		if (desc.levels > 32 || (std::max({ desc.width, desc.height, desc.depth }) >> (desc.levels - 1)) == 0)
+		{
+			error = "Invalid mip level count";
+			return false;
+		}
+
+		desc.imageType = desc.depth > 1 ? VK_IMAGE_TYPE_3D : VK_IMAGE_TYPE_2D;
+		desc.texelBlockSize = info->blockSize;
+		desc.texelBlockExtent = info->blockExtent;
+		desc.subresources.clear();
+		desc.subresources.reserve(desc.levels * desc.layers);
+
+		return true;
+	}
+
+	void addSubresource(sss::vulkan::TextureFileDesc &desc, const uint8_t *data, uint64_t size, uint32_t level, uint32_t layer)
+	{
+		sss::vulkan::UploadManager::ImageSubresourceData subresource{};
+		subresource.data = data;
+		subresource.size = size;
+		subresource.subresource.aspectMask = VK_IMAGE_ASPECT_COLOR_BIT;
+		subresource.subresource.mipLevel = level;
+		subresource.subresource.baseArrayLayer = layer;
+		subresource.subresource.layerCount = 1;
+		subresource.extent = getLevelExtent(desc, level);
+		desc.subresources.push_back(subresource);
+	}
+
+	VkFormat translateDXGIFormat(uint32_t dxgiFormat)
+	{
+		switch (dxgiFormat)
+		{
+		case 2: return VK_FORMAT_R32G32B32A32_SFLOAT;
+		case 10: return VK_FORMAT_R16G16B16A16_SFLOAT;
+		case 11: return VK_FORMAT_R16G16B16A16_UNORM;
+		case 16: return VK_FORMAT_R32G32_SFLOAT;
+		case 24: return VK_FORMAT_A2B10G10R10_UNORM_PACK32;
+		case 26: return VK_FORMAT_B10G11R11_UFLOAT_PACK32;
+		case 28: return VK_FORMAT_R8G8B8A8_UNORM;
+		case 29: return VK_FORMAT_R8G8B8A8_SRGB;
+		case 34: return VK_FORMAT_R16G16_SFLOAT;
+		case 41: return VK_FORMAT_R32_SFLOAT;
+		case 49: return VK_FORMAT_R8G8_UNORM;
+		case 54: return VK_FORMAT_R16_SFLOAT;
+		case 61: return VK_FORMAT_R8_UNORM;
+		case 71: return VK_FORMAT_BC1_RGBA_UNORM_BLOCK;
+		case 72: return VK_FORMAT_BC1_RGBA_SRGB_BLOCK;
+		case 74: return VK_FORMAT_BC2_UNORM_BLOCK;
+		case 75: return VK_FORMAT_BC2_SRGB_BLOCK;
+		case 77: return VK_FORMAT_BC3_UNORM_BLOCK;
+		case 78: return VK_FORMAT_BC3_SRGB_BLOCK;
+		case 80: return VK_FORMAT_BC4_UNORM_BLOCK;
+		case 81: return VK_FORMAT_BC4_SNORM_BLOCK;
+		case 83: return VK_FORMAT_BC5_UNORM_BLOCK;
+		case 84: return VK_FORMAT_BC5_SNORM_BLOCK;
+		case 87: return VK_FORMAT_B8G8R8A8_UNORM;
+		case 91: return VK_FORMAT_B8G8R8A8_SRGB;
+		case 95: return VK_FORMAT_BC6H_UFLOAT_BLOCK;
+		case 96: return VK_FORMAT_BC6H_SFLOAT_BLOCK;
+		case 98: return VK_FORMAT_BC7_UNORM_BLOCK;
+		case 99: return VK_FORMAT_BC7_SRGB_BLOCK;
+		default: return VK_FORMAT_UNDEFINED;
+		}
+	}
+
+	// formats of dds files without the dx10 header extension
+	VkFormat translateLegacyDDSFormat(uint32_t flags, uint32_t fourCC, uint32_t bitCount, uint32_t rMask, uint32_t gMask, uint32_t bMask, uint32_t aMask)
+	{
+		const uint32_t DDPF_ALPHAPIXELS = 0x1;
+		const uint32_t DDPF_FOURCC = 0x4;
+		const uint32_t DDPF_RGB = 0x40;
+		const uint32_t DDPF_LUMINANCE = 0x20000;
+
+		if (flags & DDPF_FOURCC)
+		{
+			switch (fourCC)
+			{
+			case makeFourCC('D', 'X', 'T', '1'): return VK_FORMAT_BC1_RGBA_UNORM_BLOCK;
+			case makeFourCC('D', 'X', 'T', '2'):
+			case makeFourCC('D', 'X', 'T', '3'): return VK_FORMAT_BC2_UNORM_BLOCK;
+			case makeFourCC('D', 'X', 'T', '4'):
+			case makeFourCC('D', 'X', 'T', '5'): return VK_FORMAT_BC3_UNORM_BLOCK;
+			case makeFourCC('A', 'T', 'I', '1'):
+			case makeFourCC('B', 'C', '4', 'U'): return VK_FORMAT_BC4_UNORM_BLOCK;
+			case makeFourCC('B', 'C', '4', 'S'): return VK_FORMAT_BC4_SNORM_BLOCK;
+			case makeFourCC('A', 'T', 'I', '2'):
+			case makeFourCC('B', 'C', '5', 'U'): return VK_FORMAT_BC5_UNORM_BLOCK;
+			case makeFourCC('B', 'C', '5', 'S'): return VK_FORMAT_BC5_SNORM_BLOCK;
+			// d3d9 format enums stored in the fourcc field
+			case 36: return VK_FORMAT_R16G16B16A16_UNORM;
+			case 111: return VK_FORMAT_R16_SFLOAT;
+			case 112: return VK_FORMAT_R16G16_SFLOAT;
+			case 113: return VK_FORMAT_R16G16B16A16_SFLOAT;
+			case 114: return VK_FORMAT_R32_SFLOAT;
+			case 115: return VK_FORMAT_R32G32_SFLOAT;
+			case 116: return VK_FORMAT_R32G32B32A32_SFLOAT;
+			default: return VK_FORMAT_UNDEFINED;
+			}
+		}
+
+		if ((flags & DDPF_RGB) && bitCount == 32)
+		{
+			const uint32_t alphaMask = (flags & DDPF_ALPHAPIXELS) ? aMask : 0xFF000000;
+			if (rMask == 0x000000FF && gMask == 0x0000FF00 && bMask == 0x00FF0000 && alphaMask == 0xFF000000)
+			{
+				return VK_FORMAT_R8G8B8A8_UNORM;
+			}
+			if (rMask == 0x00FF0000 && gMask == 0x0000FF00 && bMask == 0x000000FF && alphaMask == 0xFF000000)
+			{
+				return VK_FORMAT_B8G8R8A8_UNORM;
+			}
+		}
+
+		if ((flags & (DDPF_LUMINANCE | DDPF_RGB)) && bitCount == 8 && rMask == 0xFF)
+		{
+			return VK_FORMAT_R8_UNORM;
+		}
+
+		return VK_FORMAT_UNDEFINED;
+	}
+
+	bool parseDDS(const uint8_t *data, size_t size, sss::vulkan::TextureFileDesc &desc, std::string &error)
+	{
+		const size_t HEADER_SIZE = 4 + 124;
+		const size_t DX10_HEADER_SIZE = 20;
+		const uint32_t DDSD_MIPMAPCOUNT = 0x20000;
+		const uint32_t DDSD_DEPTH = 0x800000;
+		const uint32_t DDSCAPS2_CUBEMAP = 0x200;
+		const uint32_t DDSCAPS2_CUBEMAP_ALLFACES = 0xFC00;
+		const uint32_t DDSCAPS2_VOLUME = 0x200000;
+		const uint32_t DDS_RESOURCE_MISC_TEXTURECUBE = 0x4;
+
+		if (size < HEADER_SIZE || readValue<uint32_t>(data, 4) != 124 || readValue<uint32_t>(data, 4 + 72) != 32)
+		{
+			error = "Invalid dds header";
+			return false;
+		}
+
+		const uint32_t flags = readValue<uint32_t>(data, 4 + 4);
+		const uint32_t pixelFormatFlags = readValue<uint32_t>(data, 4 + 76);
+		const uint32_t fourCC = readValue<uint32_t>(data, 4 + 80);
+		const uint32_t caps2 = readValue<uint32_t>(data, 4 + 108);
+		const uint32_t mipMapCount = readValue<uint32_t>(data, 4 + 24);
+
+		desc.width = readValue<uint32_t>(data, 4 + 12);
+		desc.height = readValue<uint32_t>(data, 4 + 8);
+		desc.depth = (flags & DDSD_DEPTH) && (caps2 & DDSCAPS2_VOLUME) ? readValue<uint32_t>(data, 4 + 20) : 1;
+		desc.levels = (flags & DDSD_MIPMAPCOUNT) && mipMapCount > 0 ? mipMapCount : 1;
+
+		size_t dataOffset = HEADER_SIZE;
+
+		if ((pixelFormatFlags & 0x4) && fourCC == makeFourCC('D', 'X', '1', '0'))
+		{
+			if (size < HEADER_SIZE + DX10_HEADER_SIZE)
+			{
+				error = "Invalid dds header";
+				return false;
+			}
+
+			desc.format = translateDXGIFormat(readValue<uint32_t>(data, HEADER_SIZE));
+			desc.cube = (readValue<uint32_t>(data, HEADER_SIZE + 8) & DDS_RESOURCE_MISC_TEXTURECUBE) != 0;
+			desc.layers = std::max(1u, readValue<uint32_t>(data, HEADER_SIZE + 12)) * (desc.cube ? 6 : 1);
+			dataOffset += DX10_HEADER_SIZE;
+		}
+		else
+		{
+			desc.format = translateLegacyDDSFormat(pixelFormatFlags, fourCC, readValue<uint32_t>(data, 4 + 84),
+				readValue<uint32_t>(data, 4 + 88), readValue<uint32_t>(data, 4 + 92), readValue<uint32_t>(data, 4 + 96), readValue<uint32_t>(data, 4 + 100));
+			desc.cube = (caps2 & DDSCAPS2_CUBEMAP) != 0;
+			desc.layers = desc.cube ? 6 : 1;
+
+			if (desc.cube && (caps2 & DDSCAPS2_CUBEMAP_ALLFACES) != DDSCAPS2_CUBEMAP_ALLFACES)
+			{
+				error = "Cube maps without all faces are not supported";
+				return false;
+			}
+		}
+
+		const FormatInfo *info;
+		if (!initDesc(desc, info, error))
+		{
+			return false;
+		}
+
+		// dds stores all levels of a layer or face before the next one
+		uint64_t offset = dataOffset;
+		for (uint32_t layer = 0; layer < desc.layers; ++layer)
+		{
+			for (uint32_t level = 0; level < desc.levels; ++level)
+			{
+				const VkExtent3D extent = getLevelExtent(desc, level);
+				const uint64_t levelSize = getLevelSize(*info, extent.width, extent.height, extent.depth);
+
+				if (offset + levelSize > size)
+				{
+					error = "File is truncated";
+					return false;
+				}
+
+				addSubresource(desc, data + offset, levelSize, level, layer);
+				offset += levelSize;
+			}
+		}
+
+		return true;
+	}
+
+	bool parseKTX2(const uint8_t *data, size_t size, sss::vulkan::TextureFileDesc &desc, std::string &error)
+	{
+		const size_t HEADER_SIZE = 80;
+		const size_t LEVEL_INDEX_ENTRY_SIZE = 24;
+
+		if (size < HEADER_SIZE)
+		{
+			error = "Invalid ktx2 header";
+			return false;
+		}
+
+		const uint32_t faceCount = readValue<uint32_t>(data, 36);
+		const uint32_t layerCount = std::max(1u, readValue<uint32_t>(data, 32));
+		const uint32_t supercompressionScheme = readValue<uint32_t>(data, 44);
+
+		if (supercompressionScheme != 0)
+		{
+			error = "Supercompressed ktx2 files are not supported";
+			return false;
+		}
+
+		if (faceCount != 1 && faceCount != 6)
+		{
+			error = "Invalid ktx2 face count";
+			return false;
+		}
+
+		desc.format = static_cast<VkFormat>(readValue<uint32_t>(data, 12));
+		desc.width = readValue<uint32_t>(data, 20);
+		desc.height = std::max(1u, readValue<uint32_t>(data, 24));
+		desc.depth = std::max(1u, readValue<uint32_t>(data, 28));
+		desc.levels = std::max(1u, readValue<uint32_t>(data, 40)); // 0 requests mip generation, which is not supported; only the base level is used
+		desc.cube = faceCount == 6;
+		desc.layers = layerCount * faceCount;
+
+		const FormatInfo *info;
+		if (!initDesc(desc, info, error))
+		{
+			return false;
+		}
+
+		if (HEADER_SIZE + desc.levels * LEVEL_INDEX_ENTRY_SIZE > size)
+		{
+			error = "Invalid ktx2 level index";
+			return false;
+		}
+
+		// ktx2 stores each level with all its layers and faces. the level index is in the order of the levels
+		for (uint32_t level = 0; level < desc.levels; ++level)
+		{
+			const uint64_t byteOffset = readValue<uint64_t>(data, HEADER_SIZE + level * LEVEL_INDEX_ENTRY_SIZE);
+			const uint64_t byteLength = readValue<uint64_t>(data, HEADER_SIZE + level * LEVEL_INDEX_ENTRY_SIZE + 8);
+
+			const VkExtent3D extent = getLevelExtent(desc, level);
+			const uint64_t levelSize = getLevelSize(*info, extent.width, extent.height, extent.depth);
+
+			if (byteOffset > size || byteLength > size - byteOffset || levelSize * desc.layers > byteLength)
+			{
+				error = "File is truncated";
+				return false;
+			}
+
+			for (uint32_t layer = 0; layer < desc.layers; ++layer)
+			{
+				addSubresource(desc, data + byteOffset + layer * levelSize, levelSize, level, layer);
+			}
+		}
+
+		return true;
+	}
+}
+
+bool sss::vulkan::parseTextureFile(const uint8_t *data, size_t size, TextureFileDesc &desc, std::string &error)
+{
+	const uint8_t KTX2_IDENTIFIER[12] = { 0xAB, 'K', 'T', 'X', ' ', '2', '0', 0xBB, '\r', '\n', 0x1A, '\n' };
+
+	desc = {};
+
+	if (size >= 4 && readValue<uint32_t>(data, 0) == makeFourCC('D', 'D', 'S', ' '))
+	{
+		return parseDDS(data, size, desc, error);
+	}
+	else if (size >= sizeof(KTX2_IDENTIFIER) && memcmp(data, KTX2_IDENTIFIER, sizeof(KTX2_IDENTIFIER)) == 0)
+	{
+		return parseKTX2(data, size, desc, error);
+	}
+
+	error = "Unknown file format, expected dds or ktx2";
+	return false;
+}
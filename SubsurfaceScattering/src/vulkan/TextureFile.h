@@ -0,0 +1,31 @@
+#pragma once
+#include "volk.h"
+#include <vector>
+#include <string>
+#include "UploadManager.h"
+
+namespace sss
+{
+	namespace vulkan
+	{
+		// layout of a .dds or .ktx2 file. the subresource data points into the parsed file, so the file has to outlive it
+		struct TextureFileDesc
+		{
+			VkFormat format;
+			VkImageType imageType;
+			uint32_t width;
+			uint32_t height;
+			uint32_t depth;
+			uint32_t levels;
+			uint32_t layers; // faces count as layers
+			bool cube;
+			uint32_t texelBlockSize; // size in bytes of a texel or compressed block
+			uint32_t texelBlockExtent; // width and height in texels of a texel or compressed block
+			std::vector<UploadManager::ImageSubresourceData> subresources;
+		};
+
+		// reads the header of a dds or ktx2 file and locates the data of every level and layer in place, without copying it.
+		// returns false with a message in error for invalid files and unsupported formats or supercompression
+		bool parseTextureFile(const uint8_t *data, size_t size, TextureFileDesc &desc, std::string &error);
+	}
+}
@@ -0,0 +1,401 @@
+#include "UploadManager.h"
+#include "VKUtility.h"
+#include "utility/Utility.h"
+#include <numeric>
+#include <cstring>
+#include <algorithm>
+#include <cassert>
+
+namespace
+{
+	const VkDeviceSize STAGING_RING_SIZE = 64 * 1024 * 1024;
+	const uint32_t BATCH_COUNT = 4;
+	// a batch is submitted once it staged this much data, so that the gpu starts copying early
+	const VkDeviceSize BATCH_SUBMIT_SIZE = STAGING_RING_SIZE / BATCH_COUNT;
+	const uint32_t INVALID_BATCH = ~0u;
+}
+
+sss::vulkan::UploadManager::UploadManager(MemoryAllocator &allocator, VkDevice device, VkQueue transferQueue, uint32_t transferQueueFamilyIndex,
+	VkQueue graphicsQueue, uint32_t graphicsQueueFamilyIndex, VkCommandPool graphicsCommandPool)
+	:m_allocator(allocator),
+	m_device(device),
+	m_transferQueue(transferQueue),
+	m_transferQueueFamilyIndex(transferQueueFamilyIndex),
+	m_graphicsQueue(graphicsQueue),
+	m_graphicsQueueFamilyIndex(graphicsQueueFamilyIndex),
+	m_graphicsCommandPool(graphicsCommandPool),
+	m_ringHead(),
+	m_ringTail(),
+	m_batches(BATCH_COUNT),
+	m_recordingBatch(INVALID_BATCH)
+{
+	// command pool
+	{
+		VkCommandPoolCreateInfo createInfo{ VK_STRUCTURE_TYPE_COMMAND_POOL_CREATE_INFO };
+		createInfo.queueFamilyIndex = m_transferQueueFamilyIndex;
+		createInfo.flags = VK_COMMAND_POOL_CREATE_RESET_COMMAND_BUFFER_BIT;
+
+		if (vkCreateCommandPool(m_device, &createInfo, nullptr, &m_commandPool) != VK_SUCCESS)
+		{
+			util::fatalExit("Failed to create upload command pool!", EXIT_FAILURE);
+		}
+	}
+
+	// batches
+	for (uint32_t i = 0; i < BATCH_COUNT; ++i)
+	{
+		Batch &batch = m_batches[i];
+
+		VkCommandBufferAllocateInfo allocInfo{ VK_STRUCTURE_TYPE_COMMAND_BUFFER_ALLOCATE_INFO };
+		allocInfo.commandPool = m_commandPool;
+		allocInfo.level = VK_COMMAND_BUFFER_LEVEL_PRIMARY;
+		allocInfo.commandBufferCount = 1;
+
+		if (vkAllocateCommandBuffers(m_device, &allocInfo, &batch.commandBuffer) != VK_SUCCESS)
+		{
+			util::fatalExit("Failed to allocate upload command buffer!", EXIT_FAILURE);
+		}
+
+		VkFenceCreateInfo fenceCreateInfo{ VK_STRUCTURE_TYPE_FENCE_CREATE_INFO };
+
+		if (vkCreateFence(m_device, &fenceCreateInfo, nullptr, &batch.fence) != VK_SUCCESS)
+		{
+			util::fatalExit("Failed to create upload fence!", EXIT_FAILURE);
+		}
+
+		batch.ringEnd = 0;
+		batch.stagedSize = 0;
+
+		m_freeBatches.push_back(i);
+	}
+
+	// staging ring
+	{
+		VkBufferCreateInfo createInfo{ VK_STRUCTURE_TYPE_BUFFER_CREATE_INFO };
+		createInfo.size = STAGING_RING_SIZE;
+		createInfo.usage = VK_BUFFER_USAGE_TRANSFER_SRC_BIT;
+		createInfo.sharingMode = VK_SHARING_MODE_EXCLUSIVE;
+
+		if (vkutil::createBuffer(m_allocator, createInfo, VK_MEMORY_PROPERTY_HOST_VISIBLE_BIT | VK_MEMORY_PROPERTY_HOST_COHERENT_BIT, 0, MEMORY_POOL_DEFAULT, m_stagingBuffer, m_stagingBufferAllocation) != VK_SUCCESS)
+		{
+			util::fatalExit("Failed to create staging buffer!", EXIT_FAILURE);
+		}
+	}
+}
+
+sss::vulkan::UploadManager::~UploadManager()
+{
+	{
+		std::lock_guard<std::mutex> lock(m_mutex);
+
+		if (m_recordingBatch != INVALID_BATCH)
+		{
+			submitRecordingBatch();
+		}
+
+		while (!m_submittedBatches.empty())
+		{
+			retireOldestBatch();
+		}
+	}
+
+	for (auto &batch : m_batches)
+	{
+		vkDestroyFence(m_device, batch.fence, nullptr);
+	}
+
+	vkDestroyCommandPool(m_device, m_commandPool, nullptr);
+	vkDestroyBuffer(m_device, m_stagingBuffer, nullptr);
+	m_allocator.free(m_stagingBufferAllocation);
+}
+
+void sss::vulkan::UploadManager::uploadBuffer(VkBuffer buffer, VkDeviceSize offset, const void *data, VkDeviceSize size)
+{
+	std::lock_guard<std::mutex> lock(m_mutex);
+
+	const bool ownershipTransfer = m_transferQueueFamilyIndex != m_graphicsQueueFamilyIndex;
+
+	// large buffers are split into chunks, so they do not stall on the ring and are spread over several batches
+	const uint8_t *src = reinterpret_cast<const uint8_t *>(data);
+	for (VkDeviceSize copied = 0; copied < size;)
+	{
+		const VkDeviceSize chunkSize = std::min(size - copied, BATCH_SUBMIT_SIZE);
+		const VkDeviceSize stagingOffset = allocateStaging(chunkSize, 4);
+
+		memcpy(m_stagingBufferAllocation.mappedPtr + stagingOffset, src + copied, chunkSize);
+
+		Batch &batch = getRecordingBatch();
+
+		VkBufferCopy bufferCopy{ stagingOffset, offset + copied, chunkSize };
+		vkCmdCopyBuffer(batch.commandBuffer, m_stagingBuffer, buffer, 1, &bufferCopy);
+
+		copied += chunkSize;
+
+		if (batch.stagedSize >= BATCH_SUBMIT_SIZE && copied < size)
+		{
+			submitRecordingBatch();
+		}
+	}
+
+	VkBufferMemoryBarrier bufferBarrier{ VK_STRUCTURE_TYPE_BUFFER_MEMORY_BARRIER };
+	bufferBarrier.srcAccessMask = VK_ACCESS_TRANSFER_WRITE_BIT;
+	bufferBarrier.dstAccessMask = ownershipTransfer ? 0 : VK_ACCESS_MEMORY_READ_BIT;
+	bufferBarrier.srcQueueFamilyIndex = ownershipTransfer ? m_transferQueueFamilyIndex : VK_QUEUE_FAMILY_IGNORED;
+	bufferBarrier.dstQueueFamilyIndex = ownershipTransfer ? m_graphicsQueueFamilyIndex : VK_QUEUE_FAMILY_IGNORED;
+	bufferBarrier.buffer = buffer;
+	bufferBarrier.offset = offset;
+	bufferBarrier.size = size;
+
+	Batch &batch = getRecordingBatch();
+
+	vkCmdPipelineBarrier(batch.commandBuffer, VK_PIPELINE_STAGE_TRANSFER_BIT, ownershipTransfer ? VK_PIPELINE_STAGE_BOTTOM_OF_PIPE_BIT : VK_PIPELINE_STAGE_ALL_COMMANDS_BIT, 0, 0, nullptr, 1, &bufferBarrier, 0, nullptr);
+
+	if (ownershipTransfer)
+	{
+		bufferBarrier.srcAccessMask = 0;
+		bufferBarrier.dstAccessMask = VK_ACCESS_MEMORY_READ_BIT;
+		m_bufferAcquireBarriers.push_back(bufferBarrier);
+	}
+
+	if (batch.stagedSize >= BATCH_SUBMIT_SIZE)
+	{
+		submitRecordingBatch();
+	}
+}
+
+void sss::vulkan::UploadManager::uploadImage(VkImage image, const VkImageSubresourceRange &subresourceRange, uint32_t texelBlockSize, uint32_t texelBlockExtent, uint32_t subresourceCount, const ImageSubresourceData *subresources)
+{
+	std::lock_guard<std::mutex> lock(m_mutex);
+
+	const bool ownershipTransfer = m_transferQueueFamilyIndex != m_graphicsQueueFamilyIndex;
+
+	VkImageMemoryBarrier imageBarrier{ VK_STRUCTURE_TYPE_IMAGE_MEMORY_BARRIER };
+	imageBarrier.srcAccessMask = 0;
+	imageBarrier.dstAccessMask = VK_ACCESS_TRANSFER_WRITE_BIT;
+	imageBarrier.oldLayout = VK_IMAGE_LAYOUT_UNDEFINED;
+	imageBarrier.newLayout = VK_IMAGE_LAYOUT_TRANSFER_DST_OPTIMAL;
+	imageBarrier.srcQueueFamilyIndex = VK_QUEUE_FAMILY_IGNORED;
+	imageBarrier.dstQueueFamilyIndex = VK_QUEUE_FAMILY_IGNORED;
+	imageBarrier.image = image;
+	imageBarrier.subresourceRange = subresourceRange;
+
+	vkCmdPipelineBarrier(getRecordingBatch().commandBuffer, VK_PIPELINE_STAGE_TOP_OF_PIPE_BIT, VK_PIPELINE_STAGE_TRANSFER_BIT, 0, 0, nullptr, 0, nullptr, 1, &imageBarrier);
+
+	// buffer offsets of image copies must be a multiple of 4 and of the texel block size
+	const VkDeviceSize alignment = std::lcm(VkDeviceSize(4), VkDeviceSize(texelBlockSize));
+
+	for (uint32_t i = 0; i < subresourceCount; ++i)
+	{
+		const ImageSubresourceData &subresource = subresources[i];
+		const uint8_t *src = reinterpret_cast<const uint8_t *>(subresource.data);
+		const VkExtent3D &extent = subresource.extent;
+
+		// large subresources are split into chunks of whole slices or, if a single slice is too large, of whole block rows,
+		// the same as large buffers. the tightly packed source rows stay contiguous, so the copies need no row length
+		const VkDeviceSize rowPitch = VkDeviceSize((extent.width + texelBlockExtent - 1) / texelBlockExtent) * texelBlockSize;
+		const uint32_t rowCount = (extent.height + texelBlockExtent - 1) / texelBlockExtent;
+		const VkDeviceSize slicePitch = rowPitch * rowCount;
+		assert(slicePitch * extent.depth == subresource.size);
+
+		if (rowPitch > STAGING_RING_SIZE)
+		{
+			util::fatalExit("Image row exceeds the staging ring size!", EXIT_FAILURE);
+		}
+
+		const bool splitSlices = slicePitch > BATCH_SUBMIT_SIZE;
+		const uint32_t slicesPerChunk = splitSlices ? 1 : static_cast<uint32_t>(std::min<VkDeviceSize>(extent.depth, BATCH_SUBMIT_SIZE / slicePitch));
+		const uint32_t rowsPerChunk = splitSlices ? static_cast<uint32_t>(std::max<VkDeviceSize>(1, BATCH_SUBMIT_SIZE / rowPitch)) : rowCount;
+
+		for (uint32_t slice = 0; slice < extent.depth; slice += slicesPerChunk)
+		{
+			const uint32_t chunkSlices = std::min(slicesPerChunk, extent.depth - slice);
+
+			for (uint32_t row = 0; row < rowCount; row += rowsPerChunk)
+			{
+				const uint32_t chunkRows = std::min(rowsPerChunk, rowCount - row);
+				const VkDeviceSize chunkSize = rowPitch * chunkRows * chunkSlices;
+				const VkDeviceSize srcOffset = slicePitch * slice + rowPitch * row;
+
+				const VkDeviceSize stagingOffset = allocateStaging(chunkSize, alignment);
+
+				memcpy(m_stagingBufferAllocation.mappedPtr + stagingOffset, src + srcOffset, chunkSize);
+
+				Batch &batch = getRecordingBatch();
+
+				// the last row of blocks may extend past the edge of the image
+				const uint32_t offsetY = row * texelBlockExtent;
+
+				VkBufferImageCopy bufferImageCopy{};
+				bufferImageCopy.bufferOffset = stagingOffset;
+				bufferImageCopy.imageSubresource = subresource.subresource;
+				bufferImageCopy.imageOffset = { 0, static_cast<int32_t>(offsetY), static_cast<int32_t>(slice) };
+				bufferImageCopy.imageExtent = { extent.width, std::min(chunkRows * texelBlockExtent, extent.height - offsetY), chunkSlices };
+
+				vkCmdCopyBufferToImage(batch.commandBuffer, m_stagingBuffer, image, VK_IMAGE_LAYOUT_TRANSFER_DST_OPTIMAL, 1, &bufferImageCopy);
+
+				// later copies of this image may go into the next batch; the layout transition above still applies to them
+				const bool lastChunk = i + 1 == subresourceCount && slice + chunkSlices == extent.depth && row + chunkRows == rowCount;
+				if (batch.stagedSize >= BATCH_SUBMIT_SIZE && !lastChunk)
+				{
+					submitRecordingBatch();
+				}
+			}
+		}
+	}
+
+	imageBarrier.srcAccessMask = VK_ACCESS_TRANSFER_WRITE_BIT;
+	imageBarrier.dstAccessMask = ownershipTransfer ? 0 : VK_ACCESS_SHADER_READ_BIT;
+	imageBarrier.oldLayout = VK_IMAGE_LAYOUT_TRANSFER_DST_OPTIMAL;
+	imageBarrier.newLayout = VK_IMAGE_LAYOUT_SHADER_READ_ONLY_OPTIMAL;
+	imageBarrier.srcQueueFamilyIndex = ownershipTransfer ? m_transferQueueFamilyIndex : VK_QUEUE_FAMILY_IGNORED;
+	imageBarrier.dstQueueFamilyIndex = ownershipTransfer ? m_graphicsQueueFamilyIndex : VK_QUEUE_FAMILY_IGNORED;
+
+	Batch &batch = getRecordingBatch();
+
+	vkCmdPipelineBarrier(batch.commandBuffer, VK_PIPELINE_STAGE_TRANSFER_BIT, ownershipTransfer ? VK_PIPELINE_STAGE_BOTTOM_OF_PIPE_BIT : VK_PIPELINE_STAGE_ALL_COMMANDS_BIT, 0, 0, nullptr, 0, nullptr, 1, &imageBarrier);
+
+	// the acquire must repeat the layout transition of the release
+	if (ownershipTransfer)
+	{
+		imageBarrier.srcAccessMask = 0;
+		imageBarrier.dstAccessMask = VK_ACCESS_SHADER_READ_BIT;
+		m_imageAcquireBarriers.push_back(imageBarrier);
+	}
+
+	if (batch.stagedSize >= BATCH_SUBMIT_SIZE)
+	{
+		submitRecordingBatch();
+	}
+}
+
+void sss::vulkan::UploadManager::flush()
+{
+	std::lock_guard<std::mutex> lock(m_mutex);
+
+	if (m_recordingBatch != INVALID_BATCH)
+	{
+		submitRecordingBatch();
+	}
+
+	while (!m_submittedBatches.empty())
+	{
+		retireOldestBatch();
+	}
+
+	if (!m_imageAcquireBarriers.empty() || !m_bufferAcquireBarriers.empty())
+	{
+		VkCommandBuffer cmdBuf = vkutil::beginSingleTimeCommands(m_device, m_graphicsCommandPool);
+		{
+			vkCmdPipelineBarrier(cmdBuf, VK_PIPELINE_STAGE_TOP_OF_PIPE_BIT, VK_PIPELINE_STAGE_ALL_COMMANDS_BIT, 0, 0, nullptr,
+				static_cast<uint32_t>(m_bufferAcquireBarriers.size()), m_bufferAcquireBarriers.data(),
+				static_cast<uint32_t>(m_imageAcquireBarriers.size()), m_imageAcquireBarriers.data());
+		}
+		vkutil::endSingleTimeCommands(m_device, m_graphicsQueue, m_graphicsCommandPool, cmdBuf);
+
+		m_imageAcquireBarriers.clear();
+		m_bufferAcquireBarriers.clear();
+	}
+}
+
+VkDeviceSize sss::vulkan::UploadManager::allocateStaging(VkDeviceSize size, VkDeviceSize alignment)
+{
+	assert(size <= STAGING_RING_SIZE);
+
+	uint64_t begin;
+	for (;;)
+	{
+		// start over at the beginning of the ring once all staged data is consumed
+		if (m_submittedBatches.empty() && m_ringTail == m_ringHead)
+		{
+			m_ringHead = 0;
+			m_ringTail = 0;
+		}
+
+		const uint64_t ringOffset = m_ringHead % STAGING_RING_SIZE;
+		const uint64_t alignedRingOffset = (ringOffset + alignment - 1) / alignment * alignment;
+
+		// allocations never wrap around the end of the ring
+		begin = m_ringHead - ringOffset + (alignedRingOffset + size <= STAGING_RING_SIZE ? alignedRingOffset : STAGING_RING_SIZE);
+
+		if (begin + size - m_ringTail <= STAGING_RING_SIZE)
+		{
+			break;
+		}
+
+		// wait for the oldest batch, so that its staging data can be reused. unsubmitted data needs to be submitted first
+		if (m_submittedBatches.empty())
+		{
+			submitRecordingBatch();
+		}
+
+		retireOldestBatch();
+	}
+
+	m_ringHead = begin + size;
+
+	Batch &batch = getRecordingBatch();
+	batch.ringEnd = m_ringHead;
+	batch.stagedSize += size;
+
+	return begin % STAGING_RING_SIZE;
+}
+
+sss::vulkan::UploadManager::Batch &sss::vulkan::UploadManager::getRecordingBatch()
+{
+	if (m_recordingBatch == INVALID_BATCH)
+	{
+		if (m_freeBatches.empty())
+		{
+			retireOldestBatch();
+		}
+
+		m_recordingBatch = m_freeBatches.back();
+		m_freeBatches.pop_back();
+
+		Batch &batch = m_batches[m_recordingBatch];
+		batch.ringEnd = m_ringHead;
+		batch.stagedSize = 0;
+
+		vkResetCommandBuffer(batch.commandBuffer, 0);
+
+		VkCommandBufferBeginInfo beginInfo{ VK_STRUCTURE_TYPE_COMMAND_BUFFER_BEGIN_INFO };
+		beginInfo.flags = VK_COMMAND_BUFFER_USAGE_ONE_TIME_SUBMIT_BIT;
+
+		vkBeginCommandBuffer(batch.commandBuffer, &beginInfo);
+	}
+
+	return m_batches[m_recordingBatch];
+}
+
+void sss::vulkan::UploadManager::submitRecordingBatch()
+{
+	Batch &batch = m_batches[m_recordingBatch];
+
+	vkEndCommandBuffer(batch.commandBuffer);
+	vkResetFences(m_device, 1, &batch.fence);
+
+	VkSubmitInfo submitInfo{ VK_STRUCTURE_TYPE_SUBMIT_INFO };
+	submitInfo.commandBufferCount = 1;
+	submitInfo.pCommandBuffers = &batch.commandBuffer;
+
+	if (vkQueueSubmit(m_transferQueue, 1, &submitInfo, batch.fence) != VK_SUCCESS)
+	{
+		util::fatalExit("Failed to submit upload batch!", EXIT_FAILURE);
+	}
+
+	m_submittedBatches.push_back(m_recordingBatch);
+	m_recordingBatch = INVALID_BATCH;
+}
+
+void sss::vulkan::UploadManager::retireOldestBatch()
+{
+	const uint32_t batchIndex = m_submittedBatches.front();
+	m_submittedBatches.pop_front();
+
+	Batch &batch = m_batches[batchIndex];
+
+	vkWaitForFences(m_device, 1, &batch.fence, VK_TRUE, UINT64_MAX);
+
+	m_ringTail = batch.ringEnd;
+	m_freeBatches.push_back(batchIndex);
+}
@@ -0,0 +1,79 @@
+#pragma once
+#include "volk.h"
+#include <vector>
+#include <deque>
+#include <mutex>
+#include "MemoryAllocator.h"
+
+namespace sss
+{
+	namespace vulkan
+	{
+		// uploads buffer and image data through a persistently mapped staging ring. copies are recorded into a few batches
+		// that are submitted to the transfer queue as they fill up, so the gpu copies while the caller keeps loading.
+		// resources are released to the graphics queue family and only usable after flush(). thread safe, except for flush()
+		class UploadManager
+		{
+		public:
+			struct ImageSubresourceData
+			{
+				const void *data;
+				VkDeviceSize size;
+				VkImageSubresourceLayers subresource;
+				VkExtent3D extent;
+			};
+
+			explicit UploadManager(MemoryAllocator &allocator, VkDevice device, VkQueue transferQueue, uint32_t transferQueueFamilyIndex,
+				VkQueue graphicsQueue, uint32_t graphicsQueueFamilyIndex, VkCommandPool graphicsCommandPool);
+			UploadManager(const UploadManager &) = delete;
+			UploadManager(const UploadManager &&) = delete;
+			UploadManager &operator= (const UploadManager &) = delete;
+			UploadManager &operator= (const UploadManager &&) = delete;
+			~UploadManager();
+			void uploadBuffer(VkBuffer buffer, VkDeviceSize offset, const void *data, VkDeviceSize size);
+			// transitions the whole subresourceRange from VK_IMAGE_LAYOUT_UNDEFINED to VK_IMAGE_LAYOUT_SHADER_READ_ONLY_OPTIMAL.
+			// texelBlockSize is the size in bytes of a texel or compressed block of the image format, texelBlockExtent its width
+			// and height in texels. the subresource data has to be tightly packed
+			void uploadImage(VkImage image, const VkImageSubresourceRange &subresourceRange, uint32_t texelBlockSize, uint32_t texelBlockExtent, uint32_t subresourceCount, const ImageSubresourceData *subresources);
+			// submits all recorded copies, waits for them and acquires the uploaded resources on the graphics queue.
+			// must not be called concurrently with the other functions
+			void flush();
+
+		private:
+			struct Batch
+			{
+				VkCommandBuffer commandBuffer;
+				VkFence fence;
+				uint64_t ringEnd; // end of the staging data used by this batch
+				VkDeviceSize stagedSize;
+			};
+
+			MemoryAllocator &m_allocator;
+			VkDevice m_device;
+			VkQueue m_transferQueue;
+			uint32_t m_transferQueueFamilyIndex;
+			VkQueue m_graphicsQueue;
+			uint32_t m_graphicsQueueFamilyIndex;
+			VkCommandPool m_graphicsCommandPool;
+			VkCommandPool m_commandPool;
+			VkBuffer m_stagingBuffer;
+			MemoryAllocator::Allocation m_stagingBufferAllocation;
+			// monotonic positions in the staging ring, the buffer offset is the position modulo the ring size
+			uint64_t m_ringHead;
+			uint64_t m_ringTail;
+			std::vector<Batch> m_batches;
+			std::vector<uint32_t> m_freeBatches;
+			std::deque<uint32_t> m_submittedBatches;
+			uint32_t m_recordingBatch;
+			// queue family ownership transfers, recorded on the graphics queue by flush()
+			std::vector<VkImageMemoryBarrier> m_imageAcquireBarriers;
+			std::vector<VkBufferMemoryBarrier> m_bufferAcquireBarriers;
+			std::mutex m_mutex;
+
+			VkDeviceSize allocateStaging(VkDeviceSize size, VkDeviceSize alignment);
+			Batch &getRecordingBatch();
+			void submitRecordingBatch();
+			void retireOldestBatch();
+		};
+	}
+}
@@ -1,6 +1,7 @@
 #include "VKContext.h"
 #include <iostream>
 #include <set>
+#include <algorithm>
 #define GLFW_INCLUDE_NONE
 #include <GLFW/glfw3.h>
 #include "utility/Utility.h"
@@ -22,7 +23,14 @@ static VKAPI_ATTR VkBool32 VKAPI_CALL debugCallback(
 }
 
 sss::vulkan::VKContext::VKContext(void *windowHandle)
+	:m_instance(VK_NULL_HANDLE),
+	m_device(VK_NULL_HANDLE),
+	m_physicalDevice(VK_NULL_HANDLE),
+	m_surface(VK_NULL_HANDLE),
+	m_debugUtilsMessenger(VK_NULL_HANDLE)
 {
+	const bool headless = windowHandle == nullptr;
+
 	if (volkInitialize() != VK_SUCCESS)
 	{
 		util::fatalExit("Failed to initialize volk!", EXIT_FAILURE);
@@ -37,11 +45,15 @@ sss::vulkan::VKContext::VKContext(void *windowHandle)
 		appInfo.engineVersion = VK_MAKE_VERSION(1, 0, 0);
 		appInfo.apiVersion = VK_API_VERSION_1_0;
 
-		// extensions
-		uint32_t glfwExtensionCount = 0;
-		const char** glfwExtensions;
-		glfwExtensions = glfwGetRequiredInstanceExtensions(&glfwExtensionCount);
-		std::vector<const char*> extensions(glfwExtensions, glfwExtensions + static_cast<size_t>(glfwExtensionCount));
+		// extensions (a headless context does not need any surface extensions)
+		std::vector<const char*> extensions;
+		if (!headless)
+		{
+			uint32_t glfwExtensionCount = 0;
+			const char** glfwExtensions;
+			glfwExtensions = glfwGetRequiredInstanceExtensions(&glfwExtensionCount);
+			extensions.assign(glfwExtensions, glfwExtensions + static_cast<size_t>(glfwExtensionCount));
+		}
 
 		if (g_vulkanDebugCallBackEnabled)
 		{
@@ -107,6 +119,7 @@ sss::vulkan::VKContext::VKContext(void *windowHandle)
 	}
 
 	// create window surface
+	if (!headless)
 	{
 		if (glfwCreateWindowSurface(m_instance, static_cast<GLFWwindow *>(windowHandle), nullptr, &m_surface) != VK_SUCCESS)
 		{
@@ -114,7 +127,11 @@ sss::vulkan::VKContext::VKContext(void *windowHandle)
 		}
 	}
 
-	const char *const deviceExtensions[]{ VK_KHR_SWAPCHAIN_EXTENSION_NAME };
+	std::vector<const char *> deviceExtensions;
+	if (!headless)
+	{
+		deviceExtensions.push_back(VK_KHR_SWAPCHAIN_EXTENSION_NAME);
+	}
 
 	// pick physical device
 	{
@@ -133,6 +150,8 @@ sss::vulkan::VKContext::VKContext(void *windowHandle)
 		{
 			// find queue indices
 			int graphicsFamilyIndex = -1;
+			int computeFamilyIndex = -1;
+			int transferFamilyIndex = -1;
 			{
 				uint32_t queueFamilyCount = 0;
 				vkGetPhysicalDeviceQueueFamilyProperties(physicalDevice, &queueFamilyCount, nullptr);
@@ -144,8 +163,11 @@ sss::vulkan::VKContext::VKContext(void *windowHandle)
 				for (uint32_t i = 0; i < queueFamilies.size(); ++i)
 				{
 					// query present support
-					VkBool32 presentable = VK_FALSE;
-					vkGetPhysicalDeviceSurfaceSupportKHR(physicalDevice, i, m_surface, &presentable);
+					VkBool32 presentable = headless ? VK_TRUE : VK_FALSE;
+					if (!headless)
+					{
+						vkGetPhysicalDeviceSurfaceSupportKHR(physicalDevice, i, m_surface, &presentable);
+					}
 
 					auto &queueFamily = queueFamilies[i];
 
@@ -155,6 +177,27 @@ sss::vulkan::VKContext::VKContext(void *windowHandle)
 					{
 						graphicsFamilyIndex = i;
 					}
+
+					// a compute only family usually maps to the async compute engines of the gpu.
+					// timestamps are required for the gpu pass timings
+					if (queueFamily.queueCount > 0
+						&& (queueFamily.queueFlags & VK_QUEUE_COMPUTE_BIT)
+						&& !(queueFamily.queueFlags & VK_QUEUE_GRAPHICS_BIT)
+						&& queueFamily.timestampValidBits > 0)
+					{
+						computeFamilyIndex = i;
+					}
+
+					// a transfer only family usually maps to the copy engines. images of any size and offset must be copyable
+					if (queueFamily.queueCount > 0
+						&& (queueFamily.queueFlags & VK_QUEUE_TRANSFER_BIT)
+						&& !(queueFamily.queueFlags & (VK_QUEUE_GRAPHICS_BIT | VK_QUEUE_COMPUTE_BIT))
+						&& queueFamily.minImageTransferGranularity.width == 1
+						&& queueFamily.minImageTransferGranularity.height == 1
+						&& queueFamily.minImageTransferGranularity.depth == 1)
+					{
+						transferFamilyIndex = i;
+					}
 				}
 
 				if (graphicsFamilyIndex == -1)
@@ -172,7 +215,7 @@ sss::vulkan::VKContext::VKContext(void *windowHandle)
 				std::vector<VkExtensionProperties> availableExtensions(extensionCount);
 				vkEnumerateDeviceExtensionProperties(physicalDevice, nullptr, &extensionCount, availableExtensions.data());
 
-				std::set<std::string> requiredExtensions(std::begin(deviceExtensions), std::end(deviceExtensions));
+				std::set<std::string> requiredExtensions(deviceExtensions.begin(), deviceExtensions.end());
 
 				for (const auto& extension : availableExtensions)
 				{
@@ -183,8 +226,8 @@ sss::vulkan::VKContext::VKContext(void *windowHandle)
 			}
 
 			// test if the device supports a swapchain
-			bool swapChainAdequate = false;
-			if (extensionsSupported)
+			bool swapChainAdequate = headless;
+			if (extensionsSupported && !headless)
 			{
 				uint32_t formatCount = 0;
 				vkGetPhysicalDeviceSurfaceFormatsKHR(physicalDevice, m_surface, &formatCount, nullptr);
@@ -207,6 +250,8 @@ sss::vulkan::VKContext::VKContext(void *windowHandle)
 			{
 				m_physicalDevice = physicalDevice;
 				m_graphicsQueueFamilyIndex = static_cast<uint32_t>(graphicsFamilyIndex);
+				m_computeQueueFamilyIndex = computeFamilyIndex >= 0 ? static_cast<uint32_t>(computeFamilyIndex) : m_graphicsQueueFamilyIndex;
+				m_transferQueueFamilyIndex = transferFamilyIndex >= 0 ? static_cast<uint32_t>(transferFamilyIndex) : m_graphicsQueueFamilyIndex;
 				vkGetPhysicalDeviceProperties(physicalDevice, &m_properties);
 				m_features = supportedFeatures;
 				break;
@@ -223,10 +268,19 @@ sss::vulkan::VKContext::VKContext(void *windowHandle)
 	{
 
 		float queuePriority = 1.0f;
-		VkDeviceQueueCreateInfo queueCreateInfo{ VK_STRUCTURE_TYPE_DEVICE_QUEUE_CREATE_INFO };
-		queueCreateInfo.queueFamilyIndex = m_graphicsQueueFamilyIndex;
-		queueCreateInfo.queueCount = 1;
-		queueCreateInfo.pQueuePriorities = &queuePriority;
+		uint32_t queueCreateInfoCount = 0;
+		VkDeviceQueueCreateInfo queueCreateInfos[3];
+		for (uint32_t familyIndex : { m_graphicsQueueFamilyIndex, m_computeQueueFamilyIndex, m_transferQueueFamilyIndex })
+		{
+			if (std::none_of(queueCreateInfos, queueCreateInfos + queueCreateInfoCount, [familyIndex](const auto &info) { return info.queueFamilyIndex == familyIndex; }))
+			{
+				auto &queueCreateInfo = queueCreateInfos[queueCreateInfoCount++];
+				queueCreateInfo = { VK_STRUCTURE_TYPE_DEVICE_QUEUE_CREATE_INFO };
+				queueCreateInfo.queueFamilyIndex = familyIndex;
+				queueCreateInfo.queueCount = 1;
+				queueCreateInfo.pQueuePriorities = &queuePriority;
+			}
+		}
 
 		VkPhysicalDeviceFeatures deviceFeatures{};
 		deviceFeatures.samplerAnisotropy = VK_TRUE;
@@ -236,13 +290,13 @@ sss::vulkan::VKContext::VKContext(void *windowHandle)
 		m_enabledFeatures = deviceFeatures;
 
 		VkDeviceCreateInfo createInfo{ VK_STRUCTURE_TYPE_DEVICE_CREATE_INFO };
-		createInfo.queueCreateInfoCount = 1;
-		createInfo.pQueueCreateInfos = &queueCreateInfo;
+		createInfo.queueCreateInfoCount = queueCreateInfoCount;
+		createInfo.pQueueCreateInfos = queueCreateInfos;
 		createInfo.enabledLayerCount = 0;
 		createInfo.ppEnabledLayerNames = nullptr;
 		createInfo.pEnabledFeatures = &deviceFeatures;
-		createInfo.enabledExtensionCount = static_cast<uint32_t>(sizeof(deviceExtensions) / sizeof(deviceExtensions[0]));
-		createInfo.ppEnabledExtensionNames = deviceExtensions;
+		createInfo.enabledExtensionCount = static_cast<uint32_t>(deviceExtensions.size());
+		createInfo.ppEnabledExtensionNames = deviceExtensions.data();
 
 		if (vkCreateDevice(m_physicalDevice, &createInfo, nullptr, &m_device) != VK_SUCCESS)
 		{
@@ -250,10 +304,15 @@ sss::vulkan::VKContext::VKContext(void *windowHandle)
 		}
 
 		vkGetDeviceQueue(m_device, m_graphicsQueueFamilyIndex, 0, &m_graphicsQueue);
+		vkGetDeviceQueue(m_device, m_computeQueueFamilyIndex, 0, &m_computeQueue);
+		vkGetDeviceQueue(m_device, m_transferQueueFamilyIndex, 0, &m_transferQueue);
 	}
 
 	volkLoadDevice(m_device);
 
+	m_memoryAllocator = std::make_unique<MemoryAllocator>(m_physicalDevice, m_device);
+	m_pipelineCache = std::make_unique<PipelineCache>(m_device, m_properties, "pipelineCache.bin");
+
 	// create command pools
 	{
 		VkCommandPoolCreateInfo graphicsPoolInfo{ VK_STRUCTURE_TYPE_COMMAND_POOL_CREATE_INFO };
@@ -264,12 +323,31 @@ sss::vulkan::VKContext::VKContext(void *windowHandle)
 		{
 			util::fatalExit("Failed to create graphics command pool!", EXIT_FAILURE);
 		}
+
+		m_computeCommandPool = m_graphicsCommandPool;
+		if (hasDedicatedComputeQueue())
+		{
+			VkCommandPoolCreateInfo computePoolInfo{ VK_STRUCTURE_TYPE_COMMAND_POOL_CREATE_INFO };
+			computePoolInfo.queueFamilyIndex = m_computeQueueFamilyIndex;
+			computePoolInfo.flags = VK_COMMAND_POOL_CREATE_RESET_COMMAND_BUFFER_BIT;
+
+			if (vkCreateCommandPool(m_device, &computePoolInfo, nullptr, &m_computeCommandPool) != VK_SUCCESS)
+			{
+				util::fatalExit("Failed to create compute command pool!", EXIT_FAILURE);
+			}
+		}
 	}
 }
 
 sss::vulkan::VKContext::~VKContext()
 {
+	m_pipelineCache.reset();
+	m_memoryAllocator.reset();
 	vkDestroyCommandPool(m_device, m_graphicsCommandPool, nullptr);
+	if (hasDedicatedComputeQueue())
+	{
+		vkDestroyCommandPool(m_device, m_computeCommandPool, nullptr);
+	}
 	vkDestroyDevice(m_device, nullptr);
 
 	if (g_vulkanDebugCallBackEnabled)
@@ -280,7 +358,10 @@ sss::vulkan::VKContext::~VKContext()
 		}
 	}
 
-	vkDestroySurfaceKHR(m_instance, m_surface, nullptr);
+	if (m_surface != VK_NULL_HANDLE)
+	{
+		vkDestroySurfaceKHR(m_instance, m_surface, nullptr);
+	}
 	vkDestroyInstance(m_instance, nullptr);
 }
 
@@ -324,6 +405,16 @@ VkCommandPool sss::vulkan::VKContext::getGraphicsCommandPool() const
 	return m_graphicsCommandPool;
 }
 
+VkQueue sss::vulkan::VKContext::getComputeQueue() const
+{
+	return m_computeQueue;
+}
+
+VkCommandPool sss::vulkan::VKContext::getComputeCommandPool() const
+{
+	return m_computeCommandPool;
+}
+
 VkSurfaceKHR sss::vulkan::VKContext::getSurface() const
 {
 	return m_surface;
@@ -333,3 +424,43 @@ uint32_t sss::vulkan::VKContext::getGraphicsQueueFamilyIndex() const
 {
 	return m_graphicsQueueFamilyIndex;
 }
+
+uint32_t sss::vulkan::VKContext::getComputeQueueFamilyIndex() const
+{
+	return m_computeQueueFamilyIndex;
+}
+
+VkQueue sss::vulkan::VKContext::getTransferQueue() const
+{
+	return m_transferQueue;
+}
+
+uint32_t sss::vulkan::VKContext::getTransferQueueFamilyIndex() const
+{
+	return m_transferQueueFamilyIndex;
+}
+
+bool sss::vulkan::VKContext::hasDedicatedTransferQueue() const
+{
+	return m_transferQueueFamilyIndex != m_graphicsQueueFamilyIndex;
+}
+
+bool sss::vulkan::VKContext::hasDedicatedComputeQueue() const
+{
+	return m_computeQueueFamilyIndex != m_graphicsQueueFamilyIndex;
+}
+
+bool sss::vulkan::VKContext::isHeadless() const
+{
+	return m_surface == VK_NULL_HANDLE;
+}
+
+sss::vulkan::MemoryAllocator &sss::vulkan::VKContext::getMemoryAllocator() const
+{
+	return *m_memoryAllocator;
+}
+
+sss::vulkan::PipelineCache &sss::vulkan::VKContext::getPipelineCache() const
+{
+	return *m_pipelineCache;
+}
@@ -1,6 +1,9 @@
 #pragma once
 #include "vulkan/volk.h"
 #include <vector>
+#include <memory>
+#include "vulkan/MemoryAllocator.h"
+#include "vulkan/PipelineCache.h"
 
 namespace sss
 {
@@ -9,6 +12,7 @@ namespace sss
 		class VKContext
 		{
 		public:
+			// pass nullptr as windowHandle to create a headless context without surface and swapchain support
 			explicit VKContext(void *windowHandle);
 			VKContext(const VKContext &) = delete;
 			VKContext(const VKContext &&) = delete;
@@ -23,8 +27,20 @@ namespace sss
 			VkPhysicalDeviceProperties getDeviceProperties() const;
 			VkQueue getGraphicsQueue() const;
 			VkCommandPool getGraphicsCommandPool() const;
+			// the compute queue, its family and its pool alias the graphics ones if there is no dedicated compute queue family
+			VkQueue getComputeQueue() const;
+			VkCommandPool getComputeCommandPool() const;
 			VkSurfaceKHR getSurface() const;
 			uint32_t getGraphicsQueueFamilyIndex() const;
+			uint32_t getComputeQueueFamilyIndex() const;
+			bool hasDedicatedComputeQueue() const;
+			// the transfer queue and its family alias the graphics ones if there is no dedicated transfer queue family
+			VkQueue getTransferQueue() const;
+			uint32_t getTransferQueueFamilyIndex() const;
+			bool hasDedicatedTransferQueue() const;
+			bool isHeadless() const;
+			MemoryAllocator &getMemoryAllocator() const;
+			PipelineCache &getPipelineCache() const;
 
 		private:
 			VkInstance m_instance;
@@ -36,8 +52,15 @@ namespace sss
 			VkQueue m_graphicsQueue;
 			uint32_t m_graphicsQueueFamilyIndex;
 			VkCommandPool m_graphicsCommandPool;
+			VkQueue m_computeQueue;
+			uint32_t m_computeQueueFamilyIndex;
+			VkCommandPool m_computeCommandPool;
+			VkQueue m_transferQueue;
+			uint32_t m_transferQueueFamilyIndex;
 			VkSurfaceKHR m_surface;
 			VkDebugUtilsMessengerEXT m_debugUtilsMessenger;
+			std::unique_ptr<MemoryAllocator> m_memoryAllocator;
+			std::unique_ptr<PipelineCache> m_pipelineCache;
 		};
 	}
 }
\ No newline at end of file
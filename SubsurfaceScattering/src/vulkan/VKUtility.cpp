@@ -1,4 +1,6 @@
 #include "VKUtility.h"
+#include <vector>
+#include <algorithm>
 
 VkCommandBuffer sss::vulkan::vkutil::beginSingleTimeCommands(VkDevice device, VkCommandPool commandPool)
 {
@@ -18,11 +20,14 @@ VkCommandBuffer sss::vulkan::vkutil::beginSingleTimeCommands(VkDevice device, Vk
 	return commandBuffer;
 }
 
-void sss::vulkan::vkutil::endSingleTimeCommands(VkDevice device, VkQueue queue, VkCommandPool commandPool, VkCommandBuffer commandBuffer)
+void sss::vulkan::vkutil::endSingleTimeCommands(VkDevice device, VkQueue queue, VkCommandPool commandPool, VkCommandBuffer commandBuffer, VkSemaphore waitSemaphore, VkPipelineStageFlags waitStageMask)
 {
 	vkEndCommandBuffer(commandBuffer);
 
 	VkSubmitInfo submitInfo = { VK_STRUCTURE_TYPE_SUBMIT_INFO };
+	submitInfo.waitSemaphoreCount = waitSemaphore != VK_NULL_HANDLE ? 1 : 0;
+	submitInfo.pWaitSemaphores = &waitSemaphore;
+	submitInfo.pWaitDstStageMask = &waitStageMask;
 	submitInfo.commandBufferCount = 1;
 	submitInfo.pCommandBuffers = &commandBuffer;
 
@@ -74,8 +79,10 @@ VkResult sss::vulkan::vkutil::findMemoryTypeIndex(VkPhysicalDeviceMemoryProperti
 	return memoryTypeIndex != ~uint32_t(0) ? VK_SUCCESS : VK_ERROR_FEATURE_NOT_PRESENT;
 }
 
-VkResult sss::vulkan::vkutil::createImage(VkPhysicalDevice physicalDevice, VkDevice device, VkImageCreateInfo createInfo, VkMemoryPropertyFlags requiredFlags, VkMemoryPropertyFlags preferredFlags, VkImage &image, VkDeviceMemory &memory)
+VkResult sss::vulkan::vkutil::createImage(MemoryAllocator &allocator, VkImageCreateInfo createInfo, VkMemoryPropertyFlags requiredFlags, VkMemoryPropertyFlags preferredFlags, MemoryPool pool, VkImage &image, MemoryAllocator::Allocation &allocation)
 {
+	const VkDevice device = allocator.getDevice();
+
 	VkResult result = vkCreateImage(device, &createInfo, nullptr, &image);
 
 	if (result != VK_SUCCESS)
@@ -86,20 +93,7 @@ VkResult sss::vulkan::vkutil::createImage(VkPhysicalDevice physicalDevice, VkDev
 	VkMemoryRequirements memoryRequirements;
 	vkGetImageMemoryRequirements(device, image, &memoryRequirements);
 
-	VkPhysicalDeviceMemoryProperties memoryProperties;
-	vkGetPhysicalDeviceMemoryProperties(physicalDevice, &memoryProperties);
-
-	uint32_t memoryTypeIndex;
-	if (findMemoryTypeIndex(memoryProperties, memoryRequirements.memoryTypeBits, requiredFlags, preferredFlags, memoryTypeIndex) != VK_SUCCESS)
-	{
-		return VK_ERROR_FEATURE_NOT_PRESENT;
-	}
-
-	VkMemoryAllocateInfo memoryAllocateInfo{ VK_STRUCTURE_TYPE_MEMORY_ALLOCATE_INFO };
-	memoryAllocateInfo.allocationSize = memoryRequirements.size;
-	memoryAllocateInfo.memoryTypeIndex = memoryTypeIndex;
-
-	result = vkAllocateMemory(device, &memoryAllocateInfo, nullptr, &memory);
+	result = allocator.allocate(memoryRequirements, requiredFlags, preferredFlags, createInfo.tiling == VK_IMAGE_TILING_OPTIMAL, pool, allocation);
 
 	if (result != VK_SUCCESS)
 	{
@@ -107,19 +101,19 @@ VkResult sss::vulkan::vkutil::createImage(VkPhysicalDevice physicalDevice, VkDev
 		return result;
 	}
 
-	result = vkBindImageMemory(device, image, memory, 0);
+	result = vkBindImageMemory(device, image, allocation.memory, allocation.offset);
 
 	if (result != VK_SUCCESS)
 	{
 		vkDestroyImage(device, image, nullptr);
-		vkFreeMemory(device, memory, nullptr);
+		allocator.free(allocation);
 		return result;
 	}
 
 	return VK_SUCCESS;
 }
 
-VkResult sss::vulkan::vkutil::create2dImage(VkPhysicalDevice physicalDevice, VkDevice device, VkFormat format, uint32_t width, uint32_t height, VkImageUsageFlags usage, VkMemoryPropertyFlags requiredFlags, VkMemoryPropertyFlags preferredFlags, VkImage & image, VkDeviceMemory & memory)
+VkResult sss::vulkan::vkutil::create2dImage(MemoryAllocator &allocator, VkFormat format, uint32_t width, uint32_t height, VkImageUsageFlags usage, VkMemoryPropertyFlags requiredFlags, VkMemoryPropertyFlags preferredFlags, MemoryPool pool, VkImage &image, MemoryAllocator::Allocation &allocation)
 {
 	VkImageCreateInfo imageCreateInfo{ VK_STRUCTURE_TYPE_IMAGE_CREATE_INFO };
 	imageCreateInfo.imageType = VK_IMAGE_TYPE_2D;
@@ -135,35 +129,91 @@ VkResult sss::vulkan::vkutil::create2dImage(VkPhysicalDevice physicalDevice, VkD
 	imageCreateInfo.sharingMode = VK_SHARING_MODE_EXCLUSIVE;
 	imageCreateInfo.initialLayout = VK_IMAGE_LAYOUT_UNDEFINED;
 
-	return createImage(physicalDevice, device, imageCreateInfo, requiredFlags, preferredFlags, image, memory);
+	return createImage(allocator, imageCreateInfo, requiredFlags, preferredFlags, pool, image, allocation);
 }
 
-VkResult sss::vulkan::vkutil::createBuffer(VkPhysicalDevice physicalDevice, VkDevice device, VkBufferCreateInfo createInfo, VkMemoryPropertyFlags requiredFlags, VkMemoryPropertyFlags preferredFlags, VkBuffer & buffer, VkDeviceMemory & memory)
+VkResult sss::vulkan::vkutil::createAliasedImages(MemoryAllocator &allocator, uint32_t imageCount, const VkImageCreateInfo *createInfos, const uint32_t *aliasSets, VkMemoryPropertyFlags requiredFlags, VkMemoryPropertyFlags preferredFlags, MemoryPool pool, VkImage *images, MemoryAllocator::Allocation &allocation)
 {
-	VkResult result = vkCreateBuffer(device, &createInfo, nullptr, &buffer);
+	const VkDevice device = allocator.getDevice();
+
+	auto destroyImages = [&](uint32_t count)
+	{
+		for (uint32_t i = 0; i < count; ++i)
+		{
+			vkDestroyImage(device, images[i], nullptr);
+		}
+	};
+
+	std::vector<VkDeviceSize> offsets(imageCount);
+	std::vector<VkDeviceSize> setSizes;
+	VkMemoryRequirements allocationRequirements{ 0, 1, ~0u };
+
+	for (uint32_t i = 0; i < imageCount; ++i)
+	{
+		VkResult result = vkCreateImage(device, &createInfos[i], nullptr, &images[i]);
+
+		if (result != VK_SUCCESS)
+		{
+			destroyImages(i);
+			return result;
+		}
+
+		VkMemoryRequirements memoryRequirements;
+		vkGetImageMemoryRequirements(device, images[i], &memoryRequirements);
+
+		if (aliasSets[i] >= setSizes.size())
+		{
+			setSizes.resize(aliasSets[i] + 1, 0);
+		}
+
+		// all images are optimal tiling, so bufferImageGranularity does not apply between them
+		VkDeviceSize &setSize = setSizes[aliasSets[i]];
+		offsets[i] = (setSize + memoryRequirements.alignment - 1) / memoryRequirements.alignment * memoryRequirements.alignment;
+		setSize = offsets[i] + memoryRequirements.size;
+
+		allocationRequirements.size = std::max(allocationRequirements.size, setSize);
+		allocationRequirements.alignment = std::max(allocationRequirements.alignment, memoryRequirements.alignment);
+		allocationRequirements.memoryTypeBits &= memoryRequirements.memoryTypeBits;
+	}
+
+	VkResult result = allocator.allocate(allocationRequirements, requiredFlags, preferredFlags, true, pool, allocation);
 
 	if (result != VK_SUCCESS)
 	{
+		destroyImages(imageCount);
 		return result;
 	}
 
-	VkMemoryRequirements memoryRequirements;
-	vkGetBufferMemoryRequirements(device, buffer, &memoryRequirements);
+	for (uint32_t i = 0; i < imageCount; ++i)
+	{
+		result = vkBindImageMemory(device, images[i], allocation.memory, allocation.offset + offsets[i]);
 
-	VkPhysicalDeviceMemoryProperties memoryProperties;
-	vkGetPhysicalDeviceMemoryProperties(physicalDevice, &memoryProperties);
+		if (result != VK_SUCCESS)
+		{
+			destroyImages(imageCount);
+			allocator.free(allocation);
+			return result;
+		}
+	}
 
-	uint32_t memoryTypeIndex;
-	if (findMemoryTypeIndex(memoryProperties, memoryRequirements.memoryTypeBits, requiredFlags, preferredFlags, memoryTypeIndex) != VK_SUCCESS)
+	return VK_SUCCESS;
+}
+
+VkResult sss::vulkan::vkutil::createBuffer(MemoryAllocator &allocator, VkBufferCreateInfo createInfo, VkMemoryPropertyFlags requiredFlags, VkMemoryPropertyFlags preferredFlags, MemoryPool pool, VkBuffer &buffer, MemoryAllocator::Allocation &allocation)
+{
+	const VkDevice device = allocator.getDevice();
+
+	VkResult result = vkCreateBuffer(device, &createInfo, nullptr, &buffer);
+
+	if (result != VK_SUCCESS)
 	{
-		return VK_ERROR_FEATURE_NOT_PRESENT;
+		return result;
 	}
 
-	VkMemoryAllocateInfo memoryAllocateInfo{ VK_STRUCTURE_TYPE_MEMORY_ALLOCATE_INFO };
-	memoryAllocateInfo.allocationSize = memoryRequirements.size;
-	memoryAllocateInfo.memoryTypeIndex = memoryTypeIndex;
+	VkMemoryRequirements memoryRequirements;
+	vkGetBufferMemoryRequirements(device, buffer, &memoryRequirements);
 
-	result = vkAllocateMemory(device, &memoryAllocateInfo, nullptr, &memory);
+	result = allocator.allocate(memoryRequirements, requiredFlags, preferredFlags, false, pool, allocation);
 
 	if (result != VK_SUCCESS)
 	{
@@ -171,12 +221,12 @@ VkResult sss::vulkan::vkutil::createBuffer(VkPhysicalDevice physicalDevice, VkDe
 		return result;
 	}
 
-	result = vkBindBufferMemory(device, buffer, memory, 0);
+	result = vkBindBufferMemory(device, buffer, allocation.memory, allocation.offset);
 
 	if (result != VK_SUCCESS)
 	{
 		vkDestroyBuffer(device, buffer, nullptr);
-		vkFreeMemory(device, memory, nullptr);
+		allocator.free(allocation);
 		return result;
 	}
 
@@ -1,5 +1,6 @@
 #pragma once
 #include "volk.h"
+#include "MemoryAllocator.h"
 
 namespace sss
 {
@@ -8,11 +9,15 @@ namespace sss
 		namespace vkutil
 		{
 			VkCommandBuffer beginSingleTimeCommands(VkDevice device, VkCommandPool commandPool);
-			void endSingleTimeCommands(VkDevice device, VkQueue queue, VkCommandPool commandPool, VkCommandBuffer commandBuffer);
+			// optionally waits on a semaphore at the given stages before executing the command buffer
+			void endSingleTimeCommands(VkDevice device, VkQueue queue, VkCommandPool commandPool, VkCommandBuffer commandBuffer, VkSemaphore waitSemaphore = VK_NULL_HANDLE, VkPipelineStageFlags waitStageMask = VK_PIPELINE_STAGE_ALL_COMMANDS_BIT);
 			VkResult findMemoryTypeIndex(VkPhysicalDeviceMemoryProperties memoryProperties, uint32_t memoryTypeBitsRequirement, VkMemoryPropertyFlags requiredProperties, VkMemoryPropertyFlags preferredProperties, uint32_t &memoryTypeIndex);
-			VkResult createImage(VkPhysicalDevice physicalDevice, VkDevice device, VkImageCreateInfo createInfo, VkMemoryPropertyFlags requiredFlags, VkMemoryPropertyFlags preferredFlags, VkImage &image, VkDeviceMemory &memory);
-			VkResult create2dImage(VkPhysicalDevice physicalDevice, VkDevice device, VkFormat format, uint32_t width, uint32_t height, VkImageUsageFlags usage, VkMemoryPropertyFlags requiredFlags, VkMemoryPropertyFlags preferredFlags, VkImage &image, VkDeviceMemory &memory);
-			VkResult createBuffer(VkPhysicalDevice physicalDevice, VkDevice device, VkBufferCreateInfo createInfo, VkMemoryPropertyFlags requiredFlags, VkMemoryPropertyFlags preferredFlags, VkBuffer &buffer, VkDeviceMemory &memory);
+			VkResult createImage(MemoryAllocator &allocator, VkImageCreateInfo createInfo, VkMemoryPropertyFlags requiredFlags, VkMemoryPropertyFlags preferredFlags, MemoryPool pool, VkImage &image, MemoryAllocator::Allocation &allocation);
+			VkResult create2dImage(MemoryAllocator &allocator, VkFormat format, uint32_t width, uint32_t height, VkImageUsageFlags usage, VkMemoryPropertyFlags requiredFlags, VkMemoryPropertyFlags preferredFlags, MemoryPool pool, VkImage &image, MemoryAllocator::Allocation &allocation);
+			// creates images bound to a single allocation. images of the same alias set are placed next to each other and every set
+			// starts at offset 0, so images of different sets alias each other and must not be in use at the same time
+			VkResult createAliasedImages(MemoryAllocator &allocator, uint32_t imageCount, const VkImageCreateInfo *createInfos, const uint32_t *aliasSets, VkMemoryPropertyFlags requiredFlags, VkMemoryPropertyFlags preferredFlags, MemoryPool pool, VkImage *images, MemoryAllocator::Allocation &allocation);
+			VkResult createBuffer(MemoryAllocator &allocator, VkBufferCreateInfo createInfo, VkMemoryPropertyFlags requiredFlags, VkMemoryPropertyFlags preferredFlags, MemoryPool pool, VkBuffer &buffer, MemoryAllocator::Allocation &allocation);
 		}
 	}
 }
\ No newline at end of file
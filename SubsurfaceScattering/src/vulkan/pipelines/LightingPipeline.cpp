@@ -2,19 +2,36 @@
 #include "utility/Utility.h"
 #include "ShaderModule.h"
 #include "vulkan/Material.h"
+#include "vulkan/Mesh.h"
+#include <glm/vec4.hpp>
 
+namespace
+{
+	using namespace glm;
+	struct VertexPushConsts
+	{
+		vec4 positionScale;
+		vec4 positionBias;
+	};
+}
 
-std::pair<VkPipeline, VkPipelineLayout> sss::vulkan::LightingPipeline::create(VkDevice device, VkRenderPass renderPass, uint32_t subpassIndex, uint32_t setLayoutCount, VkDescriptorSetLayout *setLayouts, bool subsurfaceScattering)
+std::pair<VkPipeline, VkPipelineLayout> sss::vulkan::LightingPipeline::create(VkDevice device, VkPipelineCache pipelineCache, VkRenderPass renderPass, uint32_t subpassIndex, uint32_t setLayoutCount, VkDescriptorSetLayout *setLayouts, bool subsurfaceScattering)
 {
 	VkPipelineLayout pipelineLayout;
 
-	VkPushConstantRange pushConstantRange{ VK_SHADER_STAGE_FRAGMENT_BIT, 0, sizeof(Material) };
+	static_assert(sizeof(Material) <= VERTEX_PUSH_CONSTANT_OFFSET, "Material overlaps the vertex shader push constants");
+
+	VkPushConstantRange pushConstantRanges[] =
+	{
+		{ VK_SHADER_STAGE_FRAGMENT_BIT, 0, sizeof(Material) },
+		{ VK_SHADER_STAGE_VERTEX_BIT, VERTEX_PUSH_CONSTANT_OFFSET, sizeof(VertexPushConsts) },
+	};
 
 	VkPipelineLayoutCreateInfo layoutCreateInfo{ VK_STRUCTURE_TYPE_PIPELINE_LAYOUT_CREATE_INFO };
 	layoutCreateInfo.setLayoutCount = setLayoutCount;
 	layoutCreateInfo.pSetLayouts = setLayouts;
-	layoutCreateInfo.pushConstantRangeCount = 1;
-	layoutCreateInfo.pPushConstantRanges = &pushConstantRange;
+	layoutCreateInfo.pushConstantRangeCount = 2;
+	layoutCreateInfo.pPushConstantRanges = pushConstantRanges;
 
 	if (vkCreatePipelineLayout(device, &layoutCreateInfo, nullptr, &pipelineLayout) != VK_SUCCESS)
 	{
@@ -32,22 +49,24 @@ std::pair<VkPipeline, VkPipelineLayout> sss::vulkan::LightingPipeline::create(Vk
 
 	VkVertexInputBindingDescription bindingDescriptions[] =
 	{
-		{ 0, sizeof(float) * 3, VK_VERTEX_INPUT_RATE_VERTEX },
-		{ 1, sizeof(float) * 3, VK_VERTEX_INPUT_RATE_VERTEX },
-		{ 2, sizeof(float) * 2, VK_VERTEX_INPUT_RATE_VERTEX }
+		{ 0, Mesh::POSITION_SIZE, VK_VERTEX_INPUT_RATE_VERTEX },
+		{ 1, Mesh::NORMAL_SIZE, VK_VERTEX_INPUT_RATE_VERTEX },
+		{ 2, Mesh::TEXCOORD_SIZE, VK_VERTEX_INPUT_RATE_VERTEX },
+		{ 3, Mesh::TANGENT_SIZE, VK_VERTEX_INPUT_RATE_VERTEX }
 	};
 
 	VkVertexInputAttributeDescription attributeDescriptions[] =
 	{
-		{ 0, 0, VK_FORMAT_R32G32B32_SFLOAT, 0 },
-		{ 1, 1, VK_FORMAT_R32G32B32_SFLOAT, 0 },
-		{ 2, 2, VK_FORMAT_R32G32_SFLOAT, 0 }
+		{ 0, 0, VK_FORMAT_R16G16B16A16_UNORM, 0 },
+		{ 1, 1, VK_FORMAT_R16G16_SNORM, 0 },
+		{ 2, 2, VK_FORMAT_R16G16_SFLOAT, 0 },
+		{ 3, 3, VK_FORMAT_R8G8B8A8_SNORM, 0 }
 	};
 
 	VkPipelineVertexInputStateCreateInfo vertexInputState{ VK_STRUCTURE_TYPE_PIPELINE_VERTEX_INPUT_STATE_CREATE_INFO };
-	vertexInputState.vertexBindingDescriptionCount = 3;
+	vertexInputState.vertexBindingDescriptionCount = Mesh::VERTEX_STREAM_COUNT;
 	vertexInputState.pVertexBindingDescriptions = bindingDescriptions;
-	vertexInputState.vertexAttributeDescriptionCount = 3;
+	vertexInputState.vertexAttributeDescriptionCount = Mesh::VERTEX_STREAM_COUNT;
 	vertexInputState.pVertexAttributeDescriptions = attributeDescriptions;
 
 	VkPipelineInputAssemblyStateCreateInfo inputAssemblyState{ VK_STRUCTURE_TYPE_PIPELINE_INPUT_ASSEMBLY_STATE_CREATE_INFO };
@@ -119,7 +138,7 @@ std::pair<VkPipeline, VkPipelineLayout> sss::vulkan::LightingPipeline::create(Vk
 	pipelineInfo.basePipelineIndex = 0;
 
 	VkPipeline pipeline;
-	if (vkCreateGraphicsPipelines(device, VK_NULL_HANDLE, 1, &pipelineInfo, nullptr, &pipeline) != VK_SUCCESS)
+	if (vkCreateGraphicsPipelines(device, pipelineCache, 1, &pipelineInfo, nullptr, &pipeline) != VK_SUCCESS)
 	{
 		util::fatalExit("Failed to create pipeline!", EXIT_FAILURE);
 	}
@@ -8,7 +8,12 @@ namespace sss
 	{
 		namespace LightingPipeline
 		{
-			std::pair<VkPipeline, VkPipelineLayout> create(VkDevice device, VkRenderPass renderPass, uint32_t subpassIndex, uint32_t setLayoutCount, VkDescriptorSetLayout *setLayouts, bool subsurfaceScattering);
+			enum
+			{
+				VERTEX_PUSH_CONSTANT_OFFSET = 48
+			};
+
+			std::pair<VkPipeline, VkPipelineLayout> create(VkDevice device, VkPipelineCache pipelineCache, VkRenderPass renderPass, uint32_t subpassIndex, uint32_t setLayoutCount, VkDescriptorSetLayout *setLayouts, bool subsurfaceScattering);
 		}
 	}
 }
\ No newline at end of file
@@ -12,10 +12,12 @@ namespace
 		vec2 texelSize;
 		float exposure;
 		uint taa;
+		int32_t sssSplitColumn;
+		float sssProjectionScale;
 	};
 }
 
-std::pair<VkPipeline, VkPipelineLayout> sss::vulkan::PostprocessingPipeline::create(VkDevice device, uint32_t setLayoutCount, VkDescriptorSetLayout * setLayouts)
+std::pair<VkPipeline, VkPipelineLayout> sss::vulkan::PostprocessingPipeline::create(VkDevice device, VkPipelineCache pipelineCache, uint32_t setLayoutCount, VkDescriptorSetLayout * setLayouts, bool fusedSSSBlur)
 {
 	VkPipelineLayout pipelineLayout;
 
@@ -32,7 +34,7 @@ std::pair<VkPipeline, VkPipelineLayout> sss::vulkan::PostprocessingPipeline::cre
 		util::fatalExit("Failed to create PipelineLayout!", EXIT_FAILURE);
 	}
 
-	ShaderModule computeShaderModule(device, "resources/shaders/postprocess_comp.spv");
+	ShaderModule computeShaderModule(device, fusedSSSBlur ? "resources/shaders/postprocess_comp_FUSED_SSS_BLUR.spv" : "resources/shaders/postprocess_comp.spv");
 
 	VkPipelineShaderStageCreateInfo shaderStage = { VK_STRUCTURE_TYPE_PIPELINE_SHADER_STAGE_CREATE_INFO, nullptr, 0, VK_SHADER_STAGE_COMPUTE_BIT, computeShaderModule, "main" };
 
@@ -43,7 +45,7 @@ std::pair<VkPipeline, VkPipelineLayout> sss::vulkan::PostprocessingPipeline::cre
 	pipelineInfo.basePipelineIndex = 0;
 
 	VkPipeline pipeline;
-	if (vkCreateComputePipelines(device, VK_NULL_HANDLE, 1, &pipelineInfo, nullptr, &pipeline) != VK_SUCCESS)
+	if (vkCreateComputePipelines(device, pipelineCache, 1, &pipelineInfo, nullptr, &pipeline) != VK_SUCCESS)
 	{
 		util::fatalExit("Failed to create pipeline!", EXIT_FAILURE);
 	}
@@ -10,11 +10,12 @@ namespace
 	{
 		vec2 texelSize;
 		vec2 dir;
-		float sssWidth;
+		float projectionScale;
+		int32_t splitColumn;
 	};
 }
 
-std::pair<VkPipeline, VkPipelineLayout> sss::vulkan::SSSBlurPipeline::create(VkDevice device, uint32_t setLayoutCount, VkDescriptorSetLayout * setLayouts)
+std::pair<VkPipeline, VkPipelineLayout> sss::vulkan::SSSBlurPipeline::create(VkDevice device, VkPipelineCache pipelineCache, uint32_t setLayoutCount, VkDescriptorSetLayout * setLayouts, bool tiled)
 {
 	VkPipelineLayout pipelineLayout;
 
@@ -31,7 +32,7 @@ std::pair<VkPipeline, VkPipelineLayout> sss::vulkan::SSSBlurPipeline::create(VkD
 		util::fatalExit("Failed to create PipelineLayout!", EXIT_FAILURE);
 	}
 
-	ShaderModule computeShaderModule(device, "resources/shaders/sssBlur_comp.spv");
+	ShaderModule computeShaderModule(device, tiled ? "resources/shaders/sssBlur_comp_TILED.spv" : "resources/shaders/sssBlur_comp.spv");
 
 	VkPipelineShaderStageCreateInfo shaderStage = { VK_STRUCTURE_TYPE_PIPELINE_SHADER_STAGE_CREATE_INFO, nullptr, 0, VK_SHADER_STAGE_COMPUTE_BIT, computeShaderModule, "main" };
 
@@ -42,7 +43,7 @@ std::pair<VkPipeline, VkPipelineLayout> sss::vulkan::SSSBlurPipeline::create(VkD
 	pipelineInfo.basePipelineIndex = 0;
 
 	VkPipeline pipeline;
-	if (vkCreateComputePipelines(device, VK_NULL_HANDLE, 1, &pipelineInfo, nullptr, &pipeline) != VK_SUCCESS)
+	if (vkCreateComputePipelines(device, pipelineCache, 1, &pipelineInfo, nullptr, &pipeline) != VK_SUCCESS)
 	{
 		util::fatalExit("Failed to create pipeline!", EXIT_FAILURE);
 	}
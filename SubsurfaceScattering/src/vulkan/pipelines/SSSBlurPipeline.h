@@ -8,7 +8,7 @@ namespace sss
 	{
 		namespace SSSBlurPipeline
 		{
-			std::pair<VkPipeline, VkPipelineLayout> create(VkDevice device, uint32_t setLayoutCount, VkDescriptorSetLayout *setLayouts);
+			std::pair<VkPipeline, VkPipelineLayout> create(VkDevice device, VkPipelineCache pipelineCache, uint32_t setLayoutCount, VkDescriptorSetLayout *setLayouts, bool tiled);
 		}
 	}
 }
\ No newline at end of file
@@ -0,0 +1,14 @@
+#pragma once
+#include "vulkan/volk.h"
+#include <utility>
+
+namespace sss
+{
+	namespace vulkan
+	{
+		namespace SSSBurleyPipeline
+		{
+			std::pair<VkPipeline, VkPipelineLayout> create(VkDevice device, VkPipelineCache pipelineCache, uint32_t setLayoutCount, VkDescriptorSetLayout *setLayouts);
+		}
+	}
+}
\ No newline at end of file
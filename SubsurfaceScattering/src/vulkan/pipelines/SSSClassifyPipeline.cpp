@@ -0,0 +1,48 @@
+#include "SSSClassifyPipeline.h"
+#include "utility/Utility.h"
+#include "ShaderModule.h"
+
+namespace
+{
+	struct PushConsts
+	{
+		float nearPlane;
+		float farPlane;
+	};
+}
+
+std::pair<VkPipeline, VkPipelineLayout> sss::vulkan::SSSClassifyPipeline::create(VkDevice device, VkPipelineCache pipelineCache, uint32_t setLayoutCount, VkDescriptorSetLayout * setLayouts, bool halfRes)
+{
+	VkPipelineLayout pipelineLayout;
+
+	VkPushConstantRange pushConstantRange{ VK_SHADER_STAGE_COMPUTE_BIT, 0, sizeof(PushConsts) };
+
+	VkPipelineLayoutCreateInfo layoutCreateInfo{ VK_STRUCTURE_TYPE_PIPELINE_LAYOUT_CREATE_INFO };
+	layoutCreateInfo.setLayoutCount = setLayoutCount;
+	layoutCreateInfo.pSetLayouts = setLayouts;
+	layoutCreateInfo.pushConstantRangeCount = 1;
+	layoutCreateInfo.pPushConstantRanges = &pushConstantRange;
+
+	if (vkCreatePipelineLayout(device, &layoutCreateInfo, nullptr, &pipelineLayout) != VK_SUCCESS)
+	{
+		util::fatalExit("Failed to create PipelineLayout!", EXIT_FAILURE);
+	}
+
+	ShaderModule computeShaderModule(device, halfRes ? "resources/shaders/sssClassify_comp_HALF_RES.spv" : "resources/shaders/sssClassify_comp.spv");
+
+	VkPipelineShaderStageCreateInfo shaderStage = { VK_STRUCTURE_TYPE_PIPELINE_SHADER_STAGE_CREATE_INFO, nullptr, 0, VK_SHADER_STAGE_COMPUTE_BIT, computeShaderModule, "main" };
+
+	VkComputePipelineCreateInfo pipelineInfo{ VK_STRUCTURE_TYPE_COMPUTE_PIPELINE_CREATE_INFO };
+	pipelineInfo.stage = shaderStage;
+	pipelineInfo.layout = pipelineLayout;
+	pipelineInfo.basePipelineHandle = VK_NULL_HANDLE;
+	pipelineInfo.basePipelineIndex = 0;
+
+	VkPipeline pipeline;
+	if (vkCreateComputePipelines(device, pipelineCache, 1, &pipelineInfo, nullptr, &pipeline) != VK_SUCCESS)
+	{
+		util::fatalExit("Failed to create pipeline!", EXIT_FAILURE);
+	}
+
+	return { pipeline, pipelineLayout };
+}
@@ -1,13 +1,15 @@
 #include "ShaderModule.h"
 #include "utility/Utility.h"
+#include "utility/AssetFile.h"
 
 sss::vulkan::ShaderModule::ShaderModule(VkDevice device, const char *path)
 	:m_device(device)
 {
-	std::vector<char> code = util::readBinaryFile(path);
+	// the code is passed straight from the mapping, which satisfies the 4 byte alignment of pCode
+	const util::AssetFile code(path);
 	VkShaderModuleCreateInfo createInfo{ VK_STRUCTURE_TYPE_SHADER_MODULE_CREATE_INFO };
-	createInfo.codeSize = code.size();
-	createInfo.pCode = reinterpret_cast<const uint32_t*>(code.data());
+	createInfo.codeSize = code.getSize();
+	createInfo.pCode = reinterpret_cast<const uint32_t*>(code.getData());
 
 	if (vkCreateShaderModule(m_device, &createInfo, nullptr, &m_module) != VK_SUCCESS)
 	{
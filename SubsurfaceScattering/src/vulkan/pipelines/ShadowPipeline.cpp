@@ -1,6 +1,7 @@
 #include "ShadowPipeline.h"
 #include "utility/Utility.h"
 #include "ShaderModule.h"
+#include "vulkan/Mesh.h"
 #include <glm/mat4x4.hpp>
 
 namespace
@@ -9,10 +10,12 @@ namespace
 	struct PushConsts
 	{
 		mat4 viewProjectionMatrix;
+		vec4 positionScale;
+		vec4 positionBias;
 	};
 }
 
-std::pair<VkPipeline, VkPipelineLayout> sss::vulkan::ShadowPipeline::create(VkDevice device, VkRenderPass renderPass, uint32_t subpassIndex, uint32_t setLayoutCount, VkDescriptorSetLayout * setLayouts)
+std::pair<VkPipeline, VkPipelineLayout> sss::vulkan::ShadowPipeline::create(VkDevice device, VkPipelineCache pipelineCache, VkRenderPass renderPass, uint32_t subpassIndex, uint32_t setLayoutCount, VkDescriptorSetLayout * setLayouts)
 {
 	VkPipelineLayout pipelineLayout;
 
@@ -38,12 +41,12 @@ std::pair<VkPipeline, VkPipelineLayout> sss::vulkan::ShadowPipeline::create(VkDe
 
 	VkVertexInputBindingDescription bindingDescriptions[] =
 	{
-		{ 0, sizeof(float) * 3, VK_VERTEX_INPUT_RATE_VERTEX },
+		{ 0, Mesh::POSITION_SIZE, VK_VERTEX_INPUT_RATE_VERTEX },
 	};
 
 	VkVertexInputAttributeDescription attributeDescriptions[] =
 	{
-		{ 0, 0, VK_FORMAT_R32G32B32_SFLOAT, 0 },
+		{ 0, 0, VK_FORMAT_R16G16B16A16_UNORM, 0 },
 	};
 
 	VkPipelineVertexInputStateCreateInfo vertexInputState{ VK_STRUCTURE_TYPE_PIPELINE_VERTEX_INPUT_STATE_CREATE_INFO };
@@ -104,7 +107,7 @@ std::pair<VkPipeline, VkPipelineLayout> sss::vulkan::ShadowPipeline::create(VkDe
 	pipelineInfo.basePipelineIndex = 0;
 
 	VkPipeline pipeline;
-	if (vkCreateGraphicsPipelines(device, VK_NULL_HANDLE, 1, &pipelineInfo, nullptr, &pipeline) != VK_SUCCESS)
+	if (vkCreateGraphicsPipelines(device, pipelineCache, 1, &pipelineInfo, nullptr, &pipeline) != VK_SUCCESS)
 	{
 		util::fatalExit("Failed to create pipeline!", EXIT_FAILURE);
 	}
@@ -12,7 +12,7 @@ namespace
 	};
 }
 
-std::pair<VkPipeline, VkPipelineLayout> sss::vulkan::SkyboxPipeline::create(VkDevice device, VkRenderPass renderPass, uint32_t subpassIndex, uint32_t setLayoutCount, VkDescriptorSetLayout * setLayouts)
+std::pair<VkPipeline, VkPipelineLayout> sss::vulkan::SkyboxPipeline::create(VkDevice device, VkPipelineCache pipelineCache, VkRenderPass renderPass, uint32_t subpassIndex, uint32_t setLayoutCount, VkDescriptorSetLayout * setLayouts)
 {
 	VkPipelineLayout pipelineLayout;
 
@@ -98,7 +98,7 @@ std::pair<VkPipeline, VkPipelineLayout> sss::vulkan::SkyboxPipeline::create(VkDe
 	pipelineInfo.basePipelineIndex = 0;
 
 	VkPipeline pipeline;
-	if (vkCreateGraphicsPipelines(device, VK_NULL_HANDLE, 1, &pipelineInfo, nullptr, &pipeline) != VK_SUCCESS)
+	if (vkCreateGraphicsPipelines(device, pipelineCache, 1, &pipelineInfo, nullptr, &pipeline) != VK_SUCCESS)
 	{
 		util::fatalExit("Failed to create pipeline!", EXIT_FAILURE);
 	}
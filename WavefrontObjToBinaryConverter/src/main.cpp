@@ -3,21 +3,37 @@
 #include <string>
 #include <glm/vec3.hpp>
 #include <glm/vec2.hpp>
+#include <glm/vec4.hpp>
+#include <glm/geometric.hpp>
+#include <glm/common.hpp>
+#include <glm/gtc/packing.hpp>
+#include <fstream>
 #include <unordered_map>
+#include <algorithm>
+#include <limits>
+#include <future>
+#include <thread>
+#include <atomic>
+#include <mutex>
+#include <chrono>
+#include <filesystem>
+#include <cstring>
+#include <cstdio>
+#include <cctype>
 
 #define TINYOBJLOADER_IMPLEMENTATION
 #include <tiny_obj_loader.h>
 
+#ifdef _WIN32
+#define WIN32_LEAN_AND_MEAN
+#define NOMINMAX
 #include <Windows.h>
-#undef min
-#undef max
-#undef OPAQUE
-
-void fatalExit(const char *message, int exitCode)
-{
-	MessageBox(nullptr, message, nullptr, MB_OK | MB_ICONERROR);
-	exit(exitCode);
-}
+#else
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#endif
 
 struct Vertex
 {
@@ -31,132 +47,1513 @@ inline bool operator==(const Vertex &lhs, const Vertex &rhs)
 	return memcmp(&lhs, &rhs, sizeof(lhs)) == 0;
 }
 
-template <class T>
-inline void hashCombine(size_t &s, const T &v)
+// .mesh version 4 file layout: MeshFileHeader, MeshFileSubmesh[submeshCount], positions, normals, texcoords, tangents,
+// indices. positions are 16 bit unorm (4 components, the last one is padding) that are transformed back to object space
+// with positionScale and positionBias. normals are octahedral encoded as 2x 16 bit snorm and texcoords are 2x half
+// floats. tangents are 4x 8 bit snorm with the bitangent sign in w. indices are 16 bit if the vertex count allows it
+// and 32 bit otherwise. every submesh is a range of the index buffer that uses one material
+const uint32_t MESH_FILE_MAGIC = 0x4D535353; // "SSSM"
+const uint32_t MESH_FILE_VERSION = 4;
+
+struct MeshFileHeader
+{
+	uint32_t magic;
+	uint32_t version;
+	uint32_t vertexCount;
+	uint32_t indexCount;
+	uint32_t indexSize; // 2 or 4 bytes
+	float positionScale[3];
+	float positionBias[3];
+	uint32_t submeshCount;
+};
+
+struct MeshFileSubmesh
+{
+	char materialName[64]; // null terminated
+	uint32_t firstIndex;
+	uint32_t indexCount;
+};
+
+glm::vec2 encodeOctahedron(const glm::vec3 &normal)
 {
-	std::hash<T> h;
-	s ^= h(v) + 0x9e3779b9 + (s << 6) + (s >> 2);
+	const glm::vec3 n = normal / (glm::abs(normal.x) + glm::abs(normal.y) + glm::abs(normal.z));
+	glm::vec2 result(n.x, n.y);
+
+	// fold the lower hemisphere over the diagonals
+	if (n.z < 0.0f)
+	{
+		result.x = (1.0f - glm::abs(n.y)) * (n.x >= 0.0f ? 1.0f : -1.0f);
+		result.y = (1.0f - glm::abs(n.x)) * (n.y >= 0.0f ? 1.0f : -1.0f);
+	}
+
+	return result;
 }
 
-struct VertexHash
+// hashes the vertex one 32 bit word at a time. equality is bitwise (see operator== above), so hashing the bits is consistent
+inline uint64_t hashVertex(const Vertex &value)
 {
-	inline size_t operator()(const Vertex &value) const
+	uint32_t words[sizeof(Vertex) / sizeof(uint32_t)];
+	memcpy(words, &value, sizeof(words));
+
+	uint64_t hashValue = 0;
+	for (uint32_t word : words)
 	{
-		size_t hashValue = 0;
+		hashValue = ((hashValue << 5) | (hashValue >> 59)) ^ word;
+		hashValue *= 0x9E3779B97F4A7C15ull;
+	}
 
-		for (size_t i = 0; i < sizeof(Vertex); ++i)
-		{
-			hashCombine(hashValue, reinterpret_cast<const char *>(&value)[i]);
-		}
+	// the multiply leaves the low bits poorly mixed, but these are used for the table slot
+	return hashValue ^ (hashValue >> 32);
+}
 
-		return hashValue;
+// runs func(i) for every i in [0, count), each on its own thread
+template<typename Func>
+void runParallel(uint32_t count, const Func &func)
+{
+	std::vector<std::future<void>> futures;
+	for (uint32_t i = 0; i < count; ++i)
+	{
+		futures.push_back(std::async(std::launch::async, func, i));
 	}
-};
+	for (auto &future : futures)
+	{
+		future.get();
+	}
+}
 
-int main()
+// finds the first occurrence of each vertex: firstOccurrences[i] is the smallest j with getVertex(j) == getVertex(i).
+// with more than one shard, vertices are partitioned by the upper bits of their hash and each shard is deduplicated
+// by its own thread with a linear probing hash table, so the shards never touch the same vertex. vertices are
+// assembled on demand by getVertex, so there is no array holding all of them
+template<typename GetVertex>
+void findFirstOccurrences(uint32_t vertexCount, const GetVertex &getVertex, std::vector<uint32_t> &firstOccurrences, uint32_t shardCount)
 {
-	while (true)
+	const uint32_t EMPTY_SLOT = ~0u;
+
+	std::vector<uint64_t> hashes(vertexCount);
+	firstOccurrences.resize(vertexCount);
+
+	runParallel(shardCount, [&](uint32_t shard)
+	{
+		const uint32_t begin = static_cast<uint32_t>(uint64_t(vertexCount) * shard / shardCount);
+		const uint32_t end = static_cast<uint32_t>(uint64_t(vertexCount) * (shard + 1) / shardCount);
+
+		for (uint32_t i = begin; i < end; ++i)
+		{
+			hashes[i] = hashVertex(getVertex(i));
+		}
+	});
+
+	auto getShard = [shardCount](uint64_t hash)
 	{
-		std::string srcFileName;
-		std::string dstFileName;
+		return static_cast<uint32_t>((hash >> 32) * shardCount >> 32);
+	};
 
-		std::cout << "Source File:" << std::endl;
-		std::cin >> srcFileName;
-		std::cout << "Destination File:" << std::endl;
-		std::cin >> dstFileName;
-		std::cout << "Invert UV y-axis? (yes = 1, no = 0)";
-		bool invertTexcoordY = false;
-		std::cin >> invertTexcoordY;
+	runParallel(shardCount, [&](uint32_t shard)
+	{
+		uint32_t shardVertexCount = 0;
+		for (uint32_t i = 0; i < vertexCount; ++i)
+		{
+			shardVertexCount += getShard(hashes[i]) == shard ? 1 : 0;
+		}
+
+		// keep the load factor at or below 0.5
+		size_t tableSize = 16;
+		while (tableSize < size_t(shardVertexCount) * 2)
+		{
+			tableSize *= 2;
+		}
+		const size_t tableMask = tableSize - 1;
+		std::vector<uint32_t> table(tableSize, EMPTY_SLOT);
+
+		// vertices are visited in ascending order, so the first vertex to claim a slot is the first occurrence
+		for (uint32_t i = 0; i < vertexCount; ++i)
+		{
+			if (getShard(hashes[i]) != shard)
+			{
+				continue;
+			}
+
+			const Vertex vertex = getVertex(i);
+
+			size_t slot = hashes[i] & tableMask;
+			while (table[slot] != EMPTY_SLOT && !(hashes[table[slot]] == hashes[i] && getVertex(table[slot]) == vertex))
+			{
+				slot = (slot + 1) & tableMask;
+			}
 
-		// load scene
-		tinyobj::attrib_t objAttrib;
-		std::vector<tinyobj::shape_t> objShapes;
-		std::vector<tinyobj::material_t> objMaterials;
+			if (table[slot] == EMPTY_SLOT)
+			{
+				table[slot] = i;
+			}
+			firstOccurrences[i] = table[slot];
+		}
+	});
+}
 
-		std::string warn;
-		std::string err;
+// size of the simulated fifo post transform cache, used both for optimization and for the statistics
+const uint32_t VERTEX_CACHE_SIZE = 16;
 
-		bool ret = tinyobj::LoadObj(&objAttrib, &objShapes, &objMaterials, &warn, &err, srcFileName.c_str(), nullptr, true);
+// average cache miss ratio (transformed vertices per triangle, 0.5 - 3.0) and average transform to vertex ratio
+// (transformed vertices per vertex, 1.0 is optimal) for a fifo cache
+void computeVertexCacheStatistics(const std::vector<uint32_t> &indices, uint32_t vertexCount, float &acmr, float &atvr)
+{
+	std::vector<uint32_t> cacheTimeStamps(vertexCount, 0);
+	uint32_t time = VERTEX_CACHE_SIZE + 1;
+	uint32_t misses = 0;
 
-		if (!warn.empty())
+	for (uint32_t index : indices)
+	{
+		if (time - cacheTimeStamps[index] > VERTEX_CACHE_SIZE)
 		{
-			std::cout << warn << std::endl;
+			cacheTimeStamps[index] = time++;
+			++misses;
 		}
+	}
+
+	acmr = indices.empty() ? 0.0f : misses / static_cast<float>(indices.size() / 3);
+	atvr = vertexCount == 0 ? 0.0f : misses / static_cast<float>(vertexCount);
+}
+
+// reorders triangles for post transform cache reuse with tipsify from "Fast Triangle Reordering for Vertex Locality and
+// Reduced Overdraw" by Sander et al. the start of each cluster of triangles, which begins wherever the algorithm has to
+// jump to an unrelated part of the mesh, is written to clusters
+std::vector<uint32_t> optimizeVertexCache(const std::vector<uint32_t> &indices, uint32_t vertexCount, std::vector<uint32_t> &clusters)
+{
+	const uint32_t triangleCount = static_cast<uint32_t>(indices.size() / 3);
+
+	// vertex to triangle adjacency
+	std::vector<uint32_t> liveTriangles(vertexCount, 0);
+	for (uint32_t index : indices)
+	{
+		++liveTriangles[index];
+	}
 
-		if (!err.empty())
+	std::vector<uint32_t> adjacencyOffsets(vertexCount + 1, 0);
+	for (uint32_t i = 0; i < vertexCount; ++i)
+	{
+		adjacencyOffsets[i + 1] = adjacencyOffsets[i] + liveTriangles[i];
+	}
+
+	std::vector<uint32_t> adjacency(indices.size());
+	{
+		std::vector<uint32_t> fill(adjacencyOffsets.begin(), adjacencyOffsets.end() - 1);
+		for (uint32_t i = 0; i < indices.size(); ++i)
 		{
-			std::cerr << err << std::endl;
+			adjacency[fill[indices[i]]++] = i / 3;
 		}
+	}
+
+	std::vector<uint32_t> cacheTimeStamps(vertexCount, 0);
+	std::vector<bool> emitted(triangleCount, false);
+	std::vector<uint32_t> deadEndStack;
+	std::vector<uint32_t> candidates;
+	std::vector<uint32_t> result;
+	result.reserve(indices.size());
+	clusters.clear();
 
-		if (!ret)
+	uint32_t time = VERTEX_CACHE_SIZE + 1;
+	uint32_t cursor = 0;
+	int64_t fanningVertex = vertexCount > 0 ? 0 : -1;
+	bool startCluster = true;
+
+	while (fanningVertex >= 0)
+	{
+		if (startCluster)
 		{
-			fatalExit("Failed to load file!", EXIT_FAILURE);
+			clusters.push_back(static_cast<uint32_t>(result.size() / 3));
+			startCluster = false;
 		}
 
-		// extract data into buffers and create global index list
-		std::vector<glm::vec3> positions;
-		std::vector<glm::vec3> normals;
-		std::vector<glm::vec2> texCoords;
-		std::vector<uint32_t> indices;
-		std::unordered_map<Vertex, uint32_t, VertexHash> vertexToIndex;
+		candidates.clear();
 
-		for (const auto &shape : objShapes)
+		// emit all remaining triangles around the fanning vertex
+		for (uint32_t i = adjacencyOffsets[fanningVertex]; i < adjacencyOffsets[fanningVertex + 1]; ++i)
 		{
-			for (const auto &index : shape.mesh.indices)
+			const uint32_t triangle = adjacency[i];
+
+			if (emitted[triangle])
+			{
+				continue;
+			}
+
+			for (uint32_t j = 0; j < 3; ++j)
 			{
-				Vertex vertex;
+				const uint32_t vertex = indices[triangle * 3 + j];
+				result.push_back(vertex);
+				deadEndStack.push_back(vertex);
+				candidates.push_back(vertex);
+				--liveTriangles[vertex];
 
-				vertex.position.x = objAttrib.vertices[index.vertex_index * 3 + 0];
-				vertex.position.y = objAttrib.vertices[index.vertex_index * 3 + 1];
-				vertex.position.z = objAttrib.vertices[index.vertex_index * 3 + 2];
+				if (time - cacheTimeStamps[vertex] > VERTEX_CACHE_SIZE)
+				{
+					cacheTimeStamps[vertex] = time++;
+				}
+			}
 
-				vertex.normal.x = objAttrib.normals[index.normal_index * 3 + 0];
-				vertex.normal.y = objAttrib.normals[index.normal_index * 3 + 1];
-				vertex.normal.z = objAttrib.normals[index.normal_index * 3 + 2];
+			emitted[triangle] = true;
+		}
 
-				if (objAttrib.texcoords.size() > index.texcoord_index * 2 + 1)
+		// continue with the candidate that is the oldest in the cache and still stays in it after emitting its triangles
+		int64_t nextVertex = -1;
+		int64_t bestPriority = -1;
+		for (uint32_t vertex : candidates)
+		{
+			if (liveTriangles[vertex] > 0)
+			{
+				int64_t priority = 0;
+				if (time - cacheTimeStamps[vertex] + 2 * liveTriangles[vertex] <= VERTEX_CACHE_SIZE)
 				{
-					vertex.texCoord.x = objAttrib.texcoords[index.texcoord_index * 2 + 0];
-					vertex.texCoord.y = objAttrib.texcoords[index.texcoord_index * 2 + 1];
-					if (invertTexcoordY)
-					{
-						vertex.texCoord.y = 1.0f - vertex.texCoord.y;
-					}
+					priority = time - cacheTimeStamps[vertex];
 				}
-				else
+				if (priority > bestPriority)
 				{
-					vertex.texCoord.x = 0.0f;
-					vertex.texCoord.y = 0.0f;
+					bestPriority = priority;
+					nextVertex = vertex;
 				}
+			}
+		}
 
-				// if we havent encountered this vertex before, add it to the map
-				if (vertexToIndex.count(vertex) == 0)
+		// dead end: fall back to recently used vertices and then to the next vertex in input order
+		if (nextVertex == -1)
+		{
+			while (!deadEndStack.empty() && nextVertex == -1)
+			{
+				const uint32_t vertex = deadEndStack.back();
+				deadEndStack.pop_back();
+				if (liveTriangles[vertex] > 0)
 				{
-					vertexToIndex[vertex] = static_cast<uint32_t>(positions.size());
+					nextVertex = vertex;
+				}
+			}
 
-					positions.push_back(vertex.position);
-					normals.push_back(vertex.normal);
-					texCoords.push_back(vertex.texCoord);
+			while (nextVertex == -1 && cursor < vertexCount)
+			{
+				if (liveTriangles[cursor] > 0)
+				{
+					nextVertex = cursor;
+					startCluster = true;
 				}
-				indices.push_back(vertexToIndex[vertex]);
+				++cursor;
 			}
 		}
 
-		// write all the data to file
-		std::ofstream dstFile(dstFileName + ".mesh", std::ios::out | std::ios::binary | std::ios::trunc);
-		const uint32_t vertexCount = static_cast<uint32_t>(positions.size());
-		const uint32_t indexCount = static_cast<uint32_t>(indices.size());;
+		fanningVertex = nextVertex;
+	}
 
-		dstFile.write((const char *)&vertexCount, sizeof(uint32_t));
-		dstFile.write((const char *)&indexCount, sizeof(uint32_t));
-		dstFile.write((const char *)positions.data(), positions.size() * sizeof(glm::vec3));
-		dstFile.write((const char *)normals.data(), normals.size() * sizeof(glm::vec3));
-		dstFile.write((const char *)texCoords.data(), texCoords.size() * sizeof(glm::vec2));
-		dstFile.write((const char *)indices.data(), indices.size() * sizeof(uint32_t));
-		dstFile.close();
+	return result;
+}
+
+// sorts the clusters of optimizeVertexCache() so that triangles facing away from the mesh center are drawn first. these
+// are likely to occlude the rest of the mesh from any view, which reduces overdraw without knowing the view in advance
+void optimizeOverdraw(std::vector<uint32_t> &indices, const std::vector<uint32_t> &clusters, const std::vector<glm::vec3> &positions)
+{
+	const uint32_t triangleCount = static_cast<uint32_t>(indices.size() / 3);
+
+	glm::vec3 meshCenter(0.0f);
+	float meshArea = 0.0f;
+
+	struct Cluster
+	{
+		uint32_t firstTriangle;
+		uint32_t triangleCount;
+		glm::vec3 center;
+		glm::vec3 normal;
+		float sortKey;
+	};
+
+	std::vector<Cluster> sortedClusters(clusters.size());
+
+	for (size_t i = 0; i < clusters.size(); ++i)
+	{
+		Cluster &cluster = sortedClusters[i];
+		cluster.firstTriangle = clusters[i];
+		cluster.triangleCount = (i + 1 < clusters.size() ? clusters[i + 1] : triangleCount) - clusters[i];
+		cluster.center = glm::vec3(0.0f);
+		cluster.normal = glm::vec3(0.0f);
+
+		float clusterArea = 0.0f;
+
+		for (uint32_t j = cluster.firstTriangle; j < cluster.firstTriangle + cluster.triangleCount; ++j)
+		{
+			const glm::vec3 &p0 = positions[indices[j * 3 + 0]];
+			const glm::vec3 &p1 = positions[indices[j * 3 + 1]];
+			const glm::vec3 &p2 = positions[indices[j * 3 + 2]];
+
+			// the length of the cross product is twice the triangle area, so the normals are area weighted
+			const glm::vec3 normal = glm::cross(p1 - p0, p2 - p0);
+			const float area = glm::length(normal);
+			const glm::vec3 center = (p0 + p1 + p2) / 3.0f;
+
+			cluster.normal += normal;
+			cluster.center += center * area;
+			clusterArea += area;
+		}
+
+		meshCenter += cluster.center;
+		meshArea += clusterArea;
+		cluster.center = clusterArea > 0.0f ? cluster.center / clusterArea : positions[indices[cluster.firstTriangle * 3]];
+	}
+
+	meshCenter = meshArea > 0.0f ? meshCenter / meshArea : glm::vec3(0.0f);
+
+	for (auto &cluster : sortedClusters)
+	{
+		const float normalLength = glm::length(cluster.normal);
+		cluster.sortKey = normalLength > 0.0f ? glm::dot(cluster.center - meshCenter, cluster.normal / normalLength) : 0.0f;
+	}
+
+	std::stable_sort(sortedClusters.begin(), sortedClusters.end(), [](const Cluster &lhs, const Cluster &rhs) { return lhs.sortKey > rhs.sortKey; });
+
+	std::vector<uint32_t> result;
+	result.reserve(indices.size());
+	for (const auto &cluster : sortedClusters)
+	{
+		result.insert(result.end(), indices.begin() + cluster.firstTriangle * 3, indices.begin() + (cluster.firstTriangle + cluster.triangleCount) * 3);
+	}
+
+	indices = std::move(result);
+}
+
+// generates angle weighted per vertex tangents. this is not mikktspace and does not reproduce its tangents exactly:
+// the tangent of each triangle is projected onto the tangent plane of each of its vertices and accumulated weighted by
+// the corner angle. vertices shared by triangles with
+// mirrored uvs are split, so that each vertex has a single bitangent sign in tangents[i].w
+void generateTangents(std::vector<uint32_t> &indices, std::vector<glm::vec3> &positions, std::vector<glm::vec3> &normals,
+	std::vector<glm::vec2> &texCoords, std::vector<glm::vec4> &tangents)
+{
+	const uint32_t vertexCount = static_cast<uint32_t>(positions.size());
+
+	// two accumulation buckets per vertex, one per bitangent sign
+	std::vector<glm::vec3> accumulatedTangents(vertexCount * 2, glm::vec3(0.0f));
+	std::vector<bool> usedBuckets(vertexCount * 2, false);
+	std::vector<uint8_t> cornerBuckets(indices.size());
+
+	for (size_t i = 0; i < indices.size(); i += 3)
+	{
+		const glm::vec3 edge1 = positions[indices[i + 1]] - positions[indices[i]];
+		const glm::vec3 edge2 = positions[indices[i + 2]] - positions[indices[i]];
+		const glm::vec2 deltaUV1 = texCoords[indices[i + 1]] - texCoords[indices[i]];
+		const glm::vec2 deltaUV2 = texCoords[indices[i + 2]] - texCoords[indices[i]];
+
+		// scaled by the signed uv area, which only changes the length
+		const float uvArea = deltaUV1.x * deltaUV2.y - deltaUV2.x * deltaUV1.y;
+		const float orientation = uvArea < 0.0f ? -1.0f : 1.0f;
+		const glm::vec3 triangleTangent = (edge1 * deltaUV2.y - edge2 * deltaUV1.y) * orientation;
+		const glm::vec3 triangleBitangent = (edge2 * deltaUV1.x - edge1 * deltaUV2.x) * orientation;
+
+		for (size_t j = 0; j < 3; ++j)
+		{
+			const uint32_t vertex = indices[i + j];
+			const glm::vec3 &normal = normals[vertex];
+
+			const glm::vec3 tangent = triangleTangent - normal * glm::dot(normal, triangleTangent);
+			const glm::vec3 bitangent = triangleBitangent - normal * glm::dot(normal, triangleBitangent);
+			const uint8_t bucket = glm::dot(glm::cross(normal, tangent), bitangent) < 0.0f ? 1 : 0;
+
+			const glm::vec3 toNext = positions[indices[i + (j + 1) % 3]] - positions[vertex];
+			const glm::vec3 toPrevious = positions[indices[i + (j + 2) % 3]] - positions[vertex];
+			const float lengths = glm::length(toNext) * glm::length(toPrevious);
+			const float angle = lengths > 0.0f ? glm::acos(glm::clamp(glm::dot(toNext, toPrevious) / lengths, -1.0f, 1.0f)) : 0.0f;
 
-		std::cout << "Finished processing mesh with " << positions.size() << " vertices and " << indices.size() << " indices." << std::endl;
+			const float tangentLength = glm::length(tangent);
+			if (tangentLength > 0.0f)
+			{
+				accumulatedTangents[vertex * 2 + bucket] += tangent * (angle / tangentLength);
+			}
+
+			usedBuckets[vertex * 2 + bucket] = true;
+			cornerBuckets[i + j] = bucket;
+		}
+	}
+
+	// the first used bucket of a vertex keeps its index, a second one becomes a new vertex
+	std::vector<uint32_t> bucketVertices(vertexCount * 2, ~0u);
+	for (uint32_t i = 0; i < vertexCount; ++i)
+	{
+		for (uint32_t bucket = 0; bucket < 2; ++bucket)
+		{
+			if (!usedBuckets[i * 2 + bucket])
+			{
+				continue;
+			}
+
+			if (bucketVertices[i * 2] == ~0u && bucketVertices[i * 2 + 1] == ~0u)
+			{
+				bucketVertices[i * 2 + bucket] = i;
+			}
+			else
+			{
+				bucketVertices[i * 2 + bucket] = static_cast<uint32_t>(positions.size());
+				positions.push_back(positions[i]);
+				normals.push_back(normals[i]);
+				texCoords.push_back(texCoords[i]);
+			}
+		}
+	}
+
+	tangents.resize(positions.size());
+
+	for (uint32_t i = 0; i < vertexCount * 2; ++i)
+	{
+		if (bucketVertices[i] == ~0u)
+		{
+			continue;
+		}
+
+		const uint32_t vertex = bucketVertices[i];
+		const glm::vec3 &normal = normals[vertex];
+		glm::vec3 tangent = accumulatedTangents[i] - normal * glm::dot(normal, accumulatedTangents[i]);
+
+		// degenerate uvs: any vector in the tangent plane will do
+		if (glm::length(tangent) < 1e-6f)
+		{
+			tangent = glm::cross(normal, glm::abs(normal.x) < 0.9f ? glm::vec3(1.0f, 0.0f, 0.0f) : glm::vec3(0.0f, 1.0f, 0.0f));
+		}
+
+		tangents[vertex] = glm::vec4(glm::normalize(tangent), (i & 1) != 0 ? -1.0f : 1.0f);
+	}
+
+	for (size_t i = 0; i < indices.size(); ++i)
+	{
+		indices[i] = bucketVertices[indices[i] * 2 + cornerBuckets[i]];
+	}
+}
+
+// renumbers vertices in the order of their first use, so that vertex fetches walk through memory linearly
+template<typename T>
+void remapVertexAttribute(std::vector<T> &attribute, const std::vector<uint32_t> &remap, uint32_t newVertexCount)
+{
+	std::vector<T> result(newVertexCount);
+	for (size_t i = 0; i < attribute.size(); ++i)
+	{
+		if (remap[i] != ~0u)
+		{
+			result[remap[i]] = attribute[i];
+		}
+	}
+	attribute = std::move(result);
+}
+
+void optimizeVertexFetch(std::vector<uint32_t> &indices, std::vector<glm::vec3> &positions, std::vector<glm::vec3> &normals, std::vector<glm::vec2> &texCoords,
+	std::vector<glm::vec4> &tangents)
+{
+	std::vector<uint32_t> remap(positions.size(), ~0u);
+	uint32_t newVertexCount = 0;
+
+	for (auto &index : indices)
+	{
+		if (remap[index] == ~0u)
+		{
+			remap[index] = newVertexCount++;
+		}
+		index = remap[index];
+	}
+
+	remapVertexAttribute(positions, remap, newVertexCount);
+	remapVertexAttribute(normals, remap, newVertexCount);
+	remapVertexAttribute(texCoords, remap, newVertexCount);
+	remapVertexAttribute(tangents, remap, newVertexCount);
+}
+
+// read only mapping of a whole file. the os pages the file in and out as needed, so even files larger than the
+// physical memory can be read
+class MappedFile
+{
+public:
+	explicit MappedFile(const std::filesystem::path &path)
+	{
+#ifdef _WIN32
+		m_file = CreateFileW(path.wstring().c_str(), GENERIC_READ, FILE_SHARE_READ, nullptr, OPEN_EXISTING, FILE_FLAG_SEQUENTIAL_SCAN, nullptr);
+		LARGE_INTEGER size;
+		if (m_file == INVALID_HANDLE_VALUE || !GetFileSizeEx(m_file, &size))
+		{
+			return;
+		}
+		m_size = static_cast<size_t>(size.QuadPart);
+		m_open = true;
+
+		if (m_size > 0)
+		{
+			m_mapping = CreateFileMappingW(m_file, nullptr, PAGE_READONLY, 0, 0, nullptr);
+			m_data = m_mapping ? static_cast<const char *>(MapViewOfFile(m_mapping, FILE_MAP_READ, 0, 0, 0)) : nullptr;
+			m_open = m_data != nullptr;
+		}
+#else
+		m_file = open(path.c_str(), O_RDONLY);
+		struct stat fileStat;
+		if (m_file < 0 || fstat(m_file, &fileStat) != 0)
+		{
+			return;
+		}
+		m_size = static_cast<size_t>(fileStat.st_size);
+		m_open = true;
+
+		if (m_size > 0)
+		{
+			void *data = mmap(nullptr, m_size, PROT_READ, MAP_PRIVATE, m_file, 0);
+			m_data = data != MAP_FAILED ? static_cast<const char *>(data) : nullptr;
+			m_open = m_data != nullptr;
+
+			if (m_data)
+			{
+				madvise(data, m_size, MADV_SEQUENTIAL);
+			}
+		}
+#endif
 	}
 
-	return EXIT_SUCCESS;
-}
\ No newline at end of file
+	MappedFile(const MappedFile &) = delete;
+	MappedFile &operator= (const MappedFile &) = delete;
+
+	~MappedFile()
+	{
+#ifdef _WIN32
+		if (m_data)
+		{
+			UnmapViewOfFile(m_data);
+		}
+		if (m_mapping)
+		{
+			CloseHandle(m_mapping);
+		}
+		if (m_file != INVALID_HANDLE_VALUE)
+		{
+			CloseHandle(m_file);
+		}
+#else
+		if (m_data)
+		{
+			munmap(const_cast<char *>(m_data), m_size);
+		}
+		if (m_file >= 0)
+		{
+			close(m_file);
+		}
+#endif
+	}
+
+	bool isOpen() const
+	{
+		return m_open;
+	}
+
+	const char *getData() const
+	{
+		return m_data;
+	}
+
+	size_t getSize() const
+	{
+		return m_size;
+	}
+
+private:
+#ifdef _WIN32
+	HANDLE m_file = INVALID_HANDLE_VALUE;
+	HANDLE m_mapping = nullptr;
+#else
+	int m_file = -1;
+#endif
+	const char *m_data = nullptr;
+	size_t m_size = 0;
+	bool m_open = false;
+};
+
+// a face corner with zero based attribute indices
+struct ObjCorner
+{
+	uint32_t position;
+	uint32_t normal;
+	uint32_t texCoord; // ~0u if the corner has no texcoord
+};
+
+struct ObjData
+{
+	std::vector<glm::vec3> positions;
+	std::vector<glm::vec3> normals;
+	std::vector<glm::vec2> texCoords;
+	std::vector<ObjCorner> corners; // triangle list
+	std::vector<uint32_t> triangleMaterials; // index into materialNames for every triangle
+	std::vector<std::string> materialNames; // in order of first use, the first entry is the unnamed default material
+};
+
+enum class ObjLineType
+{
+	OTHER, POSITION, NORMAL, TEXCOORD, FACE, MATERIAL
+};
+
+inline bool isObjSpace(char c)
+{
+	return c == ' ' || c == '\t';
+}
+
+inline const char *skipObjSpaces(const char *s, const char *end)
+{
+	while (s < end && isObjSpace(*s))
+	{
+		++s;
+	}
+	return s;
+}
+
+inline const char *findObjTokenEnd(const char *s, const char *end)
+{
+	while (s < end && !isObjSpace(*s) && *s != '\r')
+	{
+		++s;
+	}
+	return s;
+}
+
+// classifies the line and moves s past its keyword
+inline ObjLineType parseObjKeyword(const char *&s, const char *end)
+{
+	s = skipObjSpaces(s, end);
+	const char *tokenEnd = findObjTokenEnd(s, end);
+	const size_t length = tokenEnd - s;
+
+	ObjLineType type = ObjLineType::OTHER;
+	if (length == 1 && s[0] == 'v')
+	{
+		type = ObjLineType::POSITION;
+	}
+	else if (length == 2 && s[0] == 'v' && s[1] == 'n')
+	{
+		type = ObjLineType::NORMAL;
+	}
+	else if (length == 2 && s[0] == 'v' && s[1] == 't')
+	{
+		type = ObjLineType::TEXCOORD;
+	}
+	else if (length == 1 && s[0] == 'f')
+	{
+		type = ObjLineType::FACE;
+	}
+	else if (length == 6 && memcmp(s, "usemtl", 6) == 0)
+	{
+		type = ObjLineType::MATERIAL;
+	}
+
+	s = tokenEnd;
+	return type;
+}
+
+// uses the number parser of tinyobjloader, so the values are the same as with tinyobj::LoadObj
+inline float parseObjFloat(const char *&s, const char *end)
+{
+	s = skipObjSpaces(s, end);
+	const char *tokenEnd = findObjTokenEnd(s, end);
+	double value = 0.0;
+	tinyobj::tryParseDouble(s, tokenEnd, &value);
+	s = tokenEnd;
+	return static_cast<float>(value);
+}
+
+// parses a one based or negative relative index and turns it into a zero based one. returns false for a missing,
+// zero or out of range index
+inline bool parseObjIndex(const char *&s, const char *end, int64_t currentCount, int64_t totalCount, uint32_t &index)
+{
+	const bool negative = s < end && *s == '-';
+	s += negative ? 1 : 0;
+
+	int64_t value = 0;
+	const char *digitsBegin = s;
+	while (s < end && *s >= '0' && *s <= '9' && value < totalCount + 1)
+	{
+		value = value * 10 + (*s - '0');
+		++s;
+	}
+
+	value = negative ? currentCount - value : value - 1;
+
+	if (s == digitsBegin || value < 0 || value >= totalCount)
+	{
+		return false;
+	}
+
+	index = static_cast<uint32_t>(value);
+	return true;
+}
+
+// returns the rest of the line without surrounding spaces
+inline std::string parseObjName(const char *s, const char *end)
+{
+	s = skipObjSpaces(s, end);
+	while (end > s && (isObjSpace(end[-1]) || end[-1] == '\r'))
+	{
+		--end;
+	}
+	return std::string(s, end);
+}
+
+// parses the obj file in two passes over line aligned chunks, each chunk on its own thread. the first pass counts
+// the elements of each chunk, which yields the offsets of the chunks into the output arrays and the base for relative
+// indices. the second pass parses the chunks directly into place. only positions, normals, texcoords, faces and
+// material assignments are read. polygons are triangulated as fans and faces without normals are rejected
+bool parseObj(const char *data, size_t size, uint32_t threadCount, ObjData &obj, std::string &error)
+{
+	struct Chunk
+	{
+		const char *begin;
+		const char *end;
+		size_t positionCount;
+		size_t normalCount;
+		size_t texCoordCount;
+		size_t cornerCount;
+		std::vector<std::string> materialNames; // usemtl names in order, consecutive duplicates removed
+		bool valid;
+	};
+
+	const uint32_t chunkCount = size < (1 << 20) ? 1 : threadCount;
+	std::vector<Chunk> chunks(chunkCount);
+
+	for (uint32_t i = 0; i < chunkCount; ++i)
+	{
+		// start every chunk after the end of the line that the previous chunk's nominal end falls into
+		const char *begin = data + size * i / chunkCount;
+		if (i > 0)
+		{
+			begin = std::max(begin, chunks[i - 1].begin);
+			begin = static_cast<const char *>(memchr(begin, '\n', data + size - begin));
+			begin = begin ? begin + 1 : data + size;
+			chunks[i - 1].end = begin;
+		}
+		chunks[i] = {};
+		chunks[i].begin = begin;
+		chunks[i].end = data + size;
+	}
+
+	auto forEachLine = [](const Chunk &chunk, auto &&func)
+	{
+		for (const char *line = chunk.begin; line < chunk.end;)
+		{
+			const char *lineEnd = static_cast<const char *>(memchr(line, '\n', chunk.end - line));
+			lineEnd = lineEnd ? lineEnd : chunk.end;
+			func(line, lineEnd);
+			line = lineEnd + 1;
+		}
+	};
+
+	// first pass: count elements
+	runParallel(chunkCount, [&](uint32_t chunkIndex)
+	{
+		Chunk &chunk = chunks[chunkIndex];
+
+		forEachLine(chunk, [&chunk](const char *s, const char *end)
+		{
+			switch (parseObjKeyword(s, end))
+			{
+			case ObjLineType::POSITION:
+				++chunk.positionCount;
+				break;
+			case ObjLineType::NORMAL:
+				++chunk.normalCount;
+				break;
+			case ObjLineType::TEXCOORD:
+				++chunk.texCoordCount;
+				break;
+			case ObjLineType::MATERIAL:
+			{
+				std::string name = parseObjName(s, end);
+				if (chunk.materialNames.empty() || chunk.materialNames.back() != name)
+				{
+					chunk.materialNames.push_back(std::move(name));
+				}
+				break;
+			}
+			case ObjLineType::FACE:
+			{
+				size_t vertexCount = 0;
+				for (s = skipObjSpaces(s, end); s < end && *s != '\r'; s = skipObjSpaces(findObjTokenEnd(s, end), end))
+				{
+					++vertexCount;
+				}
+				chunk.cornerCount += vertexCount >= 3 ? (vertexCount - 2) * 3 : 0;
+				break;
+			}
+			default:
+				break;
+			}
+		});
+	});
+
+	Chunk totals{};
+	std::vector<Chunk> bases(chunkCount);
+	for (uint32_t i = 0; i < chunkCount; ++i)
+	{
+		bases[i] = totals;
+		totals.positionCount += chunks[i].positionCount;
+		totals.normalCount += chunks[i].normalCount;
+		totals.texCoordCount += chunks[i].texCoordCount;
+		totals.cornerCount += chunks[i].cornerCount;
+	}
+
+	if (totals.positionCount > std::numeric_limits<uint32_t>::max() || totals.normalCount > std::numeric_limits<uint32_t>::max()
+		|| totals.texCoordCount > std::numeric_limits<uint32_t>::max() || totals.cornerCount > std::numeric_limits<uint32_t>::max())
+	{
+		error = "Too many vertices!";
+		return false;
+	}
+
+	obj.positions.resize(totals.positionCount);
+	obj.normals.resize(totals.normalCount);
+	obj.texCoords.resize(totals.texCoordCount);
+	obj.corners.resize(totals.cornerCount);
+	obj.triangleMaterials.resize(totals.cornerCount / 3);
+
+	// number the materials in order of first use. a chunk starts out with the material that was active at the end of
+	// the closest preceding chunk that assigned one
+	std::unordered_map<std::string, uint32_t> materialIndices;
+	std::vector<uint32_t> initialMaterials(chunkCount, 0);
+	obj.materialNames = { std::string() };
+	materialIndices[std::string()] = 0;
+
+	for (uint32_t i = 0; i < chunkCount; ++i)
+	{
+		if (i > 0)
+		{
+			initialMaterials[i] = chunks[i - 1].materialNames.empty() ? initialMaterials[i - 1] : materialIndices[chunks[i - 1].materialNames.back()];
+		}
+
+		for (const auto &name : chunks[i].materialNames)
+		{
+			if (materialIndices.emplace(name, static_cast<uint32_t>(obj.materialNames.size())).second)
+			{
+				obj.materialNames.push_back(name);
+			}
+		}
+	}
+
+	// second pass: parse into place
+	runParallel(chunkCount, [&](uint32_t chunkIndex)
+	{
+		Chunk &chunk = chunks[chunkIndex];
+		const Chunk &base = bases[chunkIndex];
+
+		size_t positionIndex = base.positionCount;
+		size_t normalIndex = base.normalCount;
+		size_t texCoordIndex = base.texCoordCount;
+		size_t cornerIndex = base.cornerCount;
+		uint32_t material = initialMaterials[chunkIndex];
+		std::vector<ObjCorner> face;
+
+		chunk.valid = true;
+
+		forEachLine(chunk, [&](const char *s, const char *end)
+		{
+			switch (parseObjKeyword(s, end))
+			{
+			case ObjLineType::POSITION:
+			{
+				glm::vec3 &position = obj.positions[positionIndex++];
+				position.x = parseObjFloat(s, end);
+				position.y = parseObjFloat(s, end);
+				position.z = parseObjFloat(s, end);
+				break;
+			}
+			case ObjLineType::NORMAL:
+			{
+				glm::vec3 &normal = obj.normals[normalIndex++];
+				normal.x = parseObjFloat(s, end);
+				normal.y = parseObjFloat(s, end);
+				normal.z = parseObjFloat(s, end);
+				break;
+			}
+			case ObjLineType::TEXCOORD:
+			{
+				glm::vec2 &texCoord = obj.texCoords[texCoordIndex++];
+				texCoord.x = parseObjFloat(s, end);
+				texCoord.y = parseObjFloat(s, end);
+				break;
+			}
+			case ObjLineType::MATERIAL:
+				material = materialIndices.find(parseObjName(s, end))->second;
+				break;
+			case ObjLineType::FACE:
+			{
+				// v/vt/vn, v//vn (v and v/vt lack the normal and are rejected)
+				face.clear();
+				for (s = skipObjSpaces(s, end); s < end && *s != '\r'; s = skipObjSpaces(findObjTokenEnd(s, end), end))
+				{
+					ObjCorner corner{ 0, 0, ~0u };
+					bool valid = parseObjIndex(s, end, positionIndex, totals.positionCount, corner.position) && s < end && *s++ == '/';
+					if (valid && s < end && *s != '/')
+					{
+						valid = parseObjIndex(s, end, texCoordIndex, totals.texCoordCount, corner.texCoord);
+					}
+					valid = valid && s < end && *s++ == '/' && parseObjIndex(s, end, normalIndex, totals.normalCount, corner.normal);
+					chunk.valid = chunk.valid && valid;
+					face.push_back(corner);
+				}
+
+				for (size_t i = 2; i < face.size(); ++i)
+				{
+					obj.triangleMaterials[cornerIndex / 3] = material;
+					obj.corners[cornerIndex++] = face[0];
+					obj.corners[cornerIndex++] = face[i - 1];
+					obj.corners[cornerIndex++] = face[i];
+				}
+				break;
+			}
+			default:
+				break;
+			}
+		});
+	});
+
+	for (const auto &chunk : chunks)
+	{
+		if (!chunk.valid)
+		{
+			error = "Invalid face, every vertex needs a position and a normal!";
+			return false;
+		}
+	}
+
+	return true;
+}
+
+// legacy .mesh layout read by older builds of the demo: vertex count, index count, float positions, normals and texcoords,
+// 32 bit indices
+void writeMeshV1(std::ofstream &dstFile, const std::vector<glm::vec3> &positions, const std::vector<glm::vec3> &normals,
+	const std::vector<glm::vec2> &texCoords, const std::vector<uint32_t> &indices)
+{
+	const uint32_t counts[] = { static_cast<uint32_t>(positions.size()), static_cast<uint32_t>(indices.size()) };
+
+	dstFile.write((const char *)counts, sizeof(counts));
+	dstFile.write((const char *)positions.data(), positions.size() * sizeof(glm::vec3));
+	dstFile.write((const char *)normals.data(), normals.size() * sizeof(glm::vec3));
+	dstFile.write((const char *)texCoords.data(), texCoords.size() * sizeof(glm::vec2));
+	dstFile.write((const char *)indices.data(), indices.size() * sizeof(uint32_t));
+}
+
+void writeMeshV4(std::ofstream &dstFile, const std::vector<MeshFileSubmesh> &submeshes, const std::vector<glm::vec3> &positions,
+	const std::vector<glm::vec3> &normals, const std::vector<glm::vec2> &texCoords, const std::vector<glm::vec4> &tangents,
+	const std::vector<uint32_t> &indices)
+{
+	const uint32_t vertexCount = static_cast<uint32_t>(positions.size());
+	const uint32_t indexCount = static_cast<uint32_t>(indices.size());
+
+	MeshFileHeader header{};
+	header.magic = MESH_FILE_MAGIC;
+	header.version = MESH_FILE_VERSION;
+	header.vertexCount = vertexCount;
+	header.indexCount = indexCount;
+	header.indexSize = vertexCount < 65536 ? sizeof(uint16_t) : sizeof(uint32_t);
+	header.submeshCount = static_cast<uint32_t>(submeshes.size());
+
+	// quantize positions relative to the bounding box
+	glm::vec3 minPosition(std::numeric_limits<float>::max());
+	glm::vec3 maxPosition(std::numeric_limits<float>::lowest());
+	for (const auto &position : positions)
+	{
+		minPosition = glm::min(minPosition, position);
+		maxPosition = glm::max(maxPosition, position);
+	}
+
+	for (int i = 0; i < 3; ++i)
+	{
+		const float extent = maxPosition[i] - minPosition[i];
+		header.positionScale[i] = extent > 0.0f ? extent : 1.0f;
+		header.positionBias[i] = minPosition[i];
+	}
+
+	std::vector<uint16_t> quantizedPositions;
+	std::vector<int16_t> encodedNormals;
+	std::vector<uint16_t> halfTexCoords;
+	std::vector<int8_t> encodedTangents;
+	quantizedPositions.reserve(vertexCount * 4);
+	encodedNormals.reserve(vertexCount * 2);
+	halfTexCoords.reserve(vertexCount * 2);
+	encodedTangents.reserve(vertexCount * 4);
+
+	for (uint32_t i = 0; i < vertexCount; ++i)
+	{
+		for (int j = 0; j < 3; ++j)
+		{
+			const float normalized = glm::clamp((positions[i][j] - header.positionBias[j]) / header.positionScale[j], 0.0f, 1.0f);
+			quantizedPositions.push_back(static_cast<uint16_t>(normalized * 65535.0f + 0.5f));
+		}
+		quantizedPositions.push_back(0);
+
+		const glm::vec2 octahedron = encodeOctahedron(normals[i]);
+		encodedNormals.push_back(static_cast<int16_t>(glm::round(glm::clamp(octahedron.x, -1.0f, 1.0f) * 32767.0f)));
+		encodedNormals.push_back(static_cast<int16_t>(glm::round(glm::clamp(octahedron.y, -1.0f, 1.0f) * 32767.0f)));
+
+		halfTexCoords.push_back(glm::packHalf1x16(texCoords[i].x));
+		halfTexCoords.push_back(glm::packHalf1x16(texCoords[i].y));
+
+		for (int j = 0; j < 4; ++j)
+		{
+			encodedTangents.push_back(static_cast<int8_t>(glm::round(glm::clamp(tangents[i][j], -1.0f, 1.0f) * 127.0f)));
+		}
+	}
+
+	dstFile.write((const char *)&header, sizeof(header));
+	dstFile.write((const char *)submeshes.data(), submeshes.size() * sizeof(MeshFileSubmesh));
+	dstFile.write((const char *)quantizedPositions.data(), quantizedPositions.size() * sizeof(uint16_t));
+	dstFile.write((const char *)encodedNormals.data(), encodedNormals.size() * sizeof(int16_t));
+	dstFile.write((const char *)halfTexCoords.data(), halfTexCoords.size() * sizeof(uint16_t));
+	dstFile.write((const char *)encodedTangents.data(), encodedTangents.size() * sizeof(int8_t));
+
+	if (header.indexSize == sizeof(uint16_t))
+	{
+		const std::vector<uint16_t> indices16(indices.begin(), indices.end());
+		dstFile.write((const char *)indices16.data(), indices16.size() * sizeof(uint16_t));
+	}
+	else
+	{
+		dstFile.write((const char *)indices.data(), indices.size() * sizeof(uint32_t));
+	}
+}
+
+enum class MeshFormat
+{
+	V1, V4
+};
+
+struct ConvertOptions
+{
+	bool invertTexcoordY = false;
+	bool reduceOverdraw = false;
+	MeshFormat format = MeshFormat::V4;
+	uint32_t threadsPerJob = 1;
+};
+
+struct ConvertResult
+{
+	bool success = false;
+	std::string message; // loader warnings and errors
+	uint32_t vertexCount = 0;
+	uint32_t indexCount = 0;
+	float acmrBefore = 0.0f;
+	float acmrAfter = 0.0f;
+	float atvrBefore = 0.0f;
+	float atvrAfter = 0.0f;
+	uint64_t srcFileSize = 0;
+	uint64_t dstFileSize = 0;
+	double loadTime = 0.0;
+	double processTime = 0.0;
+	double writeTime = 0.0;
+};
+
+ConvertResult convertFile(const std::filesystem::path &srcPath, const std::filesystem::path &dstPath, const ConvertOptions &options)
+{
+	ConvertResult result;
+
+	auto previousTime = std::chrono::steady_clock::now();
+	auto elapsedSeconds = [&previousTime]()
+	{
+		const auto time = std::chrono::steady_clock::now();
+		const double seconds = std::chrono::duration<double>(time - previousTime).count();
+		previousTime = time;
+		return seconds;
+	};
+
+	std::error_code errorCode;
+
+	// parse the file straight from the mapping
+	std::vector<glm::vec3> positions;
+	std::vector<glm::vec3> normals;
+	std::vector<glm::vec2> texCoords;
+	std::vector<uint32_t> indices;
+	std::vector<MeshFileSubmesh> submeshes;
+	{
+		ObjData obj;
+		{
+			MappedFile srcFile(srcPath);
+
+			if (!srcFile.isOpen())
+			{
+				result.message = "Failed to open file!";
+				return result;
+			}
+
+			result.srcFileSize = srcFile.getSize();
+
+			if (!parseObj(srcFile.getData(), srcFile.getSize(), options.threadsPerJob, obj, result.message))
+			{
+				return result;
+			}
+		}
+
+		if (obj.corners.empty())
+		{
+			result.message = "File contains no faces!";
+			return result;
+		}
+
+		result.loadTime = elapsedSeconds();
+
+		// small meshes are not worth the threads
+		const uint32_t shardCount = obj.corners.size() < (1 << 16) ? 1 : options.threadsPerJob;
+		const uint32_t cornerCount = static_cast<uint32_t>(obj.corners.size());
+
+		auto getVertex = [&obj, &options](uint32_t i)
+		{
+			const ObjCorner &corner = obj.corners[i];
+
+			Vertex vertex;
+			vertex.position = obj.positions[corner.position];
+			vertex.normal = obj.normals[corner.normal];
+			vertex.texCoord = corner.texCoord != ~0u ? obj.texCoords[corner.texCoord] : glm::vec2(0.0f);
+
+			if (corner.texCoord != ~0u && options.invertTexcoordY)
+			{
+				vertex.texCoord.y = 1.0f - vertex.texCoord.y;
+			}
+
+			return vertex;
+		};
+
+		// deduplicate vertices. numbering them by first occurrence yields the same result as inserting them one by one
+		std::vector<uint32_t> firstOccurrences;
+		findFirstOccurrences(cornerCount, getVertex, firstOccurrences, shardCount);
+
+		indices.resize(cornerCount);
+		for (uint32_t i = 0; i < cornerCount; ++i)
+		{
+			if (firstOccurrences[i] == i)
+			{
+				const Vertex vertex = getVertex(i);
+				indices[i] = static_cast<uint32_t>(positions.size());
+
+				positions.push_back(vertex.position);
+				normals.push_back(vertex.normal);
+				texCoords.push_back(vertex.texCoord);
+			}
+			else
+			{
+				indices[i] = indices[firstOccurrences[i]];
+			}
+		}
+
+		// group the triangles by material, keeping their order within each group
+		std::vector<uint32_t> materialTriangleCounts(obj.materialNames.size(), 0);
+		for (uint32_t material : obj.triangleMaterials)
+		{
+			++materialTriangleCounts[material];
+		}
+
+		std::vector<uint32_t> materialOffsets(obj.materialNames.size(), 0);
+		uint32_t triangleOffset = 0;
+		for (size_t i = 0; i < obj.materialNames.size(); ++i)
+		{
+			materialOffsets[i] = triangleOffset;
+			triangleOffset += materialTriangleCounts[i];
+
+			if (materialTriangleCounts[i] > 0)
+			{
+				MeshFileSubmesh submesh{};
+				strncpy(submesh.materialName, obj.materialNames[i].c_str(), sizeof(submesh.materialName) - 1);
+				submesh.firstIndex = materialOffsets[i] * 3;
+				submesh.indexCount = materialTriangleCounts[i] * 3;
+				submeshes.push_back(submesh);
+
+				if (obj.materialNames[i].size() >= sizeof(submesh.materialName))
+				{
+					result.message += "Material name truncated: " + obj.materialNames[i] + "\n";
+				}
+			}
+		}
+
+		std::vector<uint32_t> groupedIndices(indices.size());
+		for (size_t i = 0; i < obj.triangleMaterials.size(); ++i)
+		{
+			const uint32_t dstTriangle = materialOffsets[obj.triangleMaterials[i]]++;
+			memcpy(&groupedIndices[dstTriangle * 3], &indices[i * 3], sizeof(uint32_t) * 3);
+		}
+		indices = std::move(groupedIndices);
+	}
+
+	// tangents may split vertices, so they are generated before the vertex order is optimized
+	std::vector<glm::vec4> tangents;
+	generateTangents(indices, positions, normals, texCoords, tangents);
+
+	// optimize triangle order for the post transform cache and optionally overdraw, then vertex order for fetch locality
+	{
+		computeVertexCacheStatistics(indices, static_cast<uint32_t>(positions.size()), result.acmrBefore, result.atvrBefore);
+
+		// triangles must not move between submeshes
+		for (const auto &submesh : submeshes)
+		{
+			std::vector<uint32_t> submeshIndices(indices.begin() + submesh.firstIndex, indices.begin() + submesh.firstIndex + submesh.indexCount);
+
+			std::vector<uint32_t> clusters;
+			submeshIndices = optimizeVertexCache(submeshIndices, static_cast<uint32_t>(positions.size()), clusters);
+
+			if (options.reduceOverdraw)
+			{
+				optimizeOverdraw(submeshIndices, clusters, positions);
+			}
+
+			std::copy(submeshIndices.begin(), submeshIndices.end(), indices.begin() + submesh.firstIndex);
+		}
+
+		optimizeVertexFetch(indices, positions, normals, texCoords, tangents);
+
+		computeVertexCacheStatistics(indices, static_cast<uint32_t>(positions.size()), result.acmrAfter, result.atvrAfter);
+	}
+
+	result.vertexCount = static_cast<uint32_t>(positions.size());
+	result.indexCount = static_cast<uint32_t>(indices.size());
+	result.processTime = elapsedSeconds();
+
+	// write all the data to file
+	{
+		std::ofstream dstFile(dstPath, std::ios::out | std::ios::binary | std::ios::trunc);
+
+		if (options.format == MeshFormat::V1)
+		{
+			writeMeshV1(dstFile, positions, normals, texCoords, indices);
+		}
+		else
+		{
+			writeMeshV4(dstFile, submeshes, positions, normals, texCoords, tangents, indices);
+		}
+
+		dstFile.close();
+
+		if (!dstFile)
+		{
+			result.message += "Failed to write file!";
+			return result;
+		}
+	}
+
+	result.dstFileSize = std::filesystem::file_size(dstPath, errorCode);
+	result.writeTime = elapsedSeconds();
+	result.success = true;
+
+	return result;
+}
+
+void printUsage()
+{
+	std::cout <<
+		"Usage: WavefrontObjToBinaryConverter [options] <file.obj | directory>...\n"
+		"Converts .obj files, or all .obj files in the given directories, to .mesh files.\n"
+		"\n"
+		"Options:\n"
+		"  -o, --output <dir>    write the .mesh files to <dir> instead of next to the source files\n"
+		"  -f, --flip-uv         invert the uv y-axis\n"
+		"  -r, --reduce-overdraw reorder triangles to reduce overdraw\n"
+		"      --format <v1|v4>  v4: quantized with tangents and submeshes (default),\n"
+		"                        v1: float vertices and 32 bit indices, without submeshes\n"
+		"  -j, --jobs <n>        number of files converted in parallel (default: number of cores)\n"
+		"  -h, --help            show this message\n"
+		"\n"
+		"Exit codes: 0 all files converted, 1 at least one file failed, 2 invalid arguments." << std::endl;
+}
+
+enum ExitCode
+{
+	EXIT_CODE_SUCCESS = 0,
+	EXIT_CODE_CONVERSION_FAILED = 1,
+	EXIT_CODE_INVALID_ARGUMENTS = 2,
+};
+
+int main(int argc, char *argv[])
+{
+	namespace fs = std::filesystem;
+
+	ConvertOptions options;
+	fs::path outputDirectory;
+	uint32_t jobCount = std::max(1u, std::thread::hardware_concurrency());
+	std::vector<fs::path> srcPaths;
+
+	// parse arguments
+	for (int i = 1; i < argc; ++i)
+	{
+		const std::string arg = argv[i];
+		const bool hasValue = i + 1 < argc;
+
+		if (arg == "-h" || arg == "--help")
+		{
+			printUsage();
+			return EXIT_CODE_SUCCESS;
+		}
+		else if (arg == "-f" || arg == "--flip-uv")
+		{
+			options.invertTexcoordY = true;
+		}
+		else if (arg == "-r" || arg == "--reduce-overdraw")
+		{
+			options.reduceOverdraw = true;
+		}
+		else if ((arg == "-o" || arg == "--output") && hasValue)
+		{
+			outputDirectory = argv[++i];
+		}
+		else if (arg == "--format" && hasValue)
+		{
+			const std::string value = argv[++i];
+			if (value != "v1" && value != "v4")
+			{
+				std::cerr << "Unknown format: " << value << std::endl;
+				return EXIT_CODE_INVALID_ARGUMENTS;
+			}
+			options.format = value == "v1" ? MeshFormat::V1 : MeshFormat::V4;
+		}
+		else if ((arg == "-j" || arg == "--jobs") && hasValue)
+		{
+			const int value = atoi(argv[++i]);
+			if (value <= 0)
+			{
+				std::cerr << "Invalid job count: " << argv[i] << std::endl;
+				return EXIT_CODE_INVALID_ARGUMENTS;
+			}
+			jobCount = static_cast<uint32_t>(value);
+		}
+		else if (!arg.empty() && arg[0] == '-')
+		{
+			std::cerr << "Unknown or incomplete option: " << arg << std::endl;
+			printUsage();
+			return EXIT_CODE_INVALID_ARGUMENTS;
+		}
+		else
+		{
+			srcPaths.push_back(arg);
+		}
+	}
+
+	// expand directories to the .obj files they contain
+	std::vector<fs::path> srcFiles;
+	for (const auto &path : srcPaths)
+	{
+		std::error_code errorCode;
+
+		if (fs::is_directory(path, errorCode))
+		{
+			std::vector<fs::path> directoryFiles;
+			for (const auto &entry : fs::directory_iterator(path, errorCode))
+			{
+				std::string extension = entry.path().extension().string();
+				std::transform(extension.begin(), extension.end(), extension.begin(), [](char c) { return static_cast<char>(tolower(c)); });
+
+				if (entry.is_regular_file(errorCode) && extension == ".obj")
+				{
+					directoryFiles.push_back(entry.path());
+				}
+			}
+			std::sort(directoryFiles.begin(), directoryFiles.end());
+			srcFiles.insert(srcFiles.end(), directoryFiles.begin(), directoryFiles.end());
+		}
+		else if (fs::is_regular_file(path, errorCode))
+		{
+			srcFiles.push_back(path);
+		}
+		else
+		{
+			std::cerr << "No such file or directory: " << path.string() << std::endl;
+			return EXIT_CODE_INVALID_ARGUMENTS;
+		}
+	}
+
+	if (srcFiles.empty())
+	{
+		std::cerr << "No input files." << std::endl;
+		printUsage();
+		return EXIT_CODE_INVALID_ARGUMENTS;
+	}
+
+	if (!outputDirectory.empty())
+	{
+		std::error_code errorCode;
+		fs::create_directories(outputDirectory, errorCode);
+		if (!fs::is_directory(outputDirectory, errorCode))
+		{
+			std::cerr << "Failed to create output directory: " << outputDirectory.string() << std::endl;
+			return EXIT_CODE_INVALID_ARGUMENTS;
+		}
+	}
+
+	std::vector<fs::path> dstFiles;
+	for (const auto &srcFile : srcFiles)
+	{
+		fs::path dstFile = outputDirectory.empty() ? srcFile : outputDirectory / srcFile.filename();
+		dstFiles.push_back(dstFile.replace_extension(".mesh"));
+	}
+
+	// convert the files in parallel. the cores left over by the jobs are used within the jobs
+	jobCount = std::min(jobCount, static_cast<uint32_t>(srcFiles.size()));
+	options.threadsPerJob = std::max(1u, std::thread::hardware_concurrency() / jobCount);
+
+	const auto startTime = std::chrono::steady_clock::now();
+
+	std::vector<ConvertResult> results(srcFiles.size());
+	std::atomic<size_t> nextFile(0);
+	std::mutex outputMutex;
+
+	auto convertFiles = [&]()
+	{
+		for (size_t i = nextFile++; i < srcFiles.size(); i = nextFile++)
+		{
+			results[i] = convertFile(srcFiles[i], dstFiles[i], options);
+
+			std::lock_guard<std::mutex> lock(outputMutex);
+			const ConvertResult &result = results[i];
+
+			if (!result.message.empty())
+			{
+				(result.success ? std::cout : std::cerr) << srcFiles[i].string() << ": " << result.message << std::endl;
+			}
+			if (result.success)
+			{
+				std::cout << srcFiles[i].string() << " -> " << dstFiles[i].string() << std::endl;
+			}
+		}
+	};
+
+	{
+		std::vector<std::future<void>> futures;
+		for (uint32_t i = 0; i < jobCount; ++i)
+		{
+			futures.push_back(std::async(std::launch::async, convertFiles));
+		}
+		for (auto &future : futures)
+		{
+			future.get();
+		}
+	}
+
+	const double totalTime = std::chrono::duration<double>(std::chrono::steady_clock::now() - startTime).count();
+
+	// summary
+	uint32_t failedCount = 0;
+	uint64_t totalSrcSize = 0;
+	uint64_t totalDstSize = 0;
+
+	std::cout << std::endl;
+	std::cout << "File                                      Vertices    Indices   ACMR         ATVR          Load  Process    Write   Source KiB   Mesh KiB" << std::endl;
+
+	for (size_t i = 0; i < results.size(); ++i)
+	{
+		const ConvertResult &result = results[i];
+		char line[512];
+
+		if (result.success)
+		{
+			snprintf(line, sizeof(line), "%-40.40s %9u %10u   %.2f->%.2f   %.2f->%.2f %7.3fs %7.3fs %7.3fs %12llu %10llu", srcFiles[i].filename().string().c_str(),
+				result.vertexCount, result.indexCount, result.acmrBefore, result.acmrAfter, result.atvrBefore, result.atvrAfter, result.loadTime, result.processTime, result.writeTime,
+				static_cast<unsigned long long>(result.srcFileSize / 1024), static_cast<unsigned long long>(result.dstFileSize / 1024));
+
+			totalSrcSize += result.srcFileSize;
+			totalDstSize += result.dstFileSize;
+		}
+		else
+		{
+			snprintf(line, sizeof(line), "%-40.40s FAILED", srcFiles[i].filename().string().c_str());
+			++failedCount;
+		}
+
+		std::cout << line << std::endl;
+	}
+
+	std::cout << std::endl;
+	std::cout << "Converted " << (results.size() - failedCount) << " of " << results.size() << " files in " << totalTime << "s with "
+		<< jobCount << " jobs, " << totalSrcSize / 1024 << " KiB -> " << totalDstSize / 1024 << " KiB." << std::endl;
+
+	return failedCount == 0 ? EXIT_CODE_SUCCESS : EXIT_CODE_CONVERSION_FAILED;
+}